@@ -0,0 +1,345 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <tuple>
+
+#include "BenchmarkRunner.h"
+#include "ReportWriter.h"
+
+#include "BubbleSort.h"
+#include "InsertionSort.h"
+#include "MergeSort.h"
+#include "ParallelMergeSort.h"
+#include "QuickSort.h"
+#include "ParallelQuickSort.h"
+#include "BucketSort.h"
+#include "RadixSort.h"
+#include "BitonicSort.h"
+#include "ExternalMergeSort.h"
+#include "SortingNetwork.h"
+#include "PerfCounters.h"
+
+// A comparison sort, instantiated for every key type with that key's comparator
+template <template <typename, typename> class Sort, typename... Args>
+static Benchmark::AlgorithmEntry anyKey(const std::string& id, Args... args)
+{
+    Benchmark::AlgorithmEntry entry{ id, {} };
+    auto add = [&]<typename Key>(Benchmark::AlgorithmFactory<Key>& create) {
+        create = [=]() { return std::make_unique<Sort<Key, typename Utils::KeyTraits<Key>::Compare>>(args...); };
+    };
+    std::apply([&](auto&... factories) { (add(factories), ...); }, entry.create);
+    return entry;
+}
+
+// An algorithm that sorts ints only
+static Benchmark::AlgorithmEntry intOnly(const std::string& id, Benchmark::AlgorithmFactory<int> create)
+{
+    Benchmark::AlgorithmEntry entry{ id, {} };
+    std::get<Benchmark::AlgorithmFactory<int>>(entry.create) = std::move(create);
+    return entry;
+}
+
+static std::vector<Benchmark::AlgorithmEntry> createAlgorithms(const Benchmark::BenchmarkConfig& config)
+{
+    size_t memoryBudget = config.memoryBudget;
+    return {
+        anyKey<Algorithms::BasicBubbleSort>("bubble"),
+        anyKey<Algorithms::BasicInsertionSort>("insertion"),
+        anyKey<Algorithms::BasicMergeSort>("merge"),
+        anyKey<Algorithms::BasicParallelMergeSort>("parallel-merge"),
+        anyKey<Algorithms::BasicQuickSort>("quick"),
+        anyKey<Algorithms::BasicQuickSort>("introsort", Algorithms::QuickSortMode::Introsort),
+        anyKey<Algorithms::BasicParallelQuickSort>("parallel-quick"),
+        intOnly("bucket", []() { return std::make_unique<Algorithms::BucketSort>(); }),
+        intOnly("bucket-prefix", []() { return std::make_unique<Algorithms::BucketSort>(Algorithms::BucketSort::Mode::PrefixSum); }),
+        intOnly("radix-lsd", []() { return std::make_unique<Algorithms::RadixSort>(); }),
+        intOnly("radix-msd", []() { return std::make_unique<Algorithms::RadixSort>(Algorithms::RadixSort::Mode::MSD); }),
+        anyKey<Algorithms::BasicBitonicSort>("bitonic"),
+        intOnly("external-merge", [memoryBudget]() { return std::make_unique<Algorithms::ExternalMergeSort>(memoryBudget); }),
+    };
+}
+
+static std::vector<std::string> splitList(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+static void printUsage()
+{
+    std::cout <<
+        "Usage: AlgorithmBenchmark [options]\n"
+        "  --algorithms a,b,...     bubble, insertion, merge, parallel-merge, quick, introsort, parallel-quick, bucket,\n"
+        "                           bucket-prefix, radix-lsd, radix-msd, bitonic, external-merge (default: all)\n"
+        "  --sizes n,m,...          element counts (default: 1000,10000,100000,1000000,10000000,100000000)\n"
+        "  --distributions d,...    random, sorted, reversed, nearly-sorted, few-unique, organ-pipe, sawtooth, zipf,\n"
+        "                           median3-killer (default: all)\n"
+        "  --keys k,...             key types of the comparison sorts: int32, int64, double (NaN last), string16,\n"
+        "                           record (key and payload); the others sort int32 only (default: int32)\n"
+        "  --instrumentation l,...  visual, counters, none: what the sort kernels report while they run; each\n"
+        "                           level's time is also given as a multiple of none's (default: all)\n"
+        "  --seed N                 seed of every generated input (default: 1)\n"
+        "  --warmup N               untimed runs before measuring (default: 1)\n"
+        "  --reps N                 measured runs per case (default: 3)\n"
+        "  --base-case k,...        sorting network kernels to compare: insertion, sse41, avx2, auto\n"
+        "                           (default: auto, the best one this CPU supports)\n"
+        "  --timeout S              seconds before a run is stopped and larger sizes skipped (default: 30)\n"
+        "  --memory-mb N            memory budget of external-merge in MiB (default: 64)\n"
+        "  --perf                   count hardware events of every run (Linux, where perf_event_open is\n"
+        "                           permitted) and report them per element, split by phase in JSON\n"
+        "  --sort-dataset IN OUT    only sort the dataset file IN into OUT with external-merge, for inputs\n"
+        "                           larger than memory, and report that one run\n"
+        "  --csv FILE               write CSV results to FILE (default: stdout)\n"
+        "  --json FILE              write JSON results to FILE\n";
+}
+
+int main(int argc, char** argv)
+{
+    Benchmark::BenchmarkConfig config;
+    config.sizes = { 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+    for (int d = 0; d < static_cast<int>(Utils::Distribution::Count); d++) {
+        config.distributions.push_back(static_cast<Utils::Distribution>(d));
+    }
+
+    std::vector<std::string> selected;
+    std::vector<Algorithms::SortingNetwork::Kernel> kernels;
+    std::string csvPath;
+    std::string jsonPath;
+    std::string datasetInput;
+    std::string datasetOutput;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string value = i + 1 < argc ? argv[i + 1] : "";
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        }
+        else if (arg == "--algorithms") {
+            selected = splitList(value);
+            i++;
+        }
+        else if (arg == "--sizes") {
+            config.sizes.clear();
+            for (const auto& size : splitList(value)) {
+                config.sizes.push_back(static_cast<size_t>(std::stod(size)));
+            }
+            i++;
+        }
+        else if (arg == "--distributions") {
+            config.distributions.clear();
+            for (const auto& name : splitList(value)) {
+                bool found = false;
+                for (int d = 0; d < static_cast<int>(Utils::Distribution::Count); d++) {
+                    auto distribution = static_cast<Utils::Distribution>(d);
+                    if (name == Utils::ArrayGenerator::getDistributionName(distribution)) {
+                        config.distributions.push_back(distribution);
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    std::cerr << "Unknown distribution: " << name << "\n";
+                    return 1;
+                }
+            }
+            i++;
+        }
+        else if (arg == "--keys") {
+            config.keyTypes.clear();
+            for (const auto& name : splitList(value)) {
+                bool found = false;
+                for (int k = 0; k < static_cast<int>(Utils::KeyType::Count); k++) {
+                    auto keyType = static_cast<Utils::KeyType>(k);
+                    if (name == Utils::getKeyTypeName(keyType)) {
+                        config.keyTypes.push_back(keyType);
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    std::cerr << "Unknown key type: " << name << "\n";
+                    return 1;
+                }
+            }
+            i++;
+        }
+        else if (arg == "--instrumentation") {
+            config.instrumentations.clear();
+            for (const auto& name : splitList(value)) {
+                bool found = false;
+                for (int l = 0; l < static_cast<int>(Algorithms::Instrumentation::Count); l++) {
+                    auto instrumentation = static_cast<Algorithms::Instrumentation>(l);
+                    if (name == Algorithms::getInstrumentationName(instrumentation)) {
+                        config.instrumentations.push_back(instrumentation);
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    std::cerr << "Unknown instrumentation: " << name << "\n";
+                    return 1;
+                }
+            }
+            i++;
+        }
+        else if (arg == "--seed") {
+            config.seed = std::stoull(value);
+            i++;
+        }
+        else if (arg == "--warmup") {
+            config.warmupRuns = std::stoi(value);
+            i++;
+        }
+        else if (arg == "--reps") {
+            config.repetitions = std::stoi(value);
+            i++;
+        }
+        else if (arg == "--base-case") {
+            for (const auto& name : splitList(value)) {
+                bool found = name == "auto";
+                auto kernel = Algorithms::SortingNetwork::getBestKernel();
+                for (auto candidate : { Algorithms::SortingNetwork::Kernel::Insertion, Algorithms::SortingNetwork::Kernel::Sse41, Algorithms::SortingNetwork::Kernel::Avx2 }) {
+                    if (name == Algorithms::SortingNetwork::getKernelName(candidate)) {
+                        kernel = candidate;
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    std::cerr << "Unknown base case: " << name << "\n";
+                    return 1;
+                }
+                kernels.push_back(kernel);
+            }
+            i++;
+        }
+        else if (arg == "--timeout") {
+            config.timeoutSeconds = std::stod(value);
+            i++;
+        }
+        else if (arg == "--memory-mb") {
+            config.memoryBudget = static_cast<size_t>(std::stod(value) * (1 << 20));
+            i++;
+        }
+        else if (arg == "--perf") {
+            Utils::setPerfEnabled(true);
+            // Times are still measured; the counter columns stay empty
+            if (!Utils::isPerfEnabled()) {
+                std::cerr << "Hardware counters unavailable: " << Utils::getPerfError() << "\n";
+            }
+        }
+        else if (arg == "--sort-dataset") {
+            datasetInput = value;
+            datasetOutput = i + 2 < argc ? argv[i + 2] : "";
+            i += 2;
+        }
+        else if (arg == "--csv") {
+            csvPath = value;
+            i++;
+        }
+        else if (arg == "--json") {
+            jsonPath = value;
+            i++;
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printUsage();
+            return 1;
+        }
+    }
+
+    auto writeReports = [&csvPath, &jsonPath](const std::vector<Benchmark::BenchmarkResult>& results) {
+        if (!csvPath.empty()) {
+            std::ofstream csv(csvPath);
+            Benchmark::ReportWriter::writeCsv(csv, results);
+        }
+        if (!jsonPath.empty()) {
+            std::ofstream json(jsonPath);
+            Benchmark::ReportWriter::writeJson(json, results);
+        }
+    };
+
+    if (!datasetInput.empty()) {
+        if (datasetOutput.empty()) {
+            std::cerr << "--sort-dataset needs an input and an output path\n";
+            return 1;
+        }
+        std::string error;
+        auto result = Benchmark::BenchmarkRunner::sortDataset(datasetInput, datasetOutput, config, error);
+        if (!error.empty()) {
+            std::cerr << "Could not sort the dataset: " << error << "\n";
+            return 1;
+        }
+        if (csvPath.empty()) {
+            Benchmark::ReportWriter::writeCsv(std::cout, { result });
+        }
+        writeReports({ result });
+        return result.sorted ? 0 : 2;
+    }
+
+    std::vector<Benchmark::AlgorithmEntry> algorithms;
+    for (auto& entry : createAlgorithms(config)) {
+        bool wanted = selected.empty();
+        for (const auto& id : selected) {
+            wanted = wanted || id == entry.id;
+        }
+        if (wanted) {
+            algorithms.push_back(entry);
+        }
+    }
+    if (algorithms.empty()) {
+        std::cerr << "No algorithms selected\n";
+        return 1;
+    }
+
+    Benchmark::BenchmarkRunner runner(algorithms);
+
+    // Progress goes to stderr so stdout stays a clean CSV stream
+    bool csvToStdout = csvPath.empty();
+    if (csvToStdout) {
+        Benchmark::ReportWriter::writeCsvHeader(std::cout);
+    }
+
+    auto onResult = [csvToStdout](const Benchmark::BenchmarkResult& result) {
+        std::cerr << result.algorithm << " / " << result.keyType << " / " << result.instrumentation << " / "
+            << result.distribution << " / " << result.size << ": "
+            << (result.timedOut ? "timed out" : std::to_string(result.meanNsPerElement) + " ns/element")
+            << (result.overhead > 0.0 && result.instrumentation != "none" ? " (" + std::to_string(result.overhead) + "x none)" : "")
+            << (result.sorted || result.timedOut ? "" : " (NOT SORTED)") << "\n";
+        if (csvToStdout) {
+            Benchmark::ReportWriter::writeCsvRow(std::cout, result);
+        }
+    };
+
+    std::vector<Benchmark::BenchmarkResult> results;
+    if (kernels.empty()) {
+        results = runner.run(config, onResult);
+    }
+    else {
+        // One full grid per kernel; names are tagged with the kernel actually selected,
+        // which falls back to a lesser one when the CPU lacks the requested instructions
+        for (auto kernel : kernels) {
+            Algorithms::SortingNetwork::setKernel(kernel);
+            config.variant = Algorithms::SortingNetwork::getKernelName(Algorithms::SortingNetwork::getKernel());
+            auto kernelResults = runner.run(config, onResult);
+            results.insert(results.end(), kernelResults.begin(), kernelResults.end());
+        }
+    }
+
+    writeReports(results);
+
+    for (const auto& result : results) {
+        if (!result.sorted && !result.timedOut) {
+            return 2;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,290 @@
+#include "BenchmarkRunner.h"
+#include "Dataset.h"
+#include "ProcessMemory.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Benchmark {
+
+    namespace {
+        // Stops a run that exceeds the timeout the same way the UI does, by clearing isSorting
+        class Watchdog {
+        public:
+            Watchdog(Algorithms::SortingStats& stats, double timeoutSeconds)
+                : thread([this, &stats, timeoutSeconds]() {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    auto timeout = std::chrono::duration<double>(timeoutSeconds);
+                    if (!condition.wait_for(lock, timeout, [this]() { return finished; })) {
+                        expired = true;
+                        stats.isSorting = false;
+                    }
+                }) {}
+
+            ~Watchdog() {
+                disarm();
+            }
+
+            // Returns true if the run was stopped by the timeout
+            bool disarm() {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    finished = true;
+                }
+                condition.notify_one();
+                if (thread.joinable()) {
+                    thread.join();
+                }
+                return expired;
+            }
+
+        private:
+            std::mutex mutex;
+            std::condition_variable condition;
+            bool finished = false;
+            bool expired = false;
+            std::thread thread;
+        };
+
+        // The same for every order of the same keys
+        template <typename Key>
+        uint64_t checksum(const Visualization::BasicVisualizationData<Key>& data) {
+            uint64_t sum = 0;
+            for (const Key& key : data.getValues()) {
+                sum += Utils::KeyTraits<Key>::hash(key);
+            }
+            return sum;
+        }
+
+        // In the order of the key's comparator, e.g. with NaN last
+        template <typename Key>
+        bool isSorted(const Visualization::BasicVisualizationData<Key>& data) {
+            typename Utils::KeyTraits<Key>::Compare compare;
+            auto array = data.getValues();
+            for (size_t i = 1; i < array.size(); i++) {
+                if (compare(array[i], array[i - 1])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Adds what recorder counted to result, phase by phase
+        void addPerf(BenchmarkResult& result, const Utils::PerfRecorder& recorder) {
+            for (const auto& phase : recorder.getPhases()) {
+                auto same = std::find_if(result.perfPhases.begin(), result.perfPhases.end(),
+                    [&phase](const Utils::PerfPhase& other) { return other.name == phase.name; });
+                if (same == result.perfPhases.end()) {
+                    result.perfPhases.push_back(phase);
+                }
+                else {
+                    same->sample.add(phase.sample);
+                }
+                result.perf.add(phase.sample);
+            }
+        }
+
+        void scalePerf(BenchmarkResult& result, double factor) {
+            result.perf.scale(factor);
+            for (auto& phase : result.perfPhases) {
+                phase.sample.scale(factor);
+            }
+        }
+    }
+
+    BenchmarkRunner::BenchmarkRunner(std::vector<AlgorithmEntry> algorithms) : algorithms(std::move(algorithms)) {}
+
+    std::vector<BenchmarkResult> BenchmarkRunner::run(const BenchmarkConfig& config,
+        const std::function<void(const BenchmarkResult&)>& onResult) {
+        std::vector<BenchmarkResult> results;
+
+        // Without instrumentation first, so the other levels can be reported against it as they finish
+        auto instrumentations = config.instrumentations;
+        std::sort(instrumentations.begin(), instrumentations.end(), std::greater<>());
+        instrumentations.erase(std::unique(instrumentations.begin(), instrumentations.end()), instrumentations.end());
+
+        for (const auto& entry : algorithms) {
+            for (auto keyType : config.keyTypes) {
+                Utils::visitKeyType(keyType, [&](auto key) {
+                    using Key = typename decltype(key)::type;
+                    const auto& create = entry.template getFactory<Key>();
+                    if (!create) {
+                        return;
+                    }
+                    // Algorithms without instrumented kernels run the same code at every level, so only once
+                    bool instrumented = create()->supportsInstrumentation();
+                    std::vector<Algorithms::Instrumentation> levels = instrumented
+                        ? instrumentations : std::vector<Algorithms::Instrumentation>{ Algorithms::Instrumentation::Visual };
+
+                    for (auto distribution : config.distributions) {
+                        for (size_t size : config.sizes) {
+                            bool timedOut = false;
+                            double bareNsPerElement = 0.0;
+                            for (auto instrumentation : levels) {
+                                BenchmarkResult result = runCase(create, distribution, size, instrumentation, config);
+                                if (instrumentation == Algorithms::Instrumentation::None && !result.timedOut) {
+                                    bareNsPerElement = result.meanNsPerElement;
+                                }
+                                if (bareNsPerElement > 0.0 && !result.timedOut) {
+                                    result.overhead = result.meanNsPerElement / bareNsPerElement;
+                                }
+                                results.push_back(result);
+                                if (onResult) {
+                                    onResult(result);
+                                }
+                                timedOut = timedOut || result.timedOut;
+                            }
+
+                            // Larger inputs would only take longer
+                            if (timedOut) {
+                                break;
+                            }
+                        }
+                    }
+                });
+            }
+        }
+
+        return results;
+    }
+
+    template <typename Key>
+    BenchmarkResult BenchmarkRunner::runCase(const AlgorithmFactory<Key>& create, Utils::Distribution distribution,
+        size_t size, Algorithms::Instrumentation instrumentation, const BenchmarkConfig& config) {
+        BenchmarkResult result;
+        result.keyType = Utils::getKeyTypeName(Utils::KeyTraits<Key>::type);
+        result.instrumentation = Algorithms::getInstrumentationName(instrumentation);
+        result.distribution = Utils::ArrayGenerator::getDistributionName(distribution);
+        result.size = size;
+        result.sorted = true;
+        result.minNsPerElement = 0.0;
+
+        double totalNs = 0.0;
+        resetPeakRss();
+
+        for (int run = 0; run < config.warmupRuns + config.repetitions; run++) {
+            bool measured = run >= config.warmupRuns;
+
+            Visualization::BasicVisualizationData<Key> data(static_cast<int>(size));
+            Utils::GeneratorOptions options;
+            options.seed = config.seed;
+            options.min = config.minValue;
+            options.max = config.maxValue;
+            Utils::ArrayGenerator::generateArray(data, distribution, options);
+            uint64_t expectedChecksum = checksum(data);
+
+            auto algorithm = create();
+            result.algorithm = algorithm->getName();
+            if (!config.variant.empty()) {
+                result.algorithm += " [" + config.variant + "]";
+            }
+
+            // No delay between steps and no undo log, only the algorithm itself
+            Algorithms::SortingStats stats;
+            stats.speedFactor = 0;
+            stats.recordHistory = false;
+
+            Watchdog watchdog(stats, config.timeoutSeconds);
+            auto start = std::chrono::steady_clock::now();
+            {
+                Utils::PerfScope perf(&stats.perf);
+                if (algorithm->supportsInstrumentation()) {
+                    algorithm->runInstrumented(data, stats, instrumentation);
+                }
+                else {
+                    algorithm->run(data, stats);
+                }
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            if (watchdog.disarm()) {
+                result.timedOut = true;
+                result.sorted = false;
+                break;
+            }
+
+            result.sorted = result.sorted && isSorted(data) && checksum(data) == expectedChecksum;
+
+            if (measured) {
+                double ns = std::chrono::duration<double, std::nano>(end - start).count();
+                double nsPerElement = ns / static_cast<double>(std::max<size_t>(size, 1));
+                totalNs += nsPerElement;
+                result.minNsPerElement = result.repetitions == 0 ? nsPerElement : std::min(result.minNsPerElement, nsPerElement);
+                result.repetitions++;
+                result.comparisons = stats.comparisons;
+                result.swaps = stats.swaps;
+                result.bytesReadPerElement = static_cast<double>(stats.bytesRead) / static_cast<double>(std::max<size_t>(size, 1));
+                result.bytesWrittenPerElement = static_cast<double>(stats.bytesWritten) / static_cast<double>(std::max<size_t>(size, 1));
+                addPerf(result, stats.perf);
+            }
+        }
+
+        if (result.repetitions > 0) {
+            result.meanNsPerElement = totalNs / result.repetitions;
+            scalePerf(result, 1.0 / result.repetitions);
+        }
+        result.peakRssBytes = getPeakRss();
+
+        return result;
+    }
+
+    BenchmarkResult BenchmarkRunner::sortDataset(const std::string& inputPath, const std::string& outputPath,
+        const BenchmarkConfig& config, std::string& error) {
+        BenchmarkResult result;
+        resetPeakRss();
+
+        Algorithms::ExternalMergeSort algorithm(config.memoryBudget);
+        result.algorithm = algorithm.getName();
+        result.keyType = Utils::getKeyTypeName(Utils::KeyType::Int32);
+        result.instrumentation = Algorithms::getInstrumentationName(Algorithms::Instrumentation::Visual);
+        Algorithms::SortingStats stats;
+        stats.speedFactor = 0;
+        stats.recordHistory = false;
+
+        Watchdog watchdog(stats, config.timeoutSeconds);
+        auto start = std::chrono::steady_clock::now();
+        bool sorted = false;
+        {
+            Utils::PerfScope perf(&stats.perf);
+            sorted = algorithm.sortDataset(inputPath, outputPath, stats, error);
+        }
+        auto end = std::chrono::steady_clock::now();
+        result.timedOut = watchdog.disarm();
+        result.peakRssBytes = getPeakRss();
+        if (result.timedOut) {
+            error = "timed out";
+            return result;
+        }
+        if (!sorted) {
+            return result;
+        }
+
+        // Checked through a mapping of its own, so the check needs no more memory than the sort did
+        Utils::Dataset output;
+        if (!output.open(outputPath, error)) {
+            return result;
+        }
+        std::span<const int> values = output.getValues();
+        const Utils::DatasetHeader& header = output.getHeader();
+        result.distribution = header.distribution >= 0
+            ? Utils::ArrayGenerator::getDistributionName(static_cast<Utils::Distribution>(header.distribution))
+            : "dataset";
+        result.size = values.size();
+        result.repetitions = 1;
+        result.sorted = std::is_sorted(values.begin(), values.end());
+
+        double elements = static_cast<double>(std::max<size_t>(result.size, 1));
+        result.meanNsPerElement = std::chrono::duration<double, std::nano>(end - start).count() / elements;
+        result.minNsPerElement = result.meanNsPerElement;
+        result.comparisons = stats.comparisons;
+        result.swaps = stats.swaps;
+        result.bytesReadPerElement = static_cast<double>(stats.bytesRead) / elements;
+        result.bytesWrittenPerElement = static_cast<double>(stats.bytesWritten) / elements;
+        addPerf(result, stats.perf);
+        return result;
+    }
+
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "Algorithm.h"
+#include "ArrayGenerator.h"
+#include "ExternalMergeSort.h"
+#include "Keys.h"
+#include "PerfCounters.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace Benchmark {
+
+    template <typename Key>
+    using AlgorithmFactory = std::function<std::unique_ptr<Algorithms::BasicAlgorithm<Key>>()>;
+
+    // One factory per key type; empty for the key types the algorithm cannot sort
+    struct AlgorithmEntry {
+        std::string id;
+        std::tuple<AlgorithmFactory<int>, AlgorithmFactory<int64_t>, AlgorithmFactory<double>,
+            AlgorithmFactory<Utils::FixedString>, AlgorithmFactory<Utils::Record>> create;
+
+        template <typename Key>
+        const AlgorithmFactory<Key>& getFactory() const { return std::get<AlgorithmFactory<Key>>(create); }
+    };
+
+    struct BenchmarkConfig {
+        std::vector<size_t> sizes;
+        std::vector<Utils::Distribution> distributions;
+        // Every algorithm sorts each of these it supports
+        std::vector<Utils::KeyType> keyTypes = { Utils::KeyType::Int32 };
+        // Levels the algorithms with instrumented kernels run at; the others always run fully instrumented
+        std::vector<Algorithms::Instrumentation> instrumentations = {
+            Algorithms::Instrumentation::Visual, Algorithms::Instrumentation::Counters, Algorithms::Instrumentation::None };
+        int warmupRuns = 1;
+        int repetitions = 3;
+        // A run taking longer than this is stopped and larger sizes are skipped
+        double timeoutSeconds = 30.0;
+        int minValue = 0;
+        int maxValue = 1000000000;
+        // Every input is generated from this seed, so runs can be repeated exactly
+        uint64_t seed = 1;
+        // Appended to the algorithm name in brackets when set, e.g. the sorting network kernel
+        std::string variant;
+        // Bytes of values the external merge sort may hold in memory at once
+        size_t memoryBudget = Algorithms::ExternalMergeSort::DEFAULT_MEMORY_BUDGET;
+    };
+
+    struct BenchmarkResult {
+        std::string algorithm;
+        std::string keyType;
+        std::string instrumentation;
+        std::string distribution;
+        size_t size = 0;
+        int repetitions = 0;
+        double meanNsPerElement = 0.0;
+        double minNsPerElement = 0.0;
+        // Mean time over that of the same case without instrumentation, 0 when that was not run
+        double overhead = 0.0;
+        long long comparisons = 0;
+        long long swaps = 0;
+        // Traffic to temporary files, for algorithms that sort out of memory
+        double bytesReadPerElement = 0.0;
+        double bytesWrittenPerElement = 0.0;
+        size_t peakRssBytes = 0;
+        // Hardware counters, mean of the measured runs; empty unless counting is on and permitted
+        Utils::PerfSample perf;
+        std::vector<Utils::PerfPhase> perfPhases;
+        bool sorted = false;
+        bool timedOut = false;
+    };
+
+    // Drives every algorithm over a grid of sizes and distributions without any rendering or delays
+    class BenchmarkRunner {
+    public:
+        BenchmarkRunner(std::vector<AlgorithmEntry> algorithms);
+
+        std::vector<BenchmarkResult> run(const BenchmarkConfig& config,
+            const std::function<void(const BenchmarkResult&)>& onResult);
+
+        // Sorts a dataset file into another with the external merge sort, once, and checks the output
+        static BenchmarkResult sortDataset(const std::string& inputPath, const std::string& outputPath,
+            const BenchmarkConfig& config, std::string& error);
+
+    private:
+        std::vector<AlgorithmEntry> algorithms;
+
+        template <typename Key>
+        BenchmarkResult runCase(const AlgorithmFactory<Key>& create, Utils::Distribution distribution,
+            size_t size, Algorithms::Instrumentation instrumentation, const BenchmarkConfig& config);
+    };
+
+}
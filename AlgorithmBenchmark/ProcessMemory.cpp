@@ -0,0 +1,54 @@
+#include "ProcessMemory.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <fstream>
+#include <string>
+#include <sys/resource.h>
+#endif
+
+namespace Benchmark {
+
+    size_t getPeakRss() {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return counters.PeakWorkingSetSize;
+        }
+        return 0;
+#else
+        // VmHWM follows resetPeakRss(); ru_maxrss is the lifetime peak
+        std::ifstream status("/proc/self/status");
+        std::string key;
+        while (status >> key) {
+            if (key == "VmHWM:") {
+                size_t kilobytes = 0;
+                status >> kilobytes;
+                return kilobytes * 1024;
+            }
+        }
+
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+            return static_cast<size_t>(usage.ru_maxrss);
+#else
+            return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+        }
+        return 0;
+#endif
+    }
+
+    void resetPeakRss() {
+#if defined(__linux__)
+        std::ofstream clearRefs("/proc/self/clear_refs");
+        clearRefs << "5";
+#endif
+    }
+
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstddef>
+
+namespace Benchmark {
+
+    // Peak resident set size of this process in bytes, 0 if unavailable
+    size_t getPeakRss();
+
+    // Start a new peak measurement where the platform allows it (Linux only)
+    void resetPeakRss();
+
+}
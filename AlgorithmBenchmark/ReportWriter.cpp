@@ -0,0 +1,117 @@
+#include "ReportWriter.h"
+#include <algorithm>
+
+namespace Benchmark {
+
+    namespace {
+        constexpr int EVENT_COUNT = static_cast<int>(Utils::PerfEvent::Count);
+
+        double perElement(const Utils::PerfSample& sample, Utils::PerfEvent event, size_t size) {
+            return sample.get(event) / static_cast<double>(std::max<size_t>(size, 1));
+        }
+    }
+
+    void ReportWriter::writeCsvHeader(std::ostream& out) {
+        out << "algorithm,key_type,instrumentation,distribution,size,repetitions,mean_ns_per_element,min_ns_per_element,overhead,"
+            << "comparisons,swaps,bytes_read_per_element,bytes_written_per_element,peak_rss_bytes,";
+        for (int e = 0; e < EVENT_COUNT; e++) {
+            out << Utils::getPerfEventName(static_cast<Utils::PerfEvent>(e)) << "_per_element,";
+        }
+        out << "ipc,sorted,timed_out\n";
+    }
+
+    void ReportWriter::writeCsvRow(std::ostream& out, const BenchmarkResult& result) {
+        out << '"' << result.algorithm << "\","
+            << result.keyType << ','
+            << result.instrumentation << ','
+            << result.distribution << ','
+            << result.size << ','
+            << result.repetitions << ','
+            << result.meanNsPerElement << ','
+            << result.minNsPerElement << ','
+            << result.overhead << ','
+            << result.comparisons << ','
+            << result.swaps << ','
+            << result.bytesReadPerElement << ','
+            << result.bytesWrittenPerElement << ','
+            << result.peakRssBytes << ',';
+        // Left empty where the event was not counted
+        for (int e = 0; e < EVENT_COUNT; e++) {
+            auto event = static_cast<Utils::PerfEvent>(e);
+            if (result.perf.has(event)) {
+                out << perElement(result.perf, event, result.size);
+            }
+            out << ',';
+        }
+        if (result.perf.getIpc() > 0.0) {
+            out << result.perf.getIpc();
+        }
+        out << ','
+            << (result.sorted ? "true" : "false") << ','
+            << (result.timedOut ? "true" : "false") << '\n';
+    }
+
+    void ReportWriter::writeCsv(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+        writeCsvHeader(out);
+        for (const auto& result : results) {
+            writeCsvRow(out, result);
+        }
+    }
+
+    void ReportWriter::writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+        out << "[\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const auto& result = results[i];
+            out << "  {"
+                << "\"algorithm\": \"" << result.algorithm << "\", "
+                << "\"key_type\": \"" << result.keyType << "\", "
+                << "\"instrumentation\": \"" << result.instrumentation << "\", "
+                << "\"distribution\": \"" << result.distribution << "\", "
+                << "\"size\": " << result.size << ", "
+                << "\"repetitions\": " << result.repetitions << ", "
+                << "\"mean_ns_per_element\": " << result.meanNsPerElement << ", "
+                << "\"min_ns_per_element\": " << result.minNsPerElement << ", "
+                << "\"overhead\": " << result.overhead << ", "
+                << "\"comparisons\": " << result.comparisons << ", "
+                << "\"swaps\": " << result.swaps << ", "
+                << "\"bytes_read_per_element\": " << result.bytesReadPerElement << ", "
+                << "\"bytes_written_per_element\": " << result.bytesWrittenPerElement << ", "
+                << "\"peak_rss_bytes\": " << result.peakRssBytes << ", ";
+            writeJsonPerf(out, result.perf, result.size);
+            out << ", \"phases\": [";
+            for (size_t p = 0; p < result.perfPhases.size(); p++) {
+                const auto& phase = result.perfPhases[p];
+                out << (p > 0 ? ", " : "") << "{\"name\": \"" << phase.name << "\", ";
+                writeJsonPerf(out, phase.sample, result.size);
+                out << "}";
+            }
+            out << "], "
+                << "\"sorted\": " << (result.sorted ? "true" : "false") << ", "
+                << "\"timed_out\": " << (result.timedOut ? "true" : "false")
+                << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "]\n";
+    }
+
+    void ReportWriter::writeJsonPerf(std::ostream& out, const Utils::PerfSample& sample, size_t size) {
+        for (int e = 0; e < EVENT_COUNT; e++) {
+            auto event = static_cast<Utils::PerfEvent>(e);
+            out << "\"" << Utils::getPerfEventName(event) << "_per_element\": ";
+            if (sample.has(event)) {
+                out << perElement(sample, event, size);
+            }
+            else {
+                out << "null";
+            }
+            out << ", ";
+        }
+        out << "\"ipc\": ";
+        if (sample.getIpc() > 0.0) {
+            out << sample.getIpc();
+        }
+        else {
+            out << "null";
+        }
+    }
+
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "BenchmarkRunner.h"
+#include <ostream>
+#include <vector>
+
+namespace Benchmark {
+
+    class ReportWriter {
+    public:
+        static void writeCsvHeader(std::ostream& out);
+        static void writeCsvRow(std::ostream& out, const BenchmarkResult& result);
+        static void writeCsv(std::ostream& out, const std::vector<BenchmarkResult>& results);
+
+        static void writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results);
+
+    private:
+        // Every hardware event and IPC per element, as JSON members without a trailing comma; null where not counted
+        static void writeJsonPerf(std::ostream& out, const Utils::PerfSample& sample, size_t size);
+    };
+
+}
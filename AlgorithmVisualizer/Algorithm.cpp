@@ -1,5 +1,65 @@
 #include "Algorithm.h"
+#include "SnapshotBuffer.h"
+#include "SortingWorker.h"
+#include <thread>
+#include <chrono>
 
 namespace Algorithms {
-	Algorithm::Algorithm(const std::string& name) : name(name) {}
-}
\ No newline at end of file
+	AlgorithmBase::AlgorithmBase(const std::string& name) : name(name) {}
+
+	void AlgorithmBase::pace(const SortingStats& stats) const {
+		if (stats.snapshots) {
+			stats.snapshots->publish(stats, getPhaseName());
+		}
+		wait(stats);
+	}
+
+	void AlgorithmBase::pace(const SortingStats& stats, TeamPacer& team) const {
+		if (stats.snapshots && team.beginPublish()) {
+			stats.snapshots->publish(stats, getPhaseName());
+			team.endPublish();
+		}
+		// Out of the array while waiting, e.g. while paused, so the others can publish
+		team.leave();
+		wait(stats);
+		team.enter();
+	}
+
+	void AlgorithmBase::wait(const SortingStats& stats) const {
+		if (stats.worker) {
+			stats.worker->pace();
+		}
+		else if (stats.speedFactor > 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(stats.speedFactor.load()));
+		}
+	}
+
+	void TeamPacer::enter() {
+		std::unique_lock<std::mutex> lock(mutex);
+		changed.wait(lock, [this] { return !publishRequested.load(std::memory_order_relaxed); });
+		inside++;
+	}
+
+	void TeamPacer::leave() {
+		std::lock_guard<std::mutex> lock(mutex);
+		inside--;
+		changed.notify_all();
+	}
+
+	bool TeamPacer::beginPublish() {
+		std::unique_lock<std::mutex> lock(mutex);
+		if (publishRequested.load(std::memory_order_relaxed)) {
+			return false;
+		}
+		// New members wait in enter() from here on; the caller is the one left inside
+		publishRequested.store(true, std::memory_order_relaxed);
+		changed.wait(lock, [this] { return inside == 1; });
+		return true;
+	}
+
+	void TeamPacer::endPublish() {
+		std::lock_guard<std::mutex> lock(mutex);
+		publishRequested.store(false, std::memory_order_relaxed);
+		changed.notify_all();
+	}
+}
@@ -1,23 +1,64 @@
 #pragma once
 #include "VisualizationData.h"
 #include "SortingStats.h"
+#include "Keys.h"
+#include "Instrumentation.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <type_traits>
 
 namespace Algorithms {
-	class Algorithm
+    // Keeps the threads of a team out of the array while one of them publishes a frame. Members
+    // enter before they touch the array and leave when done; a member pacing waits until every
+    // other member that entered has left or is pacing too, and only the first of them publishes.
+    // Members waiting for work call park() so they do not hold the publisher up.
+    class TeamPacer {
+    public:
+        void enter();
+        void leave();
+
+        // Leaves and enters again if a member is waiting to publish
+        void park() {
+            if (publishRequested.load(std::memory_order_relaxed)) {
+                leave();
+                enter();
+            }
+        }
+
+    private:
+        friend class AlgorithmBase;
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        int inside = 0;
+        std::atomic<bool> publishRequested{ false };
+
+        // True once the caller is alone in the array, then endPublish lets the others go;
+        // false if another member publishes, after it has
+        bool beginPublish();
+        void endPublish();
+    };
+
+	// What every algorithm has, whatever keys it sorts; the worker drives algorithms through it
+	class AlgorithmBase
 	{
     public:
-        Algorithm(const std::string& name);
-        virtual ~Algorithm() = default;
+        AlgorithmBase(const std::string& name);
+        virtual ~AlgorithmBase() = default;
 
         // Get algorithm name
         const std::string& getName() const { return name; }
 
-        // Execute one step of the algorithm
-        virtual void step(Visualization::VisualizationData& data, SortingStats& stats) = 0;
+        // Whether step() is implemented; algorithms without it can only be run to completion
+        virtual bool supportsStepping() const { return true; }
 
-        // Run the complete algorithm
-        virtual void run(Visualization::VisualizationData& data, SortingStats& stats) = 0;
+        // Whether every array change goes through SortingStats, which the undo log and timeline rely on
+        virtual bool supportsRecording() const { return true; }
+
+        // Whether runInstrumented() has a kernel for every instrumentation level; otherwise it is run()
+        virtual bool supportsInstrumentation() const { return false; }
 
         // Check if the algorithm has completed
         virtual bool isComplete(const SortingStats& stats) const = 0;
@@ -25,8 +66,76 @@ namespace Algorithms {
         // Reset the algorithm state
         virtual void reset() = 0;
 
+        // What the algorithm is currently doing, or nullptr when it has no distinct phases
+        virtual const char* getPhaseName() const { return nullptr; }
+
     protected:
         std::string name;
+
+        // Publish a frame to stats.snapshots, if set, then wait between steps so the
+        // visualization can follow; stats.worker, if set, takes its commands and cuts the
+        // wait short when one arrives. The wait is skipped when speedFactor is 0
+        void pace(const SortingStats& stats) const;
+        // The same for a member of team, which publishes for all of them and lets the others
+        // into the array while it waits
+        void pace(const SortingStats& stats, TeamPacer& team) const;
+
+    private:
+        void wait(const SortingStats& stats) const;
 	};
-}
 
+    // An algorithm sorting keys of type Key in the order of Compare. Comparison sorts are templates
+    // instantiated for every key type in Keys.h; the comparator is a member called inline, so the int
+    // instantiation compiles to the same comparisons as a sort written for ints.
+    template <typename Key, typename Compare = typename Utils::KeyTraits<Key>::Compare>
+    class BasicAlgorithm : public AlgorithmBase {
+    public:
+        BasicAlgorithm(const std::string& name, Compare compare = Compare()) : AlgorithmBase(name), compare(compare) {}
+
+        // Execute one step of the algorithm
+        virtual void step(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) = 0;
+
+        // Run the complete algorithm
+        virtual void run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) = 0;
+
+        // Sort the whole array at once, without stepping, pacing, undo log or trace, reporting what
+        // instrumentation asks for. Algorithms with a kernel templated on the instrumentation policy
+        // override it; for the others it is run() at any level.
+        virtual void runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation) {
+            run(data, stats);
+        }
+
+        // The undo log and the timeline hold ints
+        bool supportsRecording() const override { return std::is_same_v<Key, int>; }
+
+    protected:
+        Compare compare;
+
+        // Start stats afresh, call sort(Policy()) with the policy of instrumentation, and complete
+        // the sort unless it was stopped; runInstrumented overrides are this around their kernel
+        template <typename Sort>
+        void runKernel(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation, Sort&& sort) {
+            reset();
+            stats.reset();
+            stats.isSorting = true;
+            data.resetHighlighting();
+            // Copy shared values here, once, so team threads that ask for the array all get the same one
+            data.getValues();
+
+            visitInstrumentation(instrumentation, sort);
+
+            // Kernels without highlights mark nothing dirty
+            data.resetHighlighting();
+            data.markAllDirty();
+            data.markedLow = -1;
+            data.markedHigh = -1;
+            if (stats.isSorting) {
+                stats.sortingComplete = true;
+                stats.isSorting = false;
+            }
+        }
+    };
+
+    // Algorithms that only sort ints, e.g. by their digits, derive from this one
+    using Algorithm = BasicAlgorithm<int>;
+}
@@ -10,11 +10,24 @@
 #include "BubbleSort.h"
 #include "InsertionSort.h"
 #include "MergeSort.h"
+#include "ParallelMergeSort.h"
 #include "QuickSort.h"
+#include "ParallelQuickSort.h"
 #include "BucketSort.h"
+#include "RadixSort.h"
+#include "BitonicSort.h"
+#include "ExternalMergeSort.h"
 #include "ArrayGenerator.h"
-
-#include <thread>
+#include "Timeline.h"
+#include "SnapshotBuffer.h"
+#include "SortingWorker.h"
+#include "Scheduler.h"
+#include "VirtualClock.h"
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <type_traits>
 #include <vector>
 #include <memory>
 
@@ -25,97 +38,395 @@ static void GLFWErrorCallback(int error, const char* description)
 	std::cout << "GLFW Error: " << description << " code: " << error << "\n";
 }
 
-// Structure to hold all components for a single algorithm visualization
+// Structure to hold all components for a single algorithm visualization, whatever keys it sorts
 struct AlgorithmContext {
     std::string name;
-    Visualization::VisualizationData visualizationData;
+    Utils::KeyType keyType;
     Algorithms::SortingStats sortingStats;
     Rendering::Renderer renderer;
-    std::unique_ptr<Algorithms::Algorithm> algorithm;
-    std::thread sortingThread;
+    Algorithms::Timeline timeline;
     int arraySize;
-    bool prevSteppingMode;
+    // Input the window generates; every window starts from the same seed, so from the same array
+    Utils::Distribution distribution = Utils::Distribution::Random;
+    Utils::GeneratorOptions generatorOptions;
     bool isStepsEnable;
+    bool isOpen = true;
+    // Sorting the race input against the race clock
+    bool inRace = false;
+
+    AlgorithmContext(const std::string& name, Utils::KeyType keyType, int size, bool isStepsEnable)
+        : name(name), keyType(keyType), arraySize(size), isStepsEnable(isStepsEnable) {}
+    virtual ~AlgorithmContext() = default;
+
+    virtual Algorithms::AlgorithmBase& getAlgorithm() = 0;
+    virtual Algorithms::SortingWorker& getWorker() = 0;
+    // What the render loop draws; the live data and stats belong to the worker unless it is idle
+    virtual Visualization::SnapshotBuffer& getSnapshots() = 0;
+    // The controls and the view of the window's contents
+    virtual void render() = 0;
+};
 
-    AlgorithmContext(const std::string& name, int size, std::unique_ptr<Algorithms::Algorithm> algo, bool isStepsEnable)
-        : name(name),
+// The array of one key type and the algorithm sorting it
+template <typename Key>
+struct KeyedAlgorithmContext : AlgorithmContext {
+    Visualization::BasicVisualizationData<Key> visualizationData;
+    Visualization::SnapshotBuffer snapshots;
+    std::unique_ptr<Algorithms::BasicAlgorithm<Key>> algorithm;
+    // Declared last: it is scheduled only once everything it uses exists, and waits for its running slice before any of it goes away
+    Algorithms::SortingWorker worker;
+
+    KeyedAlgorithmContext(const std::string& name, int size, std::unique_ptr<Algorithms::BasicAlgorithm<Key>> algo, bool isStepsEnable)
+        : AlgorithmContext(name, Utils::KeyTraits<Key>::type, size, isStepsEnable),
           visualizationData(size),
+          snapshots(visualizationData),
           algorithm(std::move(algo)),
-          arraySize(size),
-          isStepsEnable(isStepsEnable),
-          prevSteppingMode(false) {
+          worker(*algorithm, visualizationData, sortingStats, snapshots) {
         // Generate initial random array
-        Utils::ArrayGenerator::generateRandomArray(visualizationData);
+        Utils::ArrayGenerator::generateArray(visualizationData, distribution, generatorOptions);
+        sortingStats.snapshots = &snapshots;
+        // The undo log holds ints; other keys could only be half recorded
+        sortingStats.recordHistory = algorithm->supportsRecording();
     }
+
+    Algorithms::AlgorithmBase& getAlgorithm() override { return *algorithm; }
+    Algorithms::SortingWorker& getWorker() override { return worker; }
+    Visualization::SnapshotBuffer& getSnapshots() override { return snapshots; }
+    void render() override;
 };
 
-// Function to handle algorithm execution logic
-void handleAlgorithmExecution(AlgorithmContext& context) {
-    // Render controls and check if we need to generate a new array
-    bool generateNewArray = context.renderer.renderControls(context.visualizationData, context.sortingStats, context.arraySize, context.isStepsEnable);
-
-    // Handle mode switching while sorting is in progress
-    // If we just switched to stepping mode while sorting was in progress,
-    // we need to stop the sorting thread and continue in stepping mode
-    if (context.sortingStats.steppingMode && !context.prevSteppingMode && 
-        context.sortingStats.isSorting && context.sortingThread.joinable()) {
-        context.sortingStats.isSorting = false;
-        context.sortingThread.join();
-        context.sortingStats.isSorting = true;
-    }
-    // If we just switched from stepping mode to continuous mode,
-    // we don't automatically start sorting - user needs to click Resume
-    else if (!context.sortingStats.steppingMode && context.prevSteppingMode && context.sortingStats.currentStep > 0) {
-        context.sortingStats.isSorting = false;
-    }
-    
-    // Update previous stepping mode for next frame
-    context.prevSteppingMode = context.sortingStats.steppingMode;
+// An algorithm the visualizer can open a window for
+struct AlgorithmEntry {
+    std::string name;
+    int size;
+    bool isStepsEnable;
+    // Comparison sorts open for any key type, the others for ints whatever keyType asks for
+    bool anyKey;
+    std::function<std::unique_ptr<AlgorithmContext>(const std::string& name, Utils::KeyType keyType)> open;
+};
 
-    if (generateNewArray) {
-        Utils::ArrayGenerator::generateRandomArray(context.visualizationData);
+// Entry of an algorithm that sorts ints only
+static AlgorithmEntry intEntry(const std::string& name, int size, bool isStepsEnable,
+    std::function<std::unique_ptr<Algorithms::Algorithm>()> create)
+{
+    return { name, size, isStepsEnable, false, [=](const std::string& title, Utils::KeyType) -> std::unique_ptr<AlgorithmContext> {
+        return std::make_unique<KeyedAlgorithmContext<int>>(title, size, create(), isStepsEnable);
+    } };
+}
+
+// Entry of a comparison sort, instantiated for the key type asked for with that key's comparator
+template <template <typename, typename> class Sort, typename... Args>
+static AlgorithmEntry keyEntry(const std::string& name, int size, bool isStepsEnable, Args... args)
+{
+    return { name, size, isStepsEnable, true, [=](const std::string& title, Utils::KeyType keyType) {
+        return Utils::visitKeyType(keyType, [&](auto key) -> std::unique_ptr<AlgorithmContext> {
+            using Key = typename decltype(key)::type;
+            auto algorithm = std::make_unique<Sort<Key, typename Utils::KeyTraits<Key>::Compare>>(args...);
+            return std::make_unique<KeyedAlgorithmContext<Key>>(title, size, std::move(algorithm), isStepsEnable);
+        });
+    } };
+}
+
+static std::vector<AlgorithmEntry> createAlgorithmEntries()
+{
+    return {
+        keyEntry<Algorithms::BasicBubbleSort>("Bubble Sort", 100, true),
+        keyEntry<Algorithms::BasicInsertionSort>("Insertion Sort", 100, true),
+        keyEntry<Algorithms::BasicMergeSort>("Merge Sort", 100, true),
+        // MergeSort on all cores
+        keyEntry<Algorithms::BasicParallelMergeSort>("Parallel Merge Sort", 100, false),
+        keyEntry<Algorithms::BasicQuickSort>("Quick Sort", 100, true),
+        keyEntry<Algorithms::BasicQuickSort>("Quick Sort (Introsort)", 100, true, Algorithms::QuickSortMode::Introsort),
+        // QuickSort on all cores
+        keyEntry<Algorithms::BasicParallelQuickSort>("Parallel Quick Sort", 100, false),
+        intEntry("Bucket Sort", 100, true, []() { return std::make_unique<Algorithms::BucketSort>(); }),
+        // BucketSort with contiguous prefix-sum buckets
+        intEntry("Bucket Sort (Prefix Sum)", 100, true, []() { return std::make_unique<Algorithms::BucketSort>(Algorithms::BucketSort::Mode::PrefixSum); }),
+        // RadixSort, least and most significant digit first
+        intEntry("Radix Sort (LSD)", 100, true, []() { return std::make_unique<Algorithms::RadixSort>(); }),
+        intEntry("Radix Sort (MSD)", 100, true, []() { return std::make_unique<Algorithms::RadixSort>(Algorithms::RadixSort::Mode::MSD); }),
+        // The bitonic sorting network
+        keyEntry<Algorithms::BasicBitonicSort>("Bitonic Network", 64, true),
+        // MergeSort through temporary files; a budget of a quarter of the array makes eight runs, merged at once
+        intEntry("External Merge Sort", 1 << 17, false, []() { return std::make_unique<Algorithms::ExternalMergeSort>(size_t(128) << 10); }),
+    };
+}
+
+// Function to render the shared scheduler's state and the choice of window to open
+void renderScheduler(const std::vector<AlgorithmEntry>& entries, int& selectedEntry, int& selectedKeyType, size_t windowCount) {
+    auto& scheduler = Algorithms::Scheduler::getDefault();
+    ImGui::Text("Windows: %d, pool threads busy: %d / %d", static_cast<int>(windowCount),
+        scheduler.getBusyThreads(), scheduler.getThreadCount());
+
+    // Caps the threads all windows together may keep busy, including those lent to parallel algorithms
+    int budget = scheduler.getThreadBudget();
+    if (ImGui::SliderInt("CPU Budget (threads)", &budget, 1, scheduler.getThreadCount())) {
+        scheduler.setThreadBudget(budget);
+    }
+
+    ImGui::Combo("Algorithm", &selectedEntry, [](void* data, int index) {
+        return static_cast<const std::vector<AlgorithmEntry>*>(data)->at(index).name.c_str();
+    }, const_cast<std::vector<AlgorithmEntry>*>(&entries), static_cast<int>(entries.size()));
+
+    // The algorithm is instantiated for the key type, with its comparator: doubles put NaN last, strings
+    // compare bytewise, records compare their key only
+    ImGui::Combo("Key Type", &selectedKeyType, [](void*, int index) {
+        return Utils::getKeyTypeName(static_cast<Utils::KeyType>(index));
+    }, nullptr, static_cast<int>(Utils::KeyType::Count));
+    if (!entries[selectedEntry].anyKey) {
+        ImGui::TextDisabled("%s sorts ints only", entries[selectedEntry].name.c_str());
+    }
+
+    // Counted from the next slice of every window on; the stats panels show them once a run has some
+    bool perfEnabled = Utils::isPerfEnabled();
+    ImGui::BeginDisabled(!Utils::isPerfAvailable());
+    if (ImGui::Checkbox("Hardware Counters", &perfEnabled)) {
+        Utils::setPerfEnabled(perfEnabled);
+    }
+    ImGui::EndDisabled();
+    if (!Utils::isPerfAvailable()) {
+        ImGui::TextDisabled("Unavailable: %s", Utils::getPerfError().c_str());
+    }
+}
+
+// One input sorted by every steppable window, all paced by a common virtual clock
+struct RaceState {
+    // Shared copy-on-write by the windows, kept to run the race again on the same input
+    std::shared_ptr<const std::vector<int>> input;
+    Visualization::ValueOrigin inputOrigin;
+    Algorithms::VirtualClock clock;
+    Algorithms::CostModel costModel;
+    int size = 1000;
+    int distribution = static_cast<int>(Utils::Distribution::Random);
+    uint64_t seed = 1;
+    float rate = 20000.0f;
+    bool running = false;
+};
+
+// Hand the race input to every window that can step and start them against a restarted clock.
+// Windows that are running, showing a timeline or sorting other keys than ints sit this race out.
+void startRace(RaceState& race, std::vector<std::unique_ptr<AlgorithmContext>>& algorithms) {
+    race.clock.start(race.rate);
+    for (auto& entry : algorithms) {
+        entry->inRace = entry->keyType == Utils::KeyType::Int32 && entry->getAlgorithm().supportsStepping() &&
+            entry->getWorker().isIdle() && !entry->timeline.isRecording() && !entry->timeline.isReady();
+        if (!entry->inRace) {
+            continue;
+        }
+        auto& context = static_cast<KeyedAlgorithmContext<int>&>(*entry);
+        context.visualizationData.shareValues(race.input);
+        context.visualizationData.origin = race.inputOrigin;
+        context.arraySize = context.visualizationData.size();
         context.sortingStats.reset();
         context.algorithm->reset();
+        context.worker.race(race.clock, race.costModel);
+    }
+    race.running = true;
+}
+
+// Function to render the race setup, its controls and the ranking of the windows in it
+void renderRace(RaceState& race, std::vector<std::unique_ptr<AlgorithmContext>>& algorithms) {
+    ImGui::TextUnformatted("Steppable int windows sort one shared input against a common virtual clock.");
+
+    bool anyRunning = false;
+    for (const auto& context : algorithms) {
+        anyRunning = anyRunning || (context->inRace && !context->getWorker().isIdle());
+    }
+    if (race.running && !anyRunning && !race.clock.isPaused()) {
+        // Everyone finished or was stopped from their own window
+        race.clock.pause();
+        race.running = false;
     }
 
-    if (!context.sortingStats.isSorting && context.sortingThread.joinable()) {
-        context.sortingThread.join();
+    if (!race.running) {
+        ImGui::SliderInt("Race Size", &race.size, 10, 1000000, "%d", ImGuiSliderFlags_Logarithmic);
+        ImGui::Combo("Input", &race.distribution, [](void*, int index) {
+            return Utils::ArrayGenerator::getDistributionName(static_cast<Utils::Distribution>(index));
+        }, nullptr, static_cast<int>(Utils::Distribution::Count));
+        ImGui::InputScalar("Race Seed", ImGuiDataType_U64, &race.seed);
+        ImGui::InputDouble("Comparison Cost", &race.costModel.comparison, 0.5, 1.0, "%.2f");
+        ImGui::InputDouble("Swap Cost", &race.costModel.swap, 0.5, 1.0, "%.2f");
+        ImGui::InputDouble("Write Cost", &race.costModel.write, 0.5, 1.0, "%.2f");
+    }
+    if (ImGui::SliderFloat("Clock Rate (units/s)", &race.rate, 10.0f, 10000000.0f, "%.0f", ImGuiSliderFlags_Logarithmic) && race.running) {
+        race.clock.setRate(race.rate);
     }
 
-    // Handle continuous sorting (non-stepping mode)
-    if (context.sortingStats.isSorting && !context.sortingStats.steppingMode && 
-        !context.sortingThread.joinable()) {
-        // If we have a current step, continue from where we left off rather than starting a new run
-        if (context.sortingStats.currentStep > 0) {
-            context.sortingThread = std::thread([&context]() {
-                // Continue sorting from current state
-                while (context.sortingStats.isSorting && !context.sortingStats.sortingComplete) {
-                    context.algorithm->step(context.visualizationData, context.sortingStats);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(context.sortingStats.speedFactor));
+    if (!race.running) {
+        if (ImGui::Button("Start Race", ImVec2(200, 30))) {
+            Visualization::VisualizationData input(race.size);
+            Utils::GeneratorOptions options;
+            options.seed = race.seed;
+            Utils::ArrayGenerator::generateArray(input, static_cast<Utils::Distribution>(race.distribution), options);
+            race.inputOrigin = input.origin;
+            race.input = std::make_shared<const std::vector<int>>(std::move(input.getValues()));
+            startRace(race, algorithms);
+        }
+        if (race.input) {
+            ImGui::SameLine();
+            if (ImGui::Button("Rerun Same Input", ImVec2(200, 30))) {
+                startRace(race, algorithms);
+            }
+        }
+    }
+    else {
+        // Pausing the clock alone would leave the algorithms at full speed catching up later
+        bool paused = race.clock.isPaused();
+        if (ImGui::Button(paused ? "Resume Race" : "Pause Race", ImVec2(200, 30))) {
+            for (auto& context : algorithms) {
+                if (!context->inRace) {
+                    continue;
                 }
-                
-                context.visualizationData.resetHighlighting();
-                context.sortingStats.isSorting = false;
-            });
-        } else {
-            context.sortingThread = std::thread(&Algorithms::Algorithm::run, context.algorithm.get(),
-                std::ref(context.visualizationData), std::ref(context.sortingStats));
+                if (paused) {
+                    context->getWorker().resume();
+                }
+                else {
+                    context->getWorker().pause();
+                }
+            }
+            if (paused) {
+                race.clock.resume();
+            }
+            else {
+                race.clock.pause();
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Stop Race", ImVec2(200, 30))) {
+            for (auto& context : algorithms) {
+                if (context->inRace) {
+                    context->getWorker().cancel();
+                }
+            }
+            race.clock.pause();
+            race.running = false;
         }
     }
+    ImGui::Text("Virtual Time: %.0f", race.clock.now());
 
-    // Handle step-by-step execution
-    if (context.sortingStats.isSorting && context.sortingStats.steppingMode) {
-        bool previousSteppingMode = context.sortingStats.steppingMode;
-        context.sortingStats.steppingMode = true;
-        context.algorithm->step(context.visualizationData, context.sortingStats);
-        context.sortingStats.steppingMode = previousSteppingMode;
-        
-        // Ensure we stop after one step in stepping mode
-        context.sortingStats.isSorting = false;
+    // Finished windows by the cost they needed, then the rest by how far they got
+    std::vector<AlgorithmContext*> ranking;
+    for (const auto& context : algorithms) {
+        if (context->inRace) {
+            ranking.push_back(context.get());
+        }
+    }
+    if (ranking.empty()) {
+        return;
+    }
+    const auto& costModel = race.costModel;
+    std::stable_sort(ranking.begin(), ranking.end(), [&costModel](AlgorithmContext* a, AlgorithmContext* b) {
+        const auto& statsA = a->getSnapshots().getStats();
+        const auto& statsB = b->getSnapshots().getStats();
+        if (statsA.sortingComplete != statsB.sortingComplete) {
+            return statsA.sortingComplete;
+        }
+        double costA = costModel.getCost(statsA);
+        double costB = costModel.getCost(statsB);
+        return statsA.sortingComplete ? costA < costB : costA > costB;
+    });
+
+    if (ImGui::BeginTable("Ranking", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("#");
+        ImGui::TableSetupColumn("Algorithm");
+        ImGui::TableSetupColumn("Status");
+        ImGui::TableSetupColumn("Comparisons");
+        ImGui::TableSetupColumn("Swaps");
+        ImGui::TableSetupColumn("Writes");
+        ImGui::TableSetupColumn("Cost");
+        ImGui::TableHeadersRow();
+        for (size_t rank = 0; rank < ranking.size(); rank++) {
+            const auto& stats = ranking[rank]->getSnapshots().getStats();
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", rank + 1);
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(ranking[rank]->name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(stats.sortingComplete ? "Finished" : (stats.isSorting ? "Racing" : "Stopped"));
+            ImGui::TableNextColumn();
+            ImGui::Text("%lld", stats.comparisons);
+            ImGui::TableNextColumn();
+            ImGui::Text("%lld", stats.swaps - stats.writes);
+            ImGui::TableNextColumn();
+            ImGui::Text("%lld", stats.writes);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", costModel.getCost(stats));
+        }
+        ImGui::EndTable();
+    }
+}
+
+// Function to handle the recorded timeline of a run; the undo log it replays holds ints
+// Returns true while the timeline replaces the live view
+bool handleTimeline(KeyedAlgorithmContext<int>& context) {
+    // A timeline can only be recorded from a fresh array while nothing is running
+    bool canRecord = context.algorithm->supportsRecording() && context.worker.isIdle() &&
+        !context.sortingStats.isSorting && context.sortingStats.currentStep == 0;
+
+    if (context.renderer.renderTimelineControls(context.timeline, canRecord)) {
+        context.timeline.startRecording(*context.algorithm, context.visualizationData);
+    }
+
+    if (context.timeline.isRecording()) {
+        return true;
+    }
+
+    if (context.timeline.isReady()) {
+        context.timeline.update(ImGui::GetIO().DeltaTime);
+        context.renderer.renderStatistics(context.timeline.getViewStats(), context.visualizationData.size());
+        context.renderer.renderArrayVisualization(context.timeline.getView(), context.timeline.getViewStats());
+        return true;
     }
 
-    context.renderer.renderStatistics(context.sortingStats, context.visualizationData.size());
-    context.renderer.renderArrayVisualization(context.visualizationData, context.sortingStats);
+    return false;
+}
+
+// Function to handle algorithm execution logic
+template <typename Key>
+void handleAlgorithmExecution(KeyedAlgorithmContext<Key>& context) {
+    constexpr bool isInt = std::is_same_v<Key, int>;
+    // The algorithm belongs to the timeline while it is recorded or shown
+    if constexpr (isInt) {
+        if (context.timeline.isRecording() || context.timeline.isReady()) {
+            handleTimeline(context);
+            return;
+        }
+    }
+
+    // Render controls and check if we need to generate a new array.
+    // The controls send commands to the worker and touch the data only while it is idle.
+    bool generateNewArray = context.renderer.renderControls(context.visualizationData, context.sortingStats, context.worker, context.arraySize,
+        context.distribution, context.generatorOptions, context.isStepsEnable);
+
+    if (generateNewArray) {
+        Utils::ArrayGenerator::generateArray(context.visualizationData, context.distribution, context.generatorOptions);
+        context.sortingStats.reset();
+        context.algorithm->reset();
+    }
+
+    if constexpr (isInt) {
+        if (handleTimeline(context)) {
+            return;
+        }
+    }
+
+    // While the worker is idle this thread is the only writer, so it publishes its own changes
+    if (context.worker.isIdle()) {
+        context.snapshots.publish(context.sortingStats, context.algorithm->getPhaseName());
+    }
+    context.snapshots.update();
+
+    const auto& view = context.snapshots.getView();
+    context.renderer.renderStatistics(context.snapshots.getStats(), view.size());
+    if (const char* phase = context.snapshots.getPhaseName()) {
+        ImGui::Text("Phase: %s", phase);
+    }
+    context.renderer.renderArrayVisualization(view, context.snapshots.getStats());
+}
+
+template <typename Key>
+void KeyedAlgorithmContext<Key>::render() {
+    handleAlgorithmExecution(*this);
 }
 
 int main()
@@ -139,23 +450,32 @@ int main()
 
 	ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 
-    // Create algorithm contexts
-    std::vector<AlgorithmContext> algorithms;
-    
-    // Add BubbleSort
-    algorithms.emplace_back("Bubble Sort", 100, std::make_unique<Algorithms::BubbleSort>(), true);
-    
-    // Add InsertionSort
-    algorithms.emplace_back("Insertion Sort", 100, std::make_unique<Algorithms::InsertionSort>(), true);
-
-    // Add MergeSort
-    algorithms.emplace_back("Merge Sort", 100, std::make_unique<Algorithms::MergeSort>(), false);
-
-    // Add QuickSort
-    algorithms.emplace_back("Quick Sort", 100, std::make_unique<Algorithms::QuickSort>(), true);
-
-    // Add BucketSort
-    algorithms.emplace_back("Bucket Sort", 100, std::make_unique<Algorithms::BucketSort>(), true);
+    // Create algorithm contexts; they stay in place because their workers and snapshot buffers refer to them.
+    // One window per algorithm opens at startup, more can be opened from the scheduler window.
+    // The race is declared first: the contexts' workers may read its clock until they are destroyed
+    RaceState race;
+    std::vector<std::unique_ptr<AlgorithmContext>> algorithms;
+    const auto entries = createAlgorithmEntries();
+    std::vector<int> openCounts(entries.size(), 0);
+    auto openAlgorithm = [&](size_t index, Utils::KeyType keyType) {
+        const AlgorithmEntry& entry = entries[index];
+        std::string name = entry.name;
+        if (!entry.anyKey) {
+            keyType = Utils::KeyType::Int32;
+        }
+        if (keyType != Utils::KeyType::Int32) {
+            name += std::string(" [") + Utils::getKeyTypeName(keyType) + "]";
+        }
+        if (++openCounts[index] > 1) {
+            name += " #" + std::to_string(openCounts[index]);
+        }
+        algorithms.push_back(entry.open(name, keyType));
+    };
+    for (size_t index = 0; index < entries.size(); index++) {
+        openAlgorithm(index, Utils::KeyType::Int32);
+    }
+    int selectedEntry = 0;
+    int selectedKeyType = static_cast<int>(Utils::KeyType::Int32);
 
 	// Main loop
 	while (!glfwWindowShouldClose(window))
@@ -167,17 +487,34 @@ int main()
 		ImGui_ImplGlfw_NewFrame();
 		ImGui::NewFrame();
 
+        // Shared worker pool: CPU budget and more windows
+        ImGui::Begin("Scheduler", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+        renderScheduler(entries, selectedEntry, selectedKeyType, algorithms.size());
+        if (ImGui::Button("Open Window", ImVec2(200, 30))) {
+            openAlgorithm(static_cast<size_t>(selectedEntry), static_cast<Utils::KeyType>(selectedKeyType));
+        }
+        ImGui::End();
+
+        // All steppable windows on one input and one clock
+        ImGui::Begin("Race", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+        renderRace(race, algorithms);
+        ImGui::End();
+
         // Process each algorithm
         for (auto& context : algorithms) {
             // Create a window for this algorithm
-            ImGui::Begin(context.name.c_str(), nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+            ImGui::Begin(context->name.c_str(), &context->isOpen, ImGuiWindowFlags_AlwaysAutoResize);
             
             // Handle algorithm execution
-            handleAlgorithmExecution(context);
+            context->render();
             
             ImGui::End();
         }
 
+        // Closed windows stop their worker as they are destroyed
+        algorithms.erase(std::remove_if(algorithms.begin(), algorithms.end(),
+            [](const std::unique_ptr<AlgorithmContext>& context) { return !context->isOpen; }), algorithms.end());
+
 		// Rendering
 		ImGui::Render();
 		int display_w, display_h;
@@ -192,15 +529,8 @@ int main()
 		glfwSwapBuffers(window);
 	}
 	
-    // Clean up all algorithm threads
-    for (auto& context : algorithms) {
-        if (context.sortingStats.isSorting) {
-            context.sortingStats.isSorting = false;
-            if (context.sortingThread.joinable()) {
-                context.sortingThread.join();
-            }
-        }
-    }
+    // Stop all algorithms; each worker interrupts its run and leaves the scheduler as it is destroyed
+    algorithms.clear();
 
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplGlfw_Shutdown();
@@ -1,19 +1,278 @@
 #include "ArrayGenerator.h"
+#include "Random.h"
+#include "Scheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
 #include <random>
+#include <type_traits>
+#include <vector>
 
 namespace Utils {
 
-    void ArrayGenerator::generateRandomArray(Visualization::VisualizationData& data, int min, int max) {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> distrib(min, max);
+    namespace {
+        // Elements per chunk; fixed so the chunk boundaries, and with them the output, do not depend on the thread count
+        constexpr size_t CHUNK_SIZE = size_t(1) << 16;
+        // Stream of the generator for work done once over the whole array, apart from the chunks' streams
+        constexpr uint64_t SERIAL_STREAM = ~uint64_t(0);
+        // Mixed into the seed for the random parts of keys other than int, apart from the ints' streams
+        constexpr uint64_t KEY_SEED = 0x6B657973ull << 32;
 
-        auto& array = data.getArray();
-        for (int i = 0; i < data.size(); i++) {
-            array[i].value = distrib(gen);
-            array[i].isComparing = false;
-            array[i].isSwapping = false;
+        // Runs fillRange(begin, end, generator) over every chunk, spread over idle threads of the shared pool
+        template <typename FillRange>
+        void fillChunks(size_t count, uint64_t seed, const FillRange& fillRange) {
+            size_t chunkCount = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            auto& scheduler = Algorithms::Scheduler::getDefault();
+            int members = static_cast<int>(std::min<size_t>(chunkCount, scheduler.getThreadCount()));
+
+            std::atomic<size_t> nextChunk{ 0 };
+            scheduler.runTeam(members, [&](int) {
+                for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++) {
+                    size_t begin = chunk * CHUNK_SIZE;
+                    Xoshiro256 generator(seed, chunk);
+                    fillRange(begin, std::min(begin + CHUNK_SIZE, count), generator);
+                }
+            });
+        }
+
+        // Maps position i of count evenly onto [min, max]; ascending in i. A multiply by a precomputed
+        // step instead of a 64-bit division per element, which would take several times longer.
+        struct Ramp {
+            int min;
+            double step;
+            uint64_t last;
+
+            Ramp(int min, uint64_t span, size_t count)
+                : min(min), step(static_cast<double>(span) / static_cast<double>(count)), last(span - 1) {}
+
+            int operator()(size_t i) const {
+                uint64_t offset = std::min(static_cast<uint64_t>(static_cast<double>(i) * step), last);
+                return static_cast<int>(min + static_cast<int64_t>(offset));
+            }
+        };
+
+        // Zipf ranks in [1, n] by rejection-inversion (Hormann and Derflinger), O(1) per sample for any n
+        class ZipfSampler {
+        public:
+            ZipfSampler(double n, double exponent)
+                : n(n), exponent(exponent),
+                  integralX1(integral(1.5) - 1.0),
+                  integralN(integral(n + 0.5)),
+                  threshold(2.0 - integralInverse(integral(2.5) - density(2.0))) {}
+
+            uint64_t sample(Xoshiro256& generator) const {
+                while (true) {
+                    double u = integralN + generator.nextDouble() * (integralX1 - integralN);
+                    double x = integralInverse(u);
+                    double k = std::clamp(std::floor(x + 0.5), 1.0, n);
+                    if (k - x <= threshold || u >= integral(k + 0.5) - density(k)) {
+                        return static_cast<uint64_t>(k);
+                    }
+                }
+            }
+
+        private:
+            double n;
+            double exponent;
+            double integralX1;
+            double integralN;
+            double threshold;
+
+            double density(double x) const {
+                return std::exp(-exponent * std::log(x));
+            }
+
+            double integral(double x) const {
+                double logX = std::log(x);
+                return expm1OverX((1.0 - exponent) * logX) * logX;
+            }
+
+            double integralInverse(double x) const {
+                double t = std::max(x * (1.0 - exponent), -1.0);
+                return std::exp(log1pOverX(t) * x);
+            }
+
+            // log1p(x) / x and expm1(x) / x, continued smoothly through x = 0 where exponent is 1
+            static double log1pOverX(double x) {
+                return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+            }
+
+            static double expm1OverX(double x) {
+                return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x / 3.0 * (1.0 + 0.25 * x));
+            }
+        };
+
+        // Replays ParallelQuickSort's partition, median of (low, mid, high) then Hoare, on position
+        // labels and hands out ranks so every pivot is the second smallest of its range. The smallest
+        // sits at low and the pivot at mid; the scan swaps the pivot with the element at low + 1,
+        // and the partition splits off just those two, leaving the rest for the next round.
+        // Linear to build, quadratic to sort; the ranks need max - min + 1 >= count to stay distinct.
+        // Label is the narrowest index type that holds count, as the labels take as much memory as the array.
+        template <typename Label>
+        void fillMedian3Killer(int* values, size_t count, const Ramp& ramp) {
+            std::vector<Label> labels(count);
+            std::iota(labels.begin(), labels.end(), Label(0));
+
+            size_t rank = 0;
+            size_t low = 0;
+            size_t high = count - 1;
+            while (high - low + 1 > 3) {
+                size_t mid = low + (high - low) / 2;
+                values[labels[low]] = ramp(rank++);
+                values[labels[mid]] = ramp(rank++);
+                std::swap(labels[low + 1], labels[mid]);
+                low += 2;
+            }
+            for (size_t i = low; i <= high; i++) {
+                values[labels[i]] = ramp(rank++);
+            }
+        }
+    }
+
+    template <typename Key>
+    void ArrayGenerator::generateArray(Visualization::BasicVisualizationData<Key>& data, Distribution distribution, const GeneratorOptions& options) {
+        auto& array = data.getValues();
+        if constexpr (std::is_same_v<Key, int>) {
+            fill(array.data(), array.size(), distribution, options);
+        }
+        else {
+            std::vector<int> values(array.size());
+            fill(values.data(), values.size(), distribution, options);
+            fillChunks(values.size(), options.seed ^ KEY_SEED, [&](size_t begin, size_t end, Xoshiro256& generator) {
+                for (size_t i = begin; i < end; i++) {
+                    array[i] = KeyTraits<Key>::fromValue(values[i], i, generator.next());
+                }
+            });
+        }
+        data.origin = { options.seed, static_cast<int>(distribution) };
+        data.resetHighlighting();
+        data.markAllDirty();
+    }
+
+#define INSTANTIATE(Key) template void ArrayGenerator::generateArray(Visualization::BasicVisualizationData<Key>&, Distribution, const GeneratorOptions&);
+    FOR_EACH_KEY_TYPE(INSTANTIATE)
+#undef INSTANTIATE
+
+    void ArrayGenerator::fill(int* values, size_t count, Distribution distribution, const GeneratorOptions& options) {
+        if (count == 0) {
+            return;
+        }
+
+        int min = std::min(options.min, options.max);
+        uint64_t span = static_cast<uint64_t>(static_cast<int64_t>(std::max(options.min, options.max)) - min) + 1;
+        Ramp ramp{ min, span, count };
+        uint64_t seed = options.seed;
+
+        switch (distribution) {
+        case Distribution::Sorted:
+            fillChunks(count, seed, [&](size_t begin, size_t end, Xoshiro256&) {
+                for (size_t i = begin; i < end; i++) {
+                    values[i] = ramp(i);
+                }
+            });
+            break;
+        case Distribution::Reversed:
+            fillChunks(count, seed, [&](size_t begin, size_t end, Xoshiro256&) {
+                for (size_t i = begin; i < end; i++) {
+                    values[i] = ramp(count - 1 - i);
+                }
+            });
+            break;
+        case Distribution::NearlySorted: {
+            fillChunks(count, seed, [&](size_t begin, size_t end, Xoshiro256&) {
+                for (size_t i = begin; i < end; i++) {
+                    values[i] = ramp(i);
+                }
+            });
+            // Each swap may cross chunks, so they come after, from one generator
+            size_t swaps = options.swaps > 0 ? options.swaps : count / 100 + 1;
+            Xoshiro256 generator(seed, SERIAL_STREAM);
+            for (size_t k = 0; k < swaps && count > 1; k++) {
+                size_t a = generator.nextBelow(count);
+                size_t b = generator.nextBelow(count);
+                std::swap(values[a], values[b]);
+            }
+            break;
+        }
+        case Distribution::FewUnique: {
+            uint64_t unique = std::clamp<uint64_t>(static_cast<uint64_t>(std::max(options.uniqueValues, 1)), 1, span);
+            uint64_t step = span / unique;
+            fillChunks(count, seed, [&](size_t begin, size_t end, Xoshiro256& generator) {
+                for (size_t i = begin; i < end; i++) {
+                    values[i] = static_cast<int>(min + static_cast<int64_t>(generator.nextBelow(unique) * step));
+                }
+            });
+            break;
+        }
+        case Distribution::OrganPipe: {
+            Ramp half{ min, span, (count + 1) / 2 };
+            fillChunks(count, seed, [&](size_t begin, size_t end, Xoshiro256&) {
+                for (size_t i = begin; i < end; i++) {
+                    values[i] = half(std::min(i, count - 1 - i));
+                }
+            });
+            break;
+        }
+        case Distribution::Sawtooth: {
+            size_t period = (count + std::max(options.runs, 1) - 1) / std::max(options.runs, 1);
+            Ramp tooth{ min, span, period };
+            fillChunks(count, seed, [&](size_t begin, size_t end, Xoshiro256&) {
+                size_t position = begin % period;
+                for (size_t i = begin; i < end; i++) {
+                    values[i] = tooth(position);
+                    if (++position == period) {
+                        position = 0;
+                    }
+                }
+            });
+            break;
+        }
+        case Distribution::Zipf: {
+            ZipfSampler sampler(static_cast<double>(span), std::max(options.zipfExponent, 1e-3));
+            fillChunks(count, seed, [&](size_t begin, size_t end, Xoshiro256& generator) {
+                for (size_t i = begin; i < end; i++) {
+                    values[i] = static_cast<int>(min + static_cast<int64_t>(sampler.sample(generator) - 1));
+                }
+            });
+            break;
+        }
+        case Distribution::Median3Killer:
+            if (count <= UINT32_MAX) {
+                fillMedian3Killer<uint32_t>(values, count, ramp);
+            }
+            else {
+                fillMedian3Killer<size_t>(values, count, ramp);
+            }
+            break;
+        default:
+            fillChunks(count, seed, [&](size_t begin, size_t end, Xoshiro256& generator) {
+                for (size_t i = begin; i < end; i++) {
+                    values[i] = static_cast<int>(min + static_cast<int64_t>(generator.nextBelow(span)));
+                }
+            });
+            break;
+        }
+    }
+
+    uint64_t ArrayGenerator::randomSeed() {
+        std::random_device device;
+        return (static_cast<uint64_t>(device()) << 32) ^ device();
+    }
+
+    const char* ArrayGenerator::getDistributionName(Distribution distribution) {
+        switch (distribution) {
+        case Distribution::Random: return "random";
+        case Distribution::Sorted: return "sorted";
+        case Distribution::Reversed: return "reversed";
+        case Distribution::NearlySorted: return "nearly-sorted";
+        case Distribution::FewUnique: return "few-unique";
+        case Distribution::OrganPipe: return "organ-pipe";
+        case Distribution::Sawtooth: return "sawtooth";
+        case Distribution::Zipf: return "zipf";
+        case Distribution::Median3Killer: return "median3-killer";
+        default: return "unknown";
         }
     }
 
-}
\ No newline at end of file
+}
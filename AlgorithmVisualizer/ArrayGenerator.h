@@ -1,10 +1,52 @@
 #pragma once
 #include "VisualizationData.h"
+#include <cstddef>
+#include <cstdint>
 
 namespace Utils {
+    // Input orderings used to exercise best and worst cases
+    enum class Distribution {
+        Random,
+        Sorted,
+        Reversed,
+        NearlySorted,
+        FewUnique,
+        OrganPipe,     // Ascending to the middle, then descending
+        Sawtooth,      // Several ascending runs one after another
+        Zipf,          // Skewed like real-world keys: value k appears about 1 / k^s as often as the smallest
+        Median3Killer, // Makes a median-of-three quicksort split off two elements per partition
+        Count
+    };
+
+    struct GeneratorOptions {
+        // The same seed and options give the same array, however many threads generate it
+        uint64_t seed = 1;
+        int min = 5;
+        int max = 200;
+        // NearlySorted: random swaps applied to the sorted array; 0 means 1% of the elements
+        size_t swaps = 0;
+        // FewUnique: number of distinct values
+        int uniqueValues = 8;
+        // Sawtooth: number of ascending runs
+        int runs = 8;
+        // Zipf: exponent s > 0; larger is more skewed
+        double zipfExponent = 1.0;
+    };
+
     class ArrayGenerator {
     public:
-        static void generateRandomArray(Visualization::VisualizationData& data, int min = 5, int max = 200);
+        // Keys other than int are made from the ints the distribution gives, keeping their order, so every
+        // key type sees the same input; the keys' own random parts come from the same seed
+        template <typename Key>
+        static void generateArray(Visualization::BasicVisualizationData<Key>& data, Distribution distribution, const GeneratorOptions& options = {});
+
+        // Fills count values directly, e.g. a buffer too large for VisualizationData. Generation runs
+        // in fixed-size chunks on the shared scheduler, each with its own seeded generator.
+        static void fill(int* values, size_t count, Distribution distribution, const GeneratorOptions& options);
+
+        // A fresh seed from the system's entropy source
+        static uint64_t randomSeed();
+
+        static const char* getDistributionName(Distribution distribution);
     };
 }
-
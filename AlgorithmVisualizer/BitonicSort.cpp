@@ -0,0 +1,237 @@
+#include "BitonicSort.h"
+#include "SortingNetwork.h"
+#include <cstdio>
+#include <utility>
+
+namespace Algorithms {
+
+    template <typename Key, typename Compare>
+    BasicBitonicSort<Key, Compare>::BasicBitonicSort() : BasicAlgorithm<Key, Compare>("Bitonic Network") {
+        reset();
+    }
+
+    template <typename Key, typename Compare>
+    void BasicBitonicSort<Key, Compare>::reset() {
+        blockSize = 2;
+        distance = 1;
+        i = 0;
+        flip = true;
+        started = false;
+    }
+
+    template <typename Key, typename Compare>
+    const char* BasicBitonicSort<Key, Compare>::getPhaseName() const {
+        if (flip) {
+            std::snprintf(phaseName, sizeof(phaseName), "Merge blocks of %d: flip", blockSize);
+        }
+        else {
+            std::snprintf(phaseName, sizeof(phaseName), "Merge blocks of %d: distance %d", blockSize, distance);
+        }
+        return phaseName;
+    }
+
+    template <typename Key, typename Compare>
+    bool BasicBitonicSort<Key, Compare>::isComplete(const SortingStats& stats) const {
+        return stats.sortingComplete;
+    }
+
+    template <typename Key, typename Compare>
+    void BasicBitonicSort<Key, Compare>::step(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        if (stats.sortingComplete || !stats.isSorting) {
+            return;
+        }
+
+        auto& array = data.getValues();
+        int n = data.size();
+
+        if (stats.stateRestored) {
+            i = stats.lastRestoredI;
+            distance = stats.lastRestoredJ;
+            flip = stats.lastRestoredSwapped;
+            blockSize = stats.lastRestoredK;
+            stats.stateRestored = false;
+        }
+        else {
+            data.resetHighlighting();
+        }
+
+        stats.saveState(i, distance, flip, blockSize);
+
+        if (!started) {
+            started = true;
+            i = 0;
+
+            // Nothing to record: sort whole SIMD-sized blocks at once and start merging above them
+            if (!stats.recordHistory && !stats.trace && n > SortingNetwork::MAX_SIZE) {
+                for (int first = 0; first < n; first += SortingNetwork::MAX_SIZE) {
+                    int count = n - first < SortingNetwork::MAX_SIZE ? n - first : SortingNetwork::MAX_SIZE;
+                    stats.comparisons += SortingNetwork::sort(array.data() + first, count, this->compare);
+                }
+                data.markAllDirty();
+                blockSize = SortingNetwork::MAX_SIZE * 2;
+                distance = blockSize / 2;
+                flip = true;
+                advance(n);
+                stats.currentStep++;
+                return;
+            }
+
+            advance(n);
+        }
+
+        if (blockSize / 2 >= n) {
+            stats.sortingComplete = true;
+            stats.isSorting = false;
+            data.markedLow = -1;
+            data.markedHigh = -1;
+            data.resetHighlighting();
+            return;
+        }
+
+        int partner = partnerOf(i);
+        if (i % blockSize == 0 || (!flip && i % (2 * distance) == 0)) {
+            int low = i - i % blockSize;
+            data.markedLow = low;
+            data.markedHigh = low + blockSize - 1 < n ? low + blockSize - 1 : n - 1;
+            stats.recordRange(data.markedLow, data.markedHigh);
+        }
+
+        data.setComparing(i);
+        data.setComparing(partner);
+        stats.recordCompare(i, partner);
+        stats.comparisons++;
+        stats.currentStep++;
+
+        if (this->compare(array[partner], array[i])) {
+            data.setSwapping(i);
+            data.setSwapping(partner);
+            data.swap(i, partner);
+            stats.recordSwap(i, partner);
+            stats.swaps++;
+        }
+
+        i++;
+        advance(n);
+
+        if (stats.steppingMode) {
+            stats.isSorting = false;
+        }
+    }
+
+    template <typename Key, typename Compare>
+    void BasicBitonicSort<Key, Compare>::advance(int n) {
+        // Skip upper indices and comparators whose partner lies in the virtual padding
+        while (blockSize / 2 < n) {
+            while (i < n) {
+                int half = flip ? blockSize / 2 : distance;
+                if ((i & half) == 0 && partnerOf(i) < n) {
+                    return;
+                }
+                i++;
+            }
+            nextLayer();
+        }
+    }
+
+    template <typename Key, typename Compare>
+    void BasicBitonicSort<Key, Compare>::nextLayer() {
+        i = 0;
+        if (flip) {
+            flip = false;
+            distance = blockSize / 4;
+        }
+        else {
+            distance /= 2;
+        }
+
+        if (distance == 0) {
+            blockSize *= 2;
+            distance = blockSize / 2;
+            flip = true;
+        }
+    }
+
+    template <typename Key, typename Compare>
+    void BasicBitonicSort<Key, Compare>::runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation) {
+        this->runKernel(data, stats, instrumentation, [&](auto policy) {
+            sortAll<decltype(policy)>(data, stats);
+        });
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicBitonicSort<Key, Compare>::sortAll(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        auto& array = data.getValues();
+        int n = array.size();
+        Probe<Policy, Key> probe(data);
+
+        auto compareExchange = [&](int low, int high) {
+            probe.compare(low, high);
+            if (this->compare(array[high], array[low])) {
+                std::swap(array[low], array[high]);
+                probe.swap(low, high);
+            }
+            probe.step();
+        };
+
+        int firstBlockSize = 2;
+        if (n > SortingNetwork::MAX_SIZE) {
+            for (int first = 0; first < n; first += SortingNetwork::MAX_SIZE) {
+                int count = n - first < SortingNetwork::MAX_SIZE ? n - first : SortingNetwork::MAX_SIZE;
+                probe.comparisons += SortingNetwork::sort(array.data() + first, count, this->compare);
+            }
+            probe.step();
+            firstBlockSize = SortingNetwork::MAX_SIZE * 2;
+        }
+
+        // A stop request is honoured between merges
+        for (int size = firstBlockSize; size / 2 < n && stats.isSorting; size *= 2) {
+            // The flip layer compares i with the mirrored index of its block
+            for (int low = 0; low < n; low++) {
+                int high = low ^ (size - 1);
+                if ((low & (size / 2)) == 0 && high < n) {
+                    compareExchange(low, high);
+                }
+            }
+            for (int gap = size / 4; gap > 0; gap /= 2) {
+                for (int low = 0; low < n; low++) {
+                    if ((low & gap) == 0 && low + gap < n) {
+                        compareExchange(low, low + gap);
+                    }
+                }
+            }
+        }
+
+        probe.flush(stats);
+    }
+
+    template <typename Key, typename Compare>
+    void BasicBitonicSort<Key, Compare>::run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        if (stats.currentStep == 0) {
+            reset();
+            stats.reset();
+        }
+        stats.isSorting = true;
+
+        if (stats.steppingMode) {
+            step(data, stats);
+            return;
+        }
+
+        while (stats.isSorting && !stats.sortingComplete) {
+            step(data, stats);
+            this->pace(stats);
+        }
+
+        data.resetHighlighting();
+        if (stats.isSorting) {
+            stats.sortingComplete = true;
+            stats.isSorting = false;
+        }
+    }
+
+#define INSTANTIATE(Key) template class BasicBitonicSort<Key>;
+    FOR_EACH_KEY_TYPE(INSTANTIATE)
+#undef INSTANTIATE
+
+}
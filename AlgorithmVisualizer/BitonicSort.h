@@ -0,0 +1,51 @@
+#pragma once
+#include "Algorithm.h"
+
+namespace Algorithms {
+
+    // Bitonic sorting network over the whole array, one compare-exchange per step.
+    // Every merge starts with a flip layer (i against the mirrored index of its block)
+    // followed by half-cleaners, so all comparators point the same way and an array of
+    // any length works as if it were padded with +infinity. Runs that record nothing
+    // sort the first blocks of SortingNetwork::MAX_SIZE values with the SIMD kernel.
+    template <typename Key, typename Compare = typename Utils::KeyTraits<Key>::Compare>
+    class BasicBitonicSort : public BasicAlgorithm<Key, Compare> {
+    public:
+        BasicBitonicSort();
+
+        void step(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) override;
+
+        void run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) override;
+
+        void runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation) override;
+
+        bool supportsInstrumentation() const override { return true; }
+
+        bool isComplete(const SortingStats& stats) const override;
+
+        void reset() override;
+
+        const char* getPhaseName() const override;
+
+    private:
+        // Size of the blocks being merged, comparator distance, and the current lower index
+        int blockSize = 2;
+        int distance = 1;
+        int i = 0;
+        // Whether the current layer is the flip layer of the merge
+        bool flip = true;
+        bool started = false;
+        mutable char phaseName[64]{};
+
+        int partnerOf(int index) const { return flip ? (index ^ (blockSize - 1)) : (index + distance); }
+        void advance(int n);
+        void nextLayer();
+
+        // The layers of step() in plain loops, after the same SIMD blocks; the policy decides what they report
+        template <typename Policy>
+        void sortAll(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
+    };
+
+    using BitonicSort = BasicBitonicSort<int>;
+
+}
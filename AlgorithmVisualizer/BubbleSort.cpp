@@ -1,19 +1,20 @@
 #include "BubbleSort.h"
-#include <thread>
-#include <chrono>
+#include <utility>
 
 namespace Algorithms {
 
-    BubbleSort::BubbleSort() : Algorithm("Bubble Sort") {
+    template <typename Key, typename Compare>
+    BasicBubbleSort<Key, Compare>::BasicBubbleSort() : BasicAlgorithm<Key, Compare>("Bubble Sort") {
         reset();
     }
 
-    void BubbleSort::step(Visualization::VisualizationData& data, SortingStats& stats) {
+    template <typename Key, typename Compare>
+    void BasicBubbleSort<Key, Compare>::step(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
         if (stats.sortingComplete || !stats.isSorting) {
             return;
         }
 
-        auto& array = data.getArray();
+        auto& array = data.getValues();
         int n = array.size();
 
         // Check if we need to restore algorithm state after stepping backward
@@ -23,29 +24,31 @@ namespace Algorithms {
             swapped = stats.lastRestoredSwapped;
             stats.stateRestored = false;
             
-            // Don't reset highlighting or save state when restoring
+            // Don't reset highlighting when restoring
             // The highlighting is already set in Renderer.cpp when stepping backward
         } else {
             // Only reset highlighting if we're not restoring a state
             data.resetHighlighting();
-            
-            // Save current state before making changes (for step backward functionality)
-            stats.saveState(data, i, j, swapped);
         }
 
+        // Start a new undo record before making changes (for step backward functionality)
+        stats.saveState(i, j, swapped);
+
         if (i < n - 1) {
             if (j < n - i - 1) {
-                array[j].isComparing = true;
-                array[j + 1].isComparing = true;
+                data.setComparing(j);
+                data.setComparing(j + 1);
+                stats.recordCompare(j, j + 1);
                 stats.comparisons++;
                 stats.currentStep++;
 
-                if (array[j].value > array[j + 1].value) {
-                    array[j].isSwapping = true;
-                    array[j + 1].isSwapping = true;
+                if (this->compare(array[j + 1], array[j])) {
+                    data.setSwapping(j);
+                    data.setSwapping(j + 1);
                     stats.swaps++;
 
-                    std::swap(array[j], array[j + 1]);
+                    data.swap(j, j + 1);
+                    stats.recordSwap(j, j + 1);
                     swapped = true;
                 }
 
@@ -73,7 +76,8 @@ namespace Algorithms {
         }
     }
 
-    void BubbleSort::run(Visualization::VisualizationData& data, SortingStats& stats) {
+    template <typename Key, typename Compare>
+    void BasicBubbleSort<Key, Compare>::run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
         // Only reset if we're starting a new sort
         if (stats.currentStep == 0) {
             reset();
@@ -90,7 +94,7 @@ namespace Algorithms {
         // Normal continuous execution
         while (stats.isSorting && !stats.sortingComplete) {
             step(data, stats);
-            std::this_thread::sleep_for(std::chrono::milliseconds(stats.speedFactor));
+            this->pace(stats);
         }
 
         data.resetHighlighting();
@@ -100,13 +104,53 @@ namespace Algorithms {
         }
     }
 
-    bool BubbleSort::isComplete(const SortingStats& stats) const {
+    template <typename Key, typename Compare>
+    void BasicBubbleSort<Key, Compare>::runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation) {
+        this->runKernel(data, stats, instrumentation, [&](auto policy) {
+            sortAll<decltype(policy)>(data, stats);
+        });
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicBubbleSort<Key, Compare>::sortAll(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        auto& array = data.getValues();
+        int n = array.size();
+        Probe<Policy, Key> probe(data);
+
+        // A stop request is honoured between passes
+        for (int pass = 0; pass < n - 1 && stats.isSorting; pass++) {
+            bool swappedAny = false;
+            for (int k = 0; k < n - pass - 1; k++) {
+                probe.compare(k, k + 1);
+                if (this->compare(array[k + 1], array[k])) {
+                    std::swap(array[k], array[k + 1]);
+                    probe.swap(k, k + 1);
+                    swappedAny = true;
+                }
+                probe.step();
+            }
+            if (!swappedAny) {
+                break;
+            }
+        }
+
+        probe.flush(stats);
+    }
+
+    template <typename Key, typename Compare>
+    bool BasicBubbleSort<Key, Compare>::isComplete(const SortingStats& stats) const {
         return stats.sortingComplete;
     }
 
-    void BubbleSort::reset() {
+    template <typename Key, typename Compare>
+    void BasicBubbleSort<Key, Compare>::reset() {
         i = 0;
         j = 0;
         swapped = false;
     }
+
+#define INSTANTIATE(Key) template class BasicBubbleSort<Key>;
+    FOR_EACH_KEY_TYPE(INSTANTIATE)
+#undef INSTANTIATE
 }
\ No newline at end of file
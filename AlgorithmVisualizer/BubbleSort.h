@@ -3,13 +3,18 @@
 
 namespace Algorithms {
 
-    class BubbleSort : public Algorithm {
+    template <typename Key, typename Compare = typename Utils::KeyTraits<Key>::Compare>
+    class BasicBubbleSort : public BasicAlgorithm<Key, Compare> {
     public:
-        BubbleSort();
+        BasicBubbleSort();
 
-        void step(Visualization::VisualizationData& data, SortingStats& stats) override;
+        void step(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) override;
 
-        void run(Visualization::VisualizationData& data, SortingStats& stats) override;
+        void run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) override;
+
+        void runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation) override;
+
+        bool supportsInstrumentation() const override { return true; }
 
         bool isComplete(const SortingStats& stats) const override;
 
@@ -19,6 +24,12 @@ namespace Algorithms {
         int i = 0;
         int j = 0;
         bool swapped = false;
+
+        // The passes of step() in plain loops; the policy decides what they report
+        template <typename Policy>
+        void sortAll(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
     };
 
-}
\ No newline at end of file
+    using BubbleSort = BasicBubbleSort<int>;
+
+}
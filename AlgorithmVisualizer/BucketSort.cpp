@@ -1,12 +1,14 @@
 #include "BucketSort.h"
-#include <thread>
-#include <chrono>
+#include "SortingNetwork.h"
+#include "Scheduler.h"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <numeric>
 
 namespace Algorithms {
 
-    BucketSort::BucketSort() : Algorithm("Bucket Sort") {
+    BucketSort::BucketSort(Mode mode) : Algorithm(mode == Mode::PrefixSum ? "Bucket Sort (Prefix Sum)" : "Bucket Sort"), mode(mode) {
         reset();
     }
 
@@ -18,6 +20,26 @@ namespace Algorithms {
         outputIndex = 0;
         distributionPhase = true;
         initialized = false;
+        minValue = 0;
+        maxValue = 0;
+
+        phase = Phase::Count;
+        bucketCount = 0;
+        bucketStarts.clear();
+        bucketCursors.clear();
+    }
+
+    const char* BucketSort::getPhaseName() const {
+        if (mode == Mode::Classic) {
+            return nullptr;
+        }
+
+        switch (phase) {
+        case Phase::Scatter: return "Scatter into buckets";
+        case Phase::SortBuckets: return "Sort buckets";
+        case Phase::Collect: return "Collect";
+        default: return "Count bucket sizes";
+        }
     }
 
     bool BucketSort::isComplete(const SortingStats& stats) const {
@@ -25,14 +47,14 @@ namespace Algorithms {
     }
 
     void BucketSort::initializeBuckets(const Visualization::VisualizationData& data) {
-        const auto& array = data.getArray();
+        const auto& array = data.getValues();
         size_t n = array.size();
         
-        int minVal = array[0].value;
-        int maxVal = array[0].value;
+        minValue = array[0];
+        maxValue = array[0];
         for (size_t i = 1; i < n; i++) {
-            if (array[i].value < minVal) minVal = array[i].value;
-            if (array[i].value > maxVal) maxVal = array[i].value;
+            if (array[i] < minValue) minValue = array[i];
+            if (array[i] > maxValue) maxValue = array[i];
         }
         
         // Create an appropriate number of buckets based on array size
@@ -54,8 +76,13 @@ namespace Algorithms {
             return;
         }
 
-        auto& array = data.getArray();
-        size_t n = array.size();
+        if (mode == Mode::PrefixSum) {
+            stepPrefixSum(data, stats);
+            if (stats.steppingMode) {
+                stats.isSorting = false;
+            }
+            return;
+        }
 
         if (stats.stateRestored) {
             currentBucket = stats.lastRestoredI;
@@ -63,10 +90,11 @@ namespace Algorithms {
             stats.stateRestored = false;
         } else {
             data.resetHighlighting();
-            
-            stats.saveState(data, currentBucket, currentElement, false);
         }
 
+        stats.saveState(currentBucket, currentElement, false);
+        stats.perf.setPhase(distributionPhase ? "Distribute into buckets" : "Collect");
+
         // Initialize buckets if not already done
         if (!initialized) {
             initializeBuckets(data);
@@ -89,33 +117,31 @@ namespace Algorithms {
     }
 
     void BucketSort::stepDistribution(Visualization::VisualizationData& data, SortingStats& stats) {
-        auto& array = data.getArray();
+        auto& array = data.getValues();
         size_t n = array.size();
         
-        static int minVal = 0;
-        static int maxVal = 0;
-        
         // Find min and max on first element only
         if (currentElement == 0) {
-            minVal = array[0].value;
-            maxVal = array[0].value;
+            minValue = array[0];
+            maxValue = array[0];
             for (size_t i = 1; i < n; i++) {
                 stats.comparisons += 2;
-                if (array[i].value < minVal) minVal = array[i].value;
-                if (array[i].value > maxVal) maxVal = array[i].value;
+                if (array[i] < minValue) minValue = array[i];
+                if (array[i] > maxValue) maxValue = array[i];
             }
         }
         
         if (currentElement < n) {
-            array[currentElement].isComparing = true;
+            data.setComparing(static_cast<int>(currentElement));
+            stats.recordCompare(static_cast<int>(currentElement), static_cast<int>(currentElement));
             stats.currentStep++;
             
             // Calculate which bucket this element belongs to
-            int value = array[currentElement].value;
+            int value = array[currentElement];
             size_t bucketIndex = 0;
             
-            if (maxVal > minVal) {
-                double normalizedValue = static_cast<double>(value - minVal) / (maxVal - minVal);
+            if (maxValue > minValue) {
+                double normalizedValue = static_cast<double>(value - minValue) / (maxValue - minValue);
                 bucketIndex = static_cast<size_t>(normalizedValue * buckets.size());
                 if (bucketIndex >= buckets.size()) bucketIndex = buckets.size() - 1;
             }
@@ -125,8 +151,9 @@ namespace Algorithms {
             bucketSizes[bucketIndex]++;
             
             stats.swaps++;
+            stats.writes++;
             
-            array[currentElement].isSwapping = true;
+            data.setSwapping(static_cast<int>(currentElement));
             
             currentElement++;
         } else {
@@ -142,26 +169,33 @@ namespace Algorithms {
     }
 
     void BucketSort::stepCollection(Visualization::VisualizationData& data, SortingStats& stats) {
-        auto& array = data.getArray();
+        auto& array = data.getValues();
         
         if (currentBucket < buckets.size()) {
             if (currentElement < bucketSizes[currentBucket]) {
                 int value = buckets[currentBucket][currentElement];
+
+                // Mark the slots this bucket is about to fill
+                if (currentElement == 0) {
+                    stats.recordRange(static_cast<int>(outputIndex), static_cast<int>(outputIndex + bucketSizes[currentBucket] - 1));
+                }
                 
                 if (outputIndex > 0) {
-                    array[outputIndex-1].isSwapping = false;
+                    data.clearHighlight(static_cast<int>(outputIndex - 1));
                 }
                 
-                array[outputIndex].isComparing = true;
-                array[outputIndex].isSwapping = true;
+                data.setComparing(static_cast<int>(outputIndex));
+                data.setSwapping(static_cast<int>(outputIndex));
                 
-                int oldValue = array[outputIndex].value;
-                array[outputIndex].value = value;
+                int oldValue = array[outputIndex];
+                stats.recordWrite(static_cast<int>(outputIndex), oldValue, value);
+                data.set(static_cast<int>(outputIndex), value);
                 
                 stats.comparisons++;
                 
                 if (oldValue != value) {
                     stats.swaps++;
+                    stats.writes++;
                 }
                 
                 stats.currentStep++;
@@ -195,19 +229,224 @@ namespace Algorithms {
                 if (bucket[j] > key) {
                     bucket[j + 1] = bucket[j];
                     stats.swaps++;
+                    stats.writes++;
                     j--;
                 } else {
                     break;
                 }
             }
             
-            if (j + 1 != i) {
+            if (static_cast<size_t>(j + 1) != i) {
                 bucket[j + 1] = key;
                 stats.swaps++;
+                stats.writes++;
             }
         }
     }
 
+    size_t BucketSort::bucketOf(int value) const {
+        // Integer scaling of the value range onto the buckets; 64-bit so the product cannot overflow
+        long long range = static_cast<long long>(maxValue) - minValue + 1;
+        return static_cast<size_t>((static_cast<long long>(value) - minValue) * static_cast<long long>(bucketCount) / range);
+    }
+
+    void BucketSort::stepPrefixSum(Visualization::VisualizationData& data, SortingStats& stats) {
+        auto& array = data.getValues();
+        size_t n = array.size();
+
+        if (stats.stateRestored) {
+            currentElement = stats.lastRestoredI;
+            phase = static_cast<Phase>(stats.lastRestoredK);
+            stats.stateRestored = false;
+            rebuildPhase(data);
+        } else {
+            data.resetHighlighting();
+        }
+
+        stats.saveState(static_cast<int>(currentElement), 0, false, static_cast<int>(phase));
+        stats.perf.setPhase(getPhaseName());
+
+        switch (phase) {
+        case Phase::Count:
+            if (currentElement == 0) {
+                if (n == 0) {
+                    stats.sortingComplete = true;
+                    stats.isSorting = false;
+                    return;
+                }
+                initializeCounts(data, stats);
+            }
+
+            // Only the bucket sizes are counted, nothing moves yet
+            data.setComparing(static_cast<int>(currentElement));
+            stats.recordCompare(static_cast<int>(currentElement), static_cast<int>(currentElement));
+            bucketStarts[bucketOf(array[currentElement]) + 1]++;
+            stats.currentStep++;
+
+            if (++currentElement == n) {
+                computeOffsets();
+                phase = Phase::Scatter;
+                currentElement = 0;
+            }
+            break;
+
+        case Phase::Scatter: {
+            int value = array[currentElement];
+            contiguous[bucketCursors[bucketOf(value)]++] = value;
+
+            data.setSwapping(static_cast<int>(currentElement));
+            stats.recordCompare(static_cast<int>(currentElement), static_cast<int>(currentElement));
+            stats.swaps++;
+            stats.writes++;
+            stats.currentStep++;
+
+            if (++currentElement == n) {
+                phase = Phase::SortBuckets;
+                currentElement = 0;
+            }
+            break;
+        }
+
+        case Phase::SortBuckets:
+            sortBuckets(stats);
+            stats.currentStep++;
+            phase = Phase::Collect;
+            currentBucket = 0;
+            break;
+
+        case Phase::Collect:
+            if (currentElement < n) {
+                // Mark the slots of each bucket as collection reaches it
+                while (bucketStarts[currentBucket + 1] <= currentElement) {
+                    currentBucket++;
+                }
+                if (bucketStarts[currentBucket] == currentElement) {
+                    stats.recordRange(static_cast<int>(currentElement), static_cast<int>(bucketStarts[currentBucket + 1] - 1));
+                }
+
+                int oldValue = array[currentElement];
+                int value = contiguous[currentElement];
+                data.setComparing(static_cast<int>(currentElement));
+                data.setSwapping(static_cast<int>(currentElement));
+                stats.recordWrite(static_cast<int>(currentElement), oldValue, value);
+                data.set(static_cast<int>(currentElement), value);
+                if (oldValue != value) {
+                    stats.swaps++;
+                    stats.writes++;
+                }
+                stats.currentStep++;
+                currentElement++;
+            } else {
+                stats.sortingComplete = true;
+                stats.isSorting = false;
+                data.resetHighlighting();
+            }
+            break;
+        }
+    }
+
+    void BucketSort::initializeCounts(const Visualization::VisualizationData& data, SortingStats& stats) {
+        const auto& array = data.getValues();
+        size_t n = array.size();
+
+        auto bounds = std::minmax_element(array.begin(), array.end());
+        minValue = *bounds.first;
+        maxValue = *bounds.second;
+        stats.comparisons += 2 * static_cast<long long>(n - 1);
+
+        // Small arrays keep about sqrt(n) buckets so the distribution stays visible;
+        // large ones get cache-sized buckets, capped by how many scatter streams stay cached
+        size_t visible = std::min(static_cast<size_t>(std::sqrt(n)), n / 2);
+        bucketCount = std::clamp(std::max(visible, n / BUCKET_ELEMENTS), static_cast<size_t>(1), MAX_BUCKETS);
+
+        bucketStarts.assign(bucketCount + 1, 0);
+        contiguous.resize(n);
+    }
+
+    void BucketSort::computeOffsets() {
+        // bucketStarts[b + 1] holds the size of bucket b; the running sum turns sizes into offsets
+        std::partial_sum(bucketStarts.begin(), bucketStarts.end(), bucketStarts.begin());
+        bucketCursors.assign(bucketStarts.begin(), bucketStarts.end() - 1);
+    }
+
+    void BucketSort::rebuildPhase(const Visualization::VisualizationData& data) {
+        // The array does not change before collection, so counts and the scatter are
+        // simply redone up to the restored element
+        const auto& array = data.getValues();
+        if (phase == Phase::Count && currentElement > 0) {
+            std::fill(bucketStarts.begin(), bucketStarts.end(), 0);
+            for (size_t i = 0; i < currentElement; i++) {
+                bucketStarts[bucketOf(array[i]) + 1]++;
+            }
+        }
+        else if (phase == Phase::Scatter) {
+            std::fill(bucketStarts.begin(), bucketStarts.end(), 0);
+            for (int value : array) {
+                bucketStarts[bucketOf(value) + 1]++;
+            }
+            computeOffsets();
+            for (size_t i = 0; i < currentElement; i++) {
+                contiguous[bucketCursors[bucketOf(array[i])]++] = array[i];
+            }
+        }
+        else if (phase == Phase::Collect) {
+            currentBucket = 0;
+        }
+    }
+
+    void BucketSort::sortBuckets(SortingStats& stats) {
+        size_t n = contiguous.size();
+        auto& scheduler = Scheduler::getDefault();
+        // A few runs per pool thread, so members that join late or sort faster take more of them
+        size_t taskCount = std::min<size_t>(static_cast<size_t>(scheduler.getThreadCount()) * 4, bucketCount);
+        if (n < BUCKET_ELEMENTS * 8) {
+            taskCount = 1;
+        }
+
+        // Cut the buckets into runs of whole buckets holding about n / taskCount elements each
+        std::vector<size_t> firstBucket(taskCount + 1, bucketCount);
+        firstBucket[0] = 0;
+        for (size_t t = 1, b = 0; t < taskCount; t++) {
+            size_t target = n * t / taskCount;
+            while (b < bucketCount && bucketStarts[b] < target) {
+                b++;
+            }
+            firstBucket[t] = b;
+        }
+
+        std::vector<long long> comparisons(taskCount, 0);
+        auto sortRun = [&](size_t t) {
+            long long count = 0;
+            auto counted = [&count](int a, int b) {
+                count++;
+                return a < b;
+            };
+            for (size_t b = firstBucket[t]; b < firstBucket[t + 1]; b++) {
+                size_t size = bucketStarts[b + 1] - bucketStarts[b];
+                if (size <= static_cast<size_t>(SortingNetwork::getBaseCaseSize())) {
+                    count += SortingNetwork::sort(contiguous.data() + bucketStarts[b], static_cast<int>(size));
+                }
+                else {
+                    std::sort(contiguous.begin() + bucketStarts[b], contiguous.begin() + bucketStarts[b + 1], counted);
+                }
+            }
+            comparisons[t] = count;
+        };
+
+        // The calling thread and the idle pool threads within the CPU budget take runs until none are left
+        std::atomic<size_t> nextTask{ 0 };
+        int members = static_cast<int>(std::min<size_t>(taskCount, static_cast<size_t>(scheduler.getThreadCount())));
+        scheduler.runTeam(members, [&](int) {
+            for (size_t t = nextTask++; t < taskCount; t = nextTask++) {
+                sortRun(t);
+            }
+        });
+
+        for (long long count : comparisons) {
+            stats.comparisons += count;
+        }
+    }
+
     void BucketSort::run(Visualization::VisualizationData& data, SortingStats& stats) {
         if (stats.currentStep == 0) {
             reset();
@@ -222,7 +461,7 @@ namespace Algorithms {
 
         while (stats.isSorting && !stats.sortingComplete) {
             step(data, stats);
-            std::this_thread::sleep_for(std::chrono::milliseconds(stats.speedFactor));
+            pace(stats);
         }
 
         data.resetHighlighting();
@@ -5,7 +5,12 @@
 namespace Algorithms {
     class BucketSort : public Algorithm {
     public:
-        BucketSort();
+        // Classic distributes into up to 10 growable buckets and insertion sorts each one.
+        // PrefixSum counts the bucket sizes first, scatters into one contiguous buffer at
+        // prefix-sum offsets and sorts the buckets on the shared pool with an O(n log n) sort.
+        enum class Mode { Classic, PrefixSum };
+
+        BucketSort(Mode mode = Mode::Classic);
 
         void step(Visualization::VisualizationData& data, SortingStats& stats) override;
 
@@ -15,7 +20,18 @@ namespace Algorithms {
 
         void reset() override;
 
+        const char* getPhaseName() const override;
+
     private:
+        enum class Phase { Count, Scatter, SortBuckets, Collect };
+
+        // A bucket of about this many ints stays in L1 while it is sorted
+        static constexpr size_t BUCKET_ELEMENTS = 2048;
+        // Upper bound on scatter targets, so every bucket's write position stays cached
+        static constexpr size_t MAX_BUCKETS = 4096;
+
+        Mode mode;
+
         std::vector<std::vector<int>> buckets;
         std::vector<size_t> bucketSizes;
         size_t currentBucket;
@@ -23,11 +39,27 @@ namespace Algorithms {
         size_t outputIndex;
         bool distributionPhase;
         bool initialized;
-        
+        int minValue = 0;
+        int maxValue = 0;
+
+        // Prefix sum state
+        Phase phase = Phase::Count;
+        size_t bucketCount = 0;
+        std::vector<size_t> bucketStarts;   // bucketCount + 1 offsets into contiguous
+        std::vector<size_t> bucketCursors;  // Next free slot of each bucket while scattering
+        std::vector<int> contiguous;
+
         // Helper methods
         void initializeBuckets(const Visualization::VisualizationData& data);
         void stepDistribution(Visualization::VisualizationData& data, SortingStats& stats);
         void stepCollection(Visualization::VisualizationData& data, SortingStats& stats);
         void insertionSortBucket(std::vector<int>& bucket, SortingStats& stats);
+
+        size_t bucketOf(int value) const;
+        void stepPrefixSum(Visualization::VisualizationData& data, SortingStats& stats);
+        void initializeCounts(const Visualization::VisualizationData& data, SortingStats& stats);
+        void computeOffsets();
+        void rebuildPhase(const Visualization::VisualizationData& data);
+        void sortBuckets(SortingStats& stats);
     };
-}
\ No newline at end of file
+}
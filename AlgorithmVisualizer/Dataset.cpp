@@ -0,0 +1,95 @@
+#include "Dataset.h"
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace Utils {
+
+    namespace {
+        // The values are stored as they are in memory, which is the file's byte order only on little-endian hosts
+        constexpr bool NATIVE_LITTLE_ENDIAN = std::endian::native == std::endian::little;
+    }
+
+    bool Dataset::open(const std::string& path, std::string& error) {
+        values = {};
+        if constexpr (!NATIVE_LITTLE_ENDIAN) {
+            error = "datasets can only be read on little-endian hosts";
+            return false;
+        }
+        if (!file.open(path)) {
+            error = "could not open '" + path + "', please check the path";
+            return false;
+        }
+
+        DatasetHeader expected;
+        if (file.size() < sizeof(DatasetHeader)) {
+            error = "'" + path + "' is too short to be a dataset";
+            file.close();
+            return false;
+        }
+        std::memcpy(&header, file.data(), sizeof(DatasetHeader));
+        std::string problem;
+        if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0) {
+            problem = "'" + path + "' is not a dataset";
+        }
+        else if (header.version != expected.version) {
+            problem = "unsupported dataset version " + std::to_string(header.version);
+        }
+        else if (header.type != DatasetType::Int32) {
+            problem = "unsupported value type " + std::to_string(static_cast<uint32_t>(header.type));
+        }
+        else if ((file.size() - sizeof(DatasetHeader)) / sizeof(int) < header.count) {
+            problem = "'" + path + "' holds fewer values than its header says";
+        }
+        if (!problem.empty()) {
+            error = problem;
+            file.close();
+            return false;
+        }
+
+        // The mapping is page aligned, so the values after the 64-byte header are aligned for int
+        values = std::span<const int>(reinterpret_cast<const int*>(file.data() + sizeof(DatasetHeader)), header.count);
+        return true;
+    }
+
+    bool Dataset::write(const std::string& path, const DatasetHeader& header, std::span<const int> values, std::string& error) {
+        if constexpr (!NATIVE_LITTLE_ENDIAN) {
+            error = "datasets can only be written on little-endian hosts";
+            return false;
+        }
+
+        DatasetHeader written = header;
+        written.type = DatasetType::Int32;
+        written.count = values.size();
+
+        // Written beside the target and renamed over it, so a mapping of the old file, even of the
+        // dataset being exported, keeps its pages instead of seeing the file truncated under it
+        std::string temporaryPath = path + ".tmp";
+        std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            error = "could not create '" + temporaryPath + "'";
+            return false;
+        }
+        // One write for all the values; the stream hands large blocks straight to the OS
+        output.write(reinterpret_cast<const char*>(&written), sizeof(written));
+        output.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size_bytes()));
+        output.close();
+        if (!output) {
+            error = "could not write '" + temporaryPath + "'";
+            std::error_code removeError;
+            std::filesystem::remove(temporaryPath, removeError);
+            return false;
+        }
+
+        std::error_code renameError;
+        std::filesystem::rename(temporaryPath, path, renameError);
+        if (renameError) {
+            error = "could not replace '" + path + "': " + renameError.message();
+            std::filesystem::remove(temporaryPath, renameError);
+            return false;
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "MappedFile.h"
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace Utils {
+
+    // Element type of a dataset's values
+    enum class DatasetType : uint32_t {
+        Int32 = 1
+    };
+
+    // Fixed header of the binary dataset format, followed by count raw little-endian values.
+    // 64 bytes, so in a mapping the values start on a cache line.
+    struct DatasetHeader {
+        char magic[8] = { 'A', 'V', 'D', 'A', 'T', 'A', '\r', '\n' };
+        uint32_t version = 1;
+        DatasetType type = DatasetType::Int32;
+        uint64_t count = 0;
+        // Generator settings the values came from; distribution is -1 when they were not generated
+        uint64_t seed = 0;
+        int32_t distribution = -1;
+        uint32_t flags = 0;
+        uint8_t reserved[24] = {};
+    };
+    static_assert(sizeof(DatasetHeader) == 64, "The header size is part of the file format");
+
+    // A dataset file mapped read-only. Opening reads only the header; the values are paged in
+    // by the OS as they are first touched, so a dataset of any size opens at once.
+    class Dataset {
+    public:
+        // DatasetHeader::flags
+        static constexpr uint32_t SORTED = 1;
+
+        Dataset() = default;
+        Dataset(const Dataset&) = delete;
+        Dataset& operator=(const Dataset&) = delete;
+
+        // Returns false with error set when the file cannot be mapped or is not a valid dataset
+        bool open(const std::string& path, std::string& error);
+
+        const DatasetHeader& getHeader() const { return header; }
+        std::span<const int> getValues() const { return values; }
+
+        // Writes the header, with its type and count taken from the values, then the values themselves
+        static bool write(const std::string& path, const DatasetHeader& header, std::span<const int> values, std::string& error);
+
+    private:
+        MappedFile file;
+        DatasetHeader header;
+        std::span<const int> values;
+    };
+
+}
@@ -0,0 +1,450 @@
+#include "ExternalMergeSort.h"
+#include "Dataset.h"
+#include "LoserTree.h"
+#include "ParallelQuickSort.h"
+#include <filesystem>
+
+namespace Algorithms {
+
+    namespace {
+        // Smallest budget, in values, that still leaves room for two runs and a 2-way merge
+        constexpr size_t MIN_BUDGET = 16;
+
+        // Range color of a run; 0 is left for the final output
+        uint8_t getRunGroup(size_t run) {
+            return static_cast<uint8_t>(run % 255 + 1);
+        }
+
+        // Reads a run back a block at a time, with the next block in flight while the current one is merged
+        class RunReader {
+        public:
+            void open(Utils::SpillFile& file, uint64_t count, size_t blockSize, long long& bytesRead) {
+                this->file = &file;
+                this->bytesRead = &bytesRead;
+                remaining = count;
+                block.resize(blockSize);
+                prefetched.resize(blockSize);
+                position = 0;
+                length = 0;
+                requested = 0;
+                failed = !file.rewind();
+                if (!failed) {
+                    prefetch();
+                }
+            }
+
+            bool pop(int& value) {
+                if (position == length && !refill()) {
+                    return false;
+                }
+                value = block[position++];
+                return true;
+            }
+
+            bool hasFailed() const { return failed; }
+
+        private:
+            Utils::SpillFile* file = nullptr;
+            long long* bytesRead = nullptr;
+            uint64_t remaining = 0;
+            std::vector<int> block;
+            std::vector<int> prefetched;
+            size_t position = 0;
+            size_t length = 0;
+            // Values of the read in flight
+            size_t requested = 0;
+            bool failed = false;
+
+            void prefetch() {
+                requested = static_cast<size_t>(std::min<uint64_t>(remaining, prefetched.size()));
+                if (requested > 0) {
+                    file->read(prefetched.data(), requested * sizeof(int));
+                    remaining -= requested;
+                }
+            }
+
+            bool refill() {
+                if (requested == 0) {
+                    return false;
+                }
+                size_t moved = file->wait();
+                *bytesRead += static_cast<long long>(moved);
+                if (moved != requested * sizeof(int)) {
+                    failed = true;
+                    requested = 0;
+                    return false;
+                }
+                block.swap(prefetched);
+                length = requested;
+                position = 0;
+                prefetch();
+                return true;
+            }
+        };
+    }
+
+    ExternalMergeSort::ExternalMergeSort(size_t memoryBudget, RunSorterFactory createRunSorter)
+        : Algorithm("External Merge Sort"), budget(std::max(memoryBudget / sizeof(int), MIN_BUDGET)),
+        createRunSorter(std::move(createRunSorter)) {
+        if (!this->createRunSorter) {
+            this->createRunSorter = []() { return std::make_unique<ParallelQuickSort>(); };
+        }
+        runSorter = this->createRunSorter();
+        reset();
+    }
+
+    void ExternalMergeSort::reset() {
+        runSorter->reset();
+        for (auto& buffer : runBuffers) {
+            buffer = Visualization::VisualizationData(0);
+        }
+        phase = Phase::Idle;
+        failure.clear();
+    }
+
+    bool ExternalMergeSort::isComplete(const SortingStats& stats) const {
+        return stats.sortingComplete;
+    }
+
+    const char* ExternalMergeSort::getPhaseName() const {
+        switch (phase.load(std::memory_order_relaxed)) {
+        case Phase::Runs: return "Generating runs";
+        case Phase::Merging: return "Merging runs on disk";
+        case Phase::FinalMerge: return "Final merge";
+        case Phase::Failed: return "Failed: temporary file error";
+        default: return nullptr;
+        }
+    }
+
+    size_t ExternalMergeSort::getFanIn() const {
+        size_t blockPairs = budget / (2 * MIN_BLOCK);
+        return std::max<size_t>(blockPairs, 3) - 1;
+    }
+
+    size_t ExternalMergeSort::getBlockSize(size_t fanIn) const {
+        return std::max<size_t>(budget / (2 * fanIn + 2), 1);
+    }
+
+    void ExternalMergeSort::run(Visualization::VisualizationData& data, SortingStats& stats) {
+        reset();
+        stats.reset();
+        stats.isSorting = true;
+        data.resetHighlighting();
+        data.clearGroups();
+
+        std::vector<int>& array = data.getValues();
+
+        if (array.size() <= getRunCapacity()) {
+            // One run is the whole answer, there is nothing to spill
+            enterPhase(Phase::Runs, stats);
+            const std::vector<int>& sorted = sortRun(array, runBuffers[0], stats);
+            std::copy(sorted.begin(), sorted.end(), array.begin());
+            data.markAllDirty();
+            stats.currentStep++;
+        }
+        else {
+            std::vector<Run> runs;
+            if (generateRuns(array, runs, stats, &data) && reduceRuns(runs, stats, &data) && stats.isSorting) {
+                // The runs are all on disk, so the output can go straight over them
+                enterPhase(Phase::FinalMerge, stats);
+                Output output;
+                output.array = array.data();
+                mergeRuns(runs, output, stats, &data, 0);
+            }
+        }
+        data.markedLow = -1;
+        data.markedHigh = -1;
+
+        if (stats.isSorting) {
+            phase = Phase::Idle;
+            stats.sortingComplete = true;
+            stats.isSorting = false;
+        }
+    }
+
+    bool ExternalMergeSort::sortDataset(const std::string& inputPath, const std::string& outputPath, SortingStats& stats, std::string& error) {
+        reset();
+        stats.reset();
+        stats.isSorting = true;
+
+        Utils::Dataset input;
+        if (!input.open(inputPath, error)) {
+            stats.isSorting = false;
+            return false;
+        }
+        std::span<const int> values = input.getValues();
+        Utils::DatasetHeader header = input.getHeader();
+        header.flags |= Utils::Dataset::SORTED;
+
+        bool sorted = false;
+        if (values.size() <= getRunCapacity()) {
+            enterPhase(Phase::Runs, stats);
+            sorted = Utils::Dataset::write(outputPath, header, sortRun(values, runBuffers[0], stats), error);
+        }
+        else {
+            std::vector<Run> runs;
+            if (generateRuns(values, runs, stats, nullptr) && reduceRuns(runs, stats, nullptr) && stats.isSorting) {
+                enterPhase(Phase::FinalMerge, stats);
+
+                // Written beside the target and renamed over it, as Dataset::write does
+                std::string temporaryPath = outputPath + ".tmp";
+                Utils::SpillFile file;
+                if (file.create(temporaryPath, error)) {
+                    Output output;
+                    output.file = &file;
+                    file.write(&header, sizeof(header));
+                    sorted = mergeRuns(runs, output, stats, nullptr, 0);
+                    sorted = file.close() && sorted;
+                    if (!sorted && failure.empty()) {
+                        error = "could not write '" + temporaryPath + "'";
+                    }
+                }
+
+                std::error_code fileError;
+                if (sorted) {
+                    std::filesystem::rename(temporaryPath, outputPath, fileError);
+                    if (fileError) {
+                        error = "could not replace '" + outputPath + "': " + fileError.message();
+                        sorted = false;
+                    }
+                }
+                if (!sorted) {
+                    std::filesystem::remove(temporaryPath, fileError);
+                }
+            }
+        }
+
+        if (!sorted && error.empty()) {
+            error = failure.empty() ? "stopped" : failure;
+        }
+        if (stats.isSorting) {
+            phase = sorted ? Phase::Idle : Phase::Failed;
+            stats.sortingComplete = sorted;
+            stats.isSorting = false;
+        }
+        return sorted;
+    }
+
+    const std::vector<int>& ExternalMergeSort::sortRun(std::span<const int> input, Visualization::VisualizationData& buffer, SortingStats& stats) {
+        if (static_cast<size_t>(buffer.size()) != input.size()) {
+            buffer.resize(static_cast<int>(input.size()));
+        }
+        std::vector<int>& values = buffer.getValues();
+        std::copy(input.begin(), input.end(), values.begin());
+
+        // Headless, like a benchmark run: no delays and no undo log
+        SortingStats runStats;
+        runStats.speedFactor = 0;
+        runStats.recordHistory = false;
+        runSorter->reset();
+        runSorter->run(buffer, runStats);
+
+        long long moved = static_cast<long long>(input.size());
+        stats.comparisons += runStats.comparisons;
+        stats.swaps += runStats.swaps + moved;
+        stats.writes += runStats.writes + moved;
+        return values;
+    }
+
+    bool ExternalMergeSort::generateRuns(std::span<const int> input, std::vector<Run>& runs, SortingStats& stats, Visualization::VisualizationData* data) {
+        enterPhase(Phase::Runs, stats);
+        size_t capacity = getRunCapacity();
+
+        for (size_t first = 0; first < input.size(); first += capacity) {
+            if (!stats.isSorting) {
+                return false;
+            }
+
+            // The run two back was spilled from this buffer
+            Visualization::VisualizationData& buffer = runBuffers[runs.size() % 2];
+            if (runs.size() >= 2) {
+                Utils::SpillFile& spilled = *runs[runs.size() - 2].file;
+                spilled.wait();
+                if (spilled.hasFailed()) {
+                    return fail("could not write '" + spilled.getPath() + "'", stats);
+                }
+            }
+
+            size_t length = std::min(capacity, input.size() - first);
+            const std::vector<int>& sorted = sortRun(input.subspan(first, length), buffer, stats);
+
+            Run run;
+            run.first = first;
+            run.count = length;
+            run.file = std::make_unique<Utils::SpillFile>();
+            std::string error;
+            if (!run.file->createTemporary(error)) {
+                return fail(error, stats);
+            }
+            run.file->write(sorted.data(), length * sizeof(int));
+            stats.bytesWritten += static_cast<long long>(length * sizeof(int));
+            runs.push_back(std::move(run));
+
+            // Show the run while it is written out; both only read the buffer
+            if (data != nullptr) {
+                int low = static_cast<int>(first);
+                int high = low + static_cast<int>(length) - 1;
+                std::copy(sorted.begin(), sorted.end(), data->getValues().begin() + low);
+                data->setGroup(low, high, getRunGroup(runs.size() - 1));
+                data->markedLow = low;
+                data->markedHigh = high;
+                stats.currentStep++;
+                pace(stats);
+            }
+        }
+
+        for (auto& run : runs) {
+            run.file->wait();
+            if (run.file->hasFailed()) {
+                return fail("could not write '" + run.file->getPath() + "'", stats);
+            }
+        }
+        // The merge gets the whole budget
+        for (auto& buffer : runBuffers) {
+            buffer = Visualization::VisualizationData(0);
+        }
+        return true;
+    }
+
+    bool ExternalMergeSort::reduceRuns(std::vector<Run>& runs, SortingStats& stats, Visualization::VisualizationData* data) {
+        size_t fanIn = getFanIn();
+
+        while (runs.size() > fanIn) {
+            enterPhase(Phase::Merging, stats);
+            std::vector<Run> merged;
+
+            for (size_t begin = 0; begin < runs.size(); begin += fanIn) {
+                if (!stats.isSorting) {
+                    return false;
+                }
+                size_t end = std::min(begin + fanIn, runs.size());
+                if (end - begin == 1) {
+                    merged.push_back(std::move(runs[begin]));
+                    continue;
+                }
+
+                Run run;
+                run.first = runs[begin].first;
+                for (size_t k = begin; k < end; k++) {
+                    run.count += runs[k].count;
+                }
+                run.file = std::make_unique<Utils::SpillFile>();
+                std::string error;
+                if (!run.file->createTemporary(error)) {
+                    return fail(error, stats);
+                }
+
+                Output output;
+                output.file = run.file.get();
+                if (!mergeRuns(std::span<Run>(runs).subspan(begin, end - begin), output, stats, data, getRunGroup(merged.size()))) {
+                    return false;
+                }
+                stats.bytesWritten += static_cast<long long>(run.count * sizeof(int));
+
+                // Give the disk space back as soon as the inputs are merged
+                for (size_t k = begin; k < end; k++) {
+                    runs[k].file.reset();
+                }
+                merged.push_back(std::move(run));
+            }
+            runs.swap(merged);
+        }
+        return true;
+    }
+
+    bool ExternalMergeSort::mergeRuns(std::span<Run> runs, Output& output, SortingStats& stats, Visualization::VisualizationData* data, uint8_t group) {
+        int runCount = static_cast<int>(runs.size());
+        size_t blockSize = getBlockSize(runs.size());
+
+        std::vector<RunReader> readers(runCount);
+        LoserTree tree;
+        tree.reset(runCount);
+        uint64_t total = 0;
+        for (int k = 0; k < runCount; k++) {
+            readers[k].open(*runs[k].file, runs[k].count, blockSize, stats.bytesRead);
+            int head;
+            if (readers[k].pop(head)) {
+                tree.setHead(k, head);
+            }
+            total += runs[k].count;
+        }
+        tree.build();
+
+        if (output.file != nullptr) {
+            output.blocks[0].resize(blockSize);
+            output.blocks[1].resize(blockSize);
+        }
+        int* shown = data != nullptr ? data->getValues().data() : nullptr;
+        uint64_t first = runs.front().first;
+        uint64_t written = 0;
+
+        while (!tree.empty()) {
+            int* block = output.file != nullptr ? output.blocks[output.current].data() : output.array + first + written;
+            size_t filled = 0;
+            while (filled < blockSize && !tree.empty()) {
+                block[filled++] = tree.top();
+                int head;
+                if (readers[tree.winner()].pop(head)) {
+                    tree.replaceTop(head);
+                }
+                else {
+                    tree.exhaustTop();
+                }
+            }
+
+            // Double buffered: the block is written out while the other one fills
+            if (output.file != nullptr) {
+                output.file->write(block, filled * sizeof(int));
+                output.current ^= 1;
+            }
+
+            // The merge frontier moves over the runs' part of the array one block at a time
+            if (data != nullptr) {
+                int low = static_cast<int>(first + written);
+                int high = low + static_cast<int>(filled) - 1;
+                if (block != shown + low) {
+                    std::copy(block, block + filled, shown + low);
+                }
+                data->setGroup(low, high, group);
+                data->markedLow = low;
+                data->markedHigh = high;
+                stats.currentStep++;
+                pace(stats);
+            }
+            written += filled;
+        }
+
+        stats.comparisons += tree.getComparisons();
+        stats.swaps += static_cast<long long>(written);
+        stats.writes += static_cast<long long>(written);
+
+        if (output.file != nullptr) {
+            output.file->wait();
+            if (output.file->hasFailed()) {
+                return fail("could not write '" + output.file->getPath() + "'", stats);
+            }
+        }
+        for (int k = 0; k < runCount; k++) {
+            if (readers[k].hasFailed()) {
+                return fail("could not read back '" + runs[k].file->getPath() + "'", stats);
+            }
+        }
+        if (written != total) {
+            return fail("a temporary file ended early", stats);
+        }
+        return true;
+    }
+
+    void ExternalMergeSort::enterPhase(Phase next, SortingStats& stats) {
+        phase = next;
+        stats.perf.setPhase(getPhaseName());
+    }
+
+    bool ExternalMergeSort::fail(const std::string& message, SortingStats& stats) {
+        failure = message;
+        phase = Phase::Failed;
+        stats.isSorting = false;
+        return false;
+    }
+
+}
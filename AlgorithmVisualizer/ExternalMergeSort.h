@@ -0,0 +1,96 @@
+#pragma once
+#include "Algorithm.h"
+#include "SpillFile.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Algorithms {
+
+    // MergeSort for data larger than memory. The input is cut into runs of half the memory budget;
+    // each is sorted by an in-memory algorithm and spilled to a temporary file while the next one is
+    // sorted in the other half. The runs are then merged through a loser tree, each read a block at a
+    // time with its next block prefetched. When the budget cannot give every run its two blocks, groups
+    // of runs are first merged into longer runs on disk. Each run shows in its own color once spilled,
+    // and every merge writes its output over its runs a block at a time. Swaps count element moves in
+    // memory, the byte counters the traffic to temporary files.
+    class ExternalMergeSort : public Algorithm {
+    public:
+        using RunSorterFactory = std::function<std::unique_ptr<Algorithm>()>;
+
+        static constexpr size_t DEFAULT_MEMORY_BUDGET = size_t(64) << 20;
+
+        // memoryBudget is the bytes of values held at once, sorter buffers aside. Runs are sorted by
+        // ParallelQuickSort unless createRunSorter is given.
+        ExternalMergeSort(size_t memoryBudget = DEFAULT_MEMORY_BUDGET, RunSorterFactory createRunSorter = nullptr);
+
+        void step(Visualization::VisualizationData&, SortingStats&) override {}
+        // A stop request is honoured between runs and between merges, when the array is a whole permutation
+        void run(Visualization::VisualizationData& data, SortingStats& stats) override;
+        bool supportsStepping() const override { return false; }
+        bool supportsRecording() const override { return false; }
+        bool isComplete(const SortingStats& stats) const override;
+        void reset() override;
+        const char* getPhaseName() const override;
+
+        // Sorts the dataset at inputPath into a new dataset at outputPath. The input is mapped rather
+        // than loaded and the output streamed, so neither has to fit in memory. Returns false with
+        // error set when the sort failed or was stopped.
+        bool sortDataset(const std::string& inputPath, const std::string& outputPath, SortingStats& stats, std::string& error);
+
+        // Why the last sort gave up; empty when it did not
+        const std::string& getFailure() const { return failure; }
+
+    private:
+        // A sorted run in a temporary file, and the part of the input it came from
+        struct Run {
+            std::unique_ptr<Utils::SpillFile> file;
+            uint64_t first = 0;
+            uint64_t count = 0;
+        };
+
+        // Where a merge puts its output: straight into an array, or a block at a time into a file
+        struct Output {
+            int* array = nullptr;
+            Utils::SpillFile* file = nullptr;
+            std::vector<int> blocks[2];
+            int current = 0;
+        };
+
+        enum class Phase : int { Idle, Runs, Merging, FinalMerge, Failed };
+
+        // Blocks are not cut below one page; smaller reads would cost a request per few values
+        static constexpr size_t MIN_BLOCK = 1024;
+
+        // Budget in values, at least enough for two runs and a 2-way merge
+        size_t budget;
+        RunSorterFactory createRunSorter;
+        std::unique_ptr<Algorithm> runSorter;
+        // Double buffer of run generation: one run is sorted while the other is spilled
+        Visualization::VisualizationData runBuffers[2];
+        std::atomic<Phase> phase{ Phase::Idle };
+        std::string failure;
+
+        size_t getRunCapacity() const { return std::max<size_t>(budget / 2, 1); }
+        // Runs merged at once: as many as the budget holds with two blocks each plus two for the output
+        size_t getFanIn() const;
+        size_t getBlockSize(size_t fanIn) const;
+
+        // Copies input, which fits in one run, into buffer and sorts it there with the run sorter
+        const std::vector<int>& sortRun(std::span<const int> input, Visualization::VisualizationData& buffer, SortingStats& stats);
+        bool generateRuns(std::span<const int> input, std::vector<Run>& runs, SortingStats& stats, Visualization::VisualizationData* data);
+        // Merges groups of fanIn runs into single runs until the rest can be merged at once
+        bool reduceRuns(std::vector<Run>& runs, SortingStats& stats, Visualization::VisualizationData* data);
+        bool mergeRuns(std::span<Run> runs, Output& output, SortingStats& stats, Visualization::VisualizationData* data, uint8_t group);
+
+        // Sets phase, and the phase the run's hardware counts go to
+        void enterPhase(Phase next, SortingStats& stats);
+        bool fail(const std::string& message, SortingStats& stats);
+    };
+
+}
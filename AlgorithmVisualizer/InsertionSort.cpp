@@ -1,70 +1,77 @@
 #include "InsertionSort.h"
-#include <thread>
-#include <chrono>
 
 namespace Algorithms {
-    InsertionSort::InsertionSort() : Algorithm("Insertion Sort") {
+    template <typename Key, typename Compare>
+    BasicInsertionSort<Key, Compare>::BasicInsertionSort() : BasicAlgorithm<Key, Compare>("Insertion Sort") {
         reset();
     }
 
-    void InsertionSort::step(Visualization::VisualizationData& data, SortingStats& stats) {
+    template <typename Key, typename Compare>
+    void BasicInsertionSort<Key, Compare>::step(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
         if (stats.sortingComplete || !stats.isSorting) {
             return;
         }
 
-        auto& array = data.getArray();
+        auto& array = data.getValues();
         int n = array.size();
 
         // Check if we need to restore algorithm state after stepping backward
         if (stats.stateRestored) {
             i = stats.lastRestoredI;
             j = stats.lastRestoredJ;
-            temp = array[j + 1].value; // Restore temp value from the array
+            temp = array[j + 1]; // Restore temp value from the array
             stats.stateRestored = false;
             
-            // Don't reset highlighting or save state when restoring
+            // Don't reset highlighting when restoring
             // The highlighting is already set in Renderer.cpp when stepping backward
         } else {
             // Only reset highlighting if we're not restoring a state
             data.resetHighlighting();
-            
-            // Save current state before making changes (for step backward functionality)
-            stats.saveState(data, i, j, false); // InsertionSort doesn't use swapped flag
         }
 
-        if (i >= n) {
+        // Start a new undo record before making changes (for step backward functionality)
+        stats.saveState(i, j, false); // InsertionSort doesn't use swapped flag
+
+        // Done once every element has been picked up and the last one has been placed
+        if (i >= n && j == i - 1) {
             stats.sortingComplete = true;
             stats.isSorting = false;
             return;
         }
 
         if (j == i - 1) {
-            array[i].isComparing = true;
-            temp = array[i].value;
+            data.setComparing(i);
+            temp = array[i];
             j = i - 1;
             i++;
         }
 
-        if (j >= 0 && array[j].value > temp) {
-            array[j].isComparing = true;
-            array[j].isSwapping = true;
-            array[j + 1].isSwapping = true;
+        if (j >= 0 && this->compare(temp, array[j])) {
+            data.setComparing(j);
+            data.setSwapping(j);
+            data.setSwapping(j + 1);
+            stats.recordCompare(j, j + 1);
             stats.comparisons++;
             stats.swaps++;
+            stats.writes++;
             stats.currentStep++;
-            array[j + 1] = array[j];
+            stats.recordWrite(j + 1, array[j + 1], array[j]);
+            data.set(j + 1, array[j]);
             j--;
         } else {
             if (j + 1 != i - 1) {
                 stats.swaps++;
+                stats.writes++;
             }
-            array[j + 1].value = temp;
+            stats.recordWrite(j + 1, array[j + 1], temp);
+            data.set(j + 1, temp);
             j = i - 1;
         }
 
     }
 
-    void InsertionSort::run(Visualization::VisualizationData& data, SortingStats& stats) {
+    template <typename Key, typename Compare>
+    void BasicInsertionSort<Key, Compare>::run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
         // Only reset if we're starting a new sort
         if (stats.currentStep == 0) {
             reset();
@@ -81,7 +88,7 @@ namespace Algorithms {
         // Normal continuous execution
         while (stats.isSorting && !stats.sortingComplete) {
             step(data, stats);
-            std::this_thread::sleep_for(std::chrono::milliseconds(stats.speedFactor));
+            this->pace(stats);
         }
 
         data.resetHighlighting();
@@ -91,13 +98,53 @@ namespace Algorithms {
         }
     }
 
-    bool InsertionSort::isComplete(const SortingStats& stats) const {
+    template <typename Key, typename Compare>
+    void BasicInsertionSort<Key, Compare>::runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation) {
+        this->runKernel(data, stats, instrumentation, [&](auto policy) {
+            sortAll<decltype(policy)>(data, stats);
+        });
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicInsertionSort<Key, Compare>::sortAll(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        auto& array = data.getValues();
+        int n = array.size();
+        Probe<Policy, Key> probe(data);
+
+        // A stop request is honoured before each element is picked up
+        for (int next = 1; next < n && stats.isSorting; next++) {
+            Key value = array[next];
+            int position = next;
+            while (position > 0 && (probe.compare(position - 1, position), this->compare(value, array[position - 1]))) {
+                array[position] = array[position - 1];
+                probe.write(position);
+                probe.step();
+                position--;
+            }
+            if (position != next) {
+                array[position] = value;
+                probe.write(position);
+            }
+        }
+
+        probe.flush(stats);
+    }
+
+    template <typename Key, typename Compare>
+    bool BasicInsertionSort<Key, Compare>::isComplete(const SortingStats& stats) const {
         return stats.sortingComplete;
     }
 
-    void InsertionSort::reset() {
+    template <typename Key, typename Compare>
+    void BasicInsertionSort<Key, Compare>::reset() {
         i = 0;
-        j = 0;
-        temp = 0;
+        j = -1; // Makes the first step pick up array[0] instead of shifting it over array[1]
+        temp = Key();
     }
-}
\ No newline at end of file
+
+#define INSTANTIATE(Key) template class BasicInsertionSort<Key>;
+    FOR_EACH_KEY_TYPE(INSTANTIATE)
+#undef INSTANTIATE
+
+}
@@ -2,21 +2,33 @@
 #include "Algorithm.h"
 
 namespace Algorithms {
-	class InsertionSort : public Algorithm
+	template <typename Key, typename Compare = typename Utils::KeyTraits<Key>::Compare>
+	class BasicInsertionSort : public BasicAlgorithm<Key, Compare>
 	{
 	public:
-		InsertionSort();
+		BasicInsertionSort();
 
-		void step(Visualization::VisualizationData& data, SortingStats& stats) override;
+		void step(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) override;
 
-		void run(Visualization::VisualizationData& data, SortingStats& stats) override;
+		void run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) override;
+
+		void runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation) override;
+
+		bool supportsInstrumentation() const override { return true; }
 
 		bool isComplete(const SortingStats& stats) const override;
 
 		void reset() override;
 
 	private:
-		int i, j, temp = 0;
+		int i, j;
+		Key temp{};
+
+		// The shifts of step() in plain loops; the policy decides what they report
+		template <typename Policy>
+		void sortAll(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
 	};
+
+	using InsertionSort = BasicInsertionSort<int>;
 }
 
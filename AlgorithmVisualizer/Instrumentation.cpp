@@ -0,0 +1,14 @@
+#include "Instrumentation.h"
+
+namespace Algorithms {
+
+    const char* getInstrumentationName(Instrumentation instrumentation) {
+        switch (instrumentation) {
+        case Instrumentation::Visual: return "visual";
+        case Instrumentation::Counters: return "counters";
+        case Instrumentation::None: return "none";
+        default: return "unknown";
+        }
+    }
+
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include "VisualizationData.h"
+#include "SortingStats.h"
+
+namespace Algorithms {
+
+    // How much a sorting kernel reports while it runs. Visual highlights every comparison and move
+    // and counts them, as the visualizer shows them; Counters only counts; None reports nothing.
+    enum class Instrumentation {
+        Visual,
+        Counters,
+        None,
+        Count
+    };
+
+    const char* getInstrumentationName(Instrumentation instrumentation);
+
+    // The policies the kernels are instantiated with, one per level
+    struct VisualPolicy {
+        static constexpr Instrumentation level = Instrumentation::Visual;
+        static constexpr bool counts = true;
+        static constexpr bool highlights = true;
+    };
+
+    struct CountersPolicy {
+        static constexpr Instrumentation level = Instrumentation::Counters;
+        static constexpr bool counts = true;
+        static constexpr bool highlights = false;
+    };
+
+    struct NoInstrumentationPolicy {
+        static constexpr Instrumentation level = Instrumentation::None;
+        static constexpr bool counts = false;
+        static constexpr bool highlights = false;
+    };
+
+    // Calls visit(Policy()) with the policy of the level and returns what it returns
+    template <typename Visitor>
+    decltype(auto) visitInstrumentation(Instrumentation instrumentation, Visitor&& visit) {
+        switch (instrumentation) {
+        case Instrumentation::Counters: return visit(CountersPolicy());
+        case Instrumentation::None: return visit(NoInstrumentationPolicy());
+        default: return visit(VisualPolicy());
+        }
+    }
+
+    // A count that only exists when enabled; adding to a disabled one compiles to nothing
+    template <bool enabled>
+    struct Counter {
+        long long value = 0;
+
+        void operator++(int) { value++; }
+        void operator+=(long long amount) { value += amount; }
+    };
+
+    template <>
+    struct Counter<false> {
+        static constexpr long long value = 0;
+
+        void operator++(int) {}
+        void operator+=(long long) {}
+    };
+
+    // What a kernel reports through. The counters are locals of the kernel, which the compiler keeps
+    // in registers, and reach SortingStats once, in flush, so the inner loops write no memory shared
+    // with the render thread. Highlights go to the data under Visual only, and mark what they touch
+    // dirty. Under None every call is empty and the kernel is the bare sort.
+    template <typename Policy, typename Key>
+    class Probe {
+    public:
+        explicit Probe(Visualization::BasicVisualizationData<Key>& data) : data(data) {}
+
+        void compare(int first, int second) {
+            comparisons++;
+            if constexpr (Policy::highlights) {
+                data.setComparing(first);
+                data.setComparing(second);
+            }
+        }
+
+        // Two elements exchanged
+        void swap(int first, int second) {
+            swaps++;
+            if constexpr (Policy::highlights) {
+                data.setSwapping(first);
+                data.setSwapping(second);
+            }
+        }
+
+        // One element stored; like SortingStats, swaps counts it as a move as well
+        void write(int index) {
+            swaps++;
+            writes++;
+            if constexpr (Policy::highlights) {
+                data.setSwapping(index);
+            }
+        }
+
+        // Ends what the step-by-step sort does in one step, and clears its highlights as that does
+        void step() {
+            steps++;
+            if constexpr (Policy::highlights) {
+                data.resetHighlighting();
+            }
+        }
+
+        // Range the kernel is working on
+        void mark(int low, int high) {
+            if constexpr (Policy::highlights) {
+                data.markedLow = low;
+                data.markedHigh = high;
+            }
+        }
+
+        void flush(SortingStats& stats) const {
+            stats.comparisons += comparisons.value;
+            stats.swaps += swaps.value;
+            stats.writes += writes.value;
+            stats.currentStep += steps.value;
+        }
+
+        Counter<Policy::counts> comparisons;
+        Counter<Policy::counts> swaps;
+        Counter<Policy::counts> writes;
+        Counter<Policy::counts> steps;
+
+    private:
+        Visualization::BasicVisualizationData<Key>& data;
+    };
+
+}
@@ -0,0 +1,16 @@
+#include "Keys.h"
+
+namespace Utils {
+
+    const char* getKeyTypeName(KeyType type) {
+        switch (type) {
+        case KeyType::Int32: return "int32";
+        case KeyType::Int64: return "int64";
+        case KeyType::Double: return "double";
+        case KeyType::String: return "string16";
+        case KeyType::Record: return "record";
+        default: return "unknown";
+        }
+    }
+
+}
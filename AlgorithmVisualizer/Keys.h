@@ -0,0 +1,166 @@
+#pragma once
+#include "Random.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+namespace Utils {
+
+    // Text of a fixed width, e.g. a product code; shorter text is padded with zero bytes
+    struct FixedString {
+        static constexpr int SIZE = 16;
+        char text[SIZE]{};
+
+        bool operator==(const FixedString& other) const { return std::memcmp(text, other.text, SIZE) == 0; }
+    };
+
+    // A key and the payload it identifies, e.g. a row id. Only the key is compared, so a stable
+    // sort keeps the payloads of equal keys in input order.
+    struct Record {
+        int64_t key = 0;
+        uint64_t payload = 0;
+
+        bool operator==(const Record& other) const { return key == other.key && payload == other.payload; }
+    };
+
+    // NaN after every number and equal to every other NaN, which makes doubles a strict weak order.
+    // Plain < is not one: NaN compares false both ways against everything, and a sort may scatter it.
+    struct NanLastLess {
+        bool operator()(double a, double b) const { return a < b || (!std::isnan(a) && std::isnan(b)); }
+    };
+
+    // Byte by byte, like memcmp
+    struct FixedStringLess {
+        bool operator()(const FixedString& a, const FixedString& b) const { return std::memcmp(a.text, b.text, FixedString::SIZE) < 0; }
+    };
+
+    struct RecordKeyLess {
+        bool operator()(const Record& a, const Record& b) const { return a.key < b.key; }
+    };
+
+    // Key types the algorithms are instantiated for
+    enum class KeyType {
+        Int32,
+        Int64,
+        Double,
+        String,
+        Record,
+        Count
+    };
+
+    const char* getKeyTypeName(KeyType type);
+
+    // What the generators, the renderer and the benchmark need to know about a key type: its default
+    // comparator, how to make a key from a generated int without changing the order of the ints, how
+    // tall to draw it, and a hash whose sum over an array does not depend on the order of its keys.
+    template <typename Key>
+    struct KeyTraits;
+
+    template <>
+    struct KeyTraits<int> {
+        using Compare = std::less<int>;
+        static constexpr KeyType type = KeyType::Int32;
+
+        static int fromValue(int value, size_t, uint64_t) { return value; }
+        static int toDisplay(int key) { return key; }
+        static uint64_t hash(int key) { return SplitMix64::mix(static_cast<uint32_t>(key)); }
+    };
+
+    // 64-bit ids: the value in the upper half and random low bits, so ids are unique but keep the value's order
+    template <>
+    struct KeyTraits<int64_t> {
+        using Compare = std::less<int64_t>;
+        static constexpr KeyType type = KeyType::Int64;
+
+        static int64_t fromValue(int value, size_t, uint64_t random) { return (static_cast<int64_t>(value) << 32) | static_cast<int64_t>(random >> 32); }
+        static int toDisplay(int64_t key) { return static_cast<int>(key >> 32); }
+        static uint64_t hash(int64_t key) { return SplitMix64::mix(static_cast<uint64_t>(key)); }
+    };
+
+    // The value plus a random fraction; one key in NAN_PERIOD is NaN instead, and is drawn empty
+    template <>
+    struct KeyTraits<double> {
+        using Compare = NanLastLess;
+        static constexpr KeyType type = KeyType::Double;
+        static constexpr uint64_t NAN_PERIOD = 64;
+
+        static double fromValue(int value, size_t, uint64_t random) {
+            if (random % NAN_PERIOD == 0) {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+            return value + static_cast<double>(random >> 11) * 0x1.0p-53;
+        }
+        static int toDisplay(double key) { return std::isnan(key) ? 0 : static_cast<int>(std::floor(key)); }
+        static uint64_t hash(double key) {
+            uint64_t bits;
+            std::memcpy(&bits, &key, sizeof(bits));
+            return SplitMix64::mix(bits);
+        }
+    };
+
+    // The value as ten digits, offset so negative values sort first, then five random letters: keys
+    // share long prefixes, as real codes do, and each comparison has to get past them
+    template <>
+    struct KeyTraits<FixedString> {
+        using Compare = FixedStringLess;
+        static constexpr KeyType type = KeyType::String;
+        static constexpr int DIGITS = 10;
+        static constexpr int LETTERS = 5;
+
+        static FixedString fromValue(int value, size_t, uint64_t random) {
+            FixedString key;
+            uint32_t offset = static_cast<uint32_t>(value) ^ 0x80000000u;
+            for (int digit = DIGITS - 1; digit >= 0; digit--) {
+                key.text[digit] = static_cast<char>('0' + offset % 10);
+                offset /= 10;
+            }
+            for (int letter = 0; letter < LETTERS; letter++) {
+                key.text[DIGITS + letter] = static_cast<char>('a' + (random >> (letter * 12)) % 26);
+            }
+            return key;
+        }
+        static int toDisplay(const FixedString& key) {
+            uint32_t offset = 0;
+            for (int digit = 0; digit < DIGITS; digit++) {
+                offset = offset * 10 + static_cast<uint32_t>(key.text[digit] - '0');
+            }
+            return static_cast<int>(offset ^ 0x80000000u);
+        }
+        static uint64_t hash(const FixedString& key) {
+            uint64_t words[2];
+            std::memcpy(words, key.text, sizeof(words));
+            return SplitMix64::mix(words[0] ^ SplitMix64::mix(words[1]));
+        }
+    };
+
+    // The value as key and the input position as payload, which shows whether a sort was stable
+    template <>
+    struct KeyTraits<Record> {
+        using Compare = RecordKeyLess;
+        static constexpr KeyType type = KeyType::Record;
+
+        static Record fromValue(int value, size_t index, uint64_t) { return { value, index }; }
+        static int toDisplay(const Record& key) { return static_cast<int>(key.key); }
+        static uint64_t hash(const Record& key) { return SplitMix64::mix(static_cast<uint64_t>(key.key) ^ SplitMix64::mix(key.payload)); }
+    };
+
+    // Calls visit(std::type_identity<Key>()) with the key type named by type and returns what it returns
+    template <typename Visitor>
+    decltype(auto) visitKeyType(KeyType type, Visitor&& visit) {
+        switch (type) {
+        case KeyType::Int64: return visit(std::type_identity<int64_t>());
+        case KeyType::Double: return visit(std::type_identity<double>());
+        case KeyType::String: return visit(std::type_identity<FixedString>());
+        case KeyType::Record: return visit(std::type_identity<Record>());
+        default: return visit(std::type_identity<int>());
+        }
+    }
+
+}
+
+// Expands X(Key) for every key type; the templates over the key are explicitly instantiated with it
+#define FOR_EACH_KEY_TYPE(X) X(int) X(int64_t) X(double) X(Utils::FixedString) X(Utils::Record)
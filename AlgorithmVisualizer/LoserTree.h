@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Algorithms {
+
+    // Tournament tree over the heads of k sorted sources. Every inner node keeps the loser of the
+    // match played there and the root the overall winner, so replacing the winner's head replays
+    // only its own path: log2(k) comparisons, each against a stored loser, where a binary heap needs
+    // two per level. Ties go to the lower source, which keeps a merge of runs in input order stable.
+    class LoserTree {
+    public:
+        // Starts a tournament over sourceCount sources, all exhausted until given a head
+        void reset(int sourceCount) {
+            count = sourceCount;
+            keys.assign(count, 0);
+            exhausted.assign(count, 1);
+            losers.assign(count, 0);
+        }
+
+        void setHead(int source, int key) {
+            keys[source] = key;
+            exhausted[source] = 0;
+        }
+
+        // Plays every match once; call after setting the first heads
+        void build() {
+            // Leaves at count..2 count - 1, inner node i has children 2i and 2i + 1
+            std::vector<int> winners(2 * count);
+            for (int source = 0; source < count; source++) {
+                winners[count + source] = source;
+            }
+            for (int node = count - 1; node > 0; node--) {
+                int left = winners[2 * node];
+                int right = winners[2 * node + 1];
+                bool leftWins = beats(left, right);
+                winners[node] = leftWins ? left : right;
+                losers[node] = leftWins ? right : left;
+            }
+            losers[0] = winners[1];
+        }
+
+        // Source holding the smallest head; only meaningful while !empty()
+        int winner() const { return losers[0]; }
+        int top() const { return keys[losers[0]]; }
+        bool empty() const { return count == 0 || exhausted[losers[0]] != 0; }
+
+        // The winner's source moved on to key, or ran out
+        void replaceTop(int key) {
+            keys[losers[0]] = key;
+            replay();
+        }
+        void exhaustTop() {
+            exhausted[losers[0]] = 1;
+            replay();
+        }
+
+        // Comparisons between two live heads since the tree was created
+        long long getComparisons() const { return comparisons; }
+
+    private:
+        int count = 0;
+        std::vector<int> keys;
+        std::vector<uint8_t> exhausted;
+        // losers[0] is the winner, losers[1..count - 1] the inner nodes
+        std::vector<int> losers;
+        long long comparisons = 0;
+
+        // Whether source a wins its match against source b
+        bool beats(int a, int b) {
+            if (exhausted[a] || exhausted[b]) {
+                return !exhausted[a] && (exhausted[b] || a < b);
+            }
+            comparisons++;
+            return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+        }
+
+        void replay() {
+            int winner = losers[0];
+            for (int node = (winner + count) >> 1; node > 0; node >>= 1) {
+                if (beats(losers[node], winner)) {
+                    std::swap(losers[node], winner);
+                }
+            }
+            losers[0] = winner;
+        }
+    };
+
+}
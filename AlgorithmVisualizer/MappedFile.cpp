@@ -0,0 +1,101 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Utils {
+
+    MappedFile::~MappedFile() {
+        close();
+    }
+
+    bool MappedFile::open(const std::string& path) {
+        close();
+#if defined(_WIN32)
+        HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        file = handle;
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(handle, &fileSize)) {
+            close();
+            return false;
+        }
+        length = static_cast<size_t>(fileSize.QuadPart);
+        if (length > 0) {
+            mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping == nullptr) {
+                close();
+                return false;
+            }
+            view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            if (view == nullptr) {
+                close();
+                return false;
+            }
+        }
+#else
+        descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return false;
+        }
+
+        struct stat status {};
+        if (fstat(descriptor, &status) != 0) {
+            close();
+            return false;
+        }
+        length = static_cast<size_t>(status.st_size);
+        if (length > 0) {
+            void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (address == MAP_FAILED) {
+                close();
+                return false;
+            }
+            // Readers go front to back, so let the kernel read ahead aggressively
+            madvise(address, length, MADV_SEQUENTIAL);
+            view = static_cast<const char*>(address);
+        }
+#endif
+        opened = true;
+        return true;
+    }
+
+    void MappedFile::close() {
+#if defined(_WIN32)
+        if (view != nullptr) {
+            UnmapViewOfFile(view);
+        }
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        if (file != nullptr) {
+            CloseHandle(file);
+        }
+        mapping = nullptr;
+        file = nullptr;
+#else
+        if (view != nullptr) {
+            munmap(const_cast<char*>(view), length);
+        }
+        if (descriptor >= 0) {
+            ::close(descriptor);
+        }
+        descriptor = -1;
+#endif
+        view = nullptr;
+        length = 0;
+        opened = false;
+    }
+
+}
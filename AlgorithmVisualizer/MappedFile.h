@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace Utils {
+
+    // Read-only view of a whole file through the virtual memory system. Pages are read in by the OS
+    // as they are first touched, so nothing is copied into the process and opening costs no I/O.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // Returns false when the file cannot be opened or mapped; an empty file opens with size 0
+        bool open(const std::string& path);
+        void close();
+
+        bool isOpen() const { return opened; }
+        const char* data() const { return view; }
+        size_t size() const { return length; }
+
+    private:
+        const char* view = nullptr;
+        size_t length = 0;
+        bool opened = false;
+#if defined(_WIN32)
+        void* file = nullptr;
+        void* mapping = nullptr;
+#else
+        int descriptor = -1;
+#endif
+    };
+
+}
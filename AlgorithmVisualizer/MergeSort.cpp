@@ -1,93 +1,271 @@
 #include "MergeSort.h"
-#include <thread>
-#include <chrono>
+#include <algorithm>
 
 namespace Algorithms {
 
-    MergeSort::MergeSort() : Algorithm("Merge Sort") {
+    template <typename Key, typename Compare>
+    BasicMergeSort<Key, Compare>::BasicMergeSort() : BasicAlgorithm<Key, Compare>("Merge Sort") {
         reset();
     }
 
-    void MergeSort::reset() {
-        completed = false;
+    template <typename Key, typename Compare>
+    void BasicMergeSort<Key, Compare>::reset() {
+        width = 1;
+        left = 0;
+        i = 0;
+        j = 1;
+        merging = false;
     }
 
-    bool MergeSort::isComplete(const SortingStats& stats) const {
+    template <typename Key, typename Compare>
+    bool BasicMergeSort<Key, Compare>::isComplete(const SortingStats& stats) const {
         return stats.sortingComplete;
     }
 
-    void MergeSort::run(Visualization::VisualizationData& data, SortingStats& stats) {
-        if (stats.currentStep == 0) {
-            reset();
-            stats.reset();
+    template <typename Key, typename Compare>
+    void BasicMergeSort<Key, Compare>::step(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        if (stats.sortingComplete || !stats.isSorting) {
+            return;
         }
 
-        stats.isSorting = true;
+        int n = data.size();
 
-        mergeSort(data, stats, 0, data.size() - 1);
+        // The left run of the widest pass is the largest thing the buffer ever holds
+        if (stats.currentStep == 0 || buffer.empty()) {
+            int largestWidth = 1;
+            while (largestWidth * 2 < n) {
+                largestWidth *= 2;
+            }
+            buffer.assign(largestWidth, Key());
+        }
+        stats.setScratch(&buffer);
 
-        data.resetHighlighting();
-        stats.sortingComplete = true;
-        stats.isSorting = false;
-    }
+        if (stats.stateRestored) {
+            i = stats.lastRestoredI;
+            j = stats.lastRestoredJ;
+            merging = stats.lastRestoredSwapped;
+            width = stats.lastRestoredK;
+            // The pair is found again from the position alone, which is all an undo record keeps
+            left = i - i % (2 * width);
+            stats.stateRestored = false;
+        }
+        else {
+            data.resetHighlighting();
+        }
 
-    void MergeSort::mergeSort(Visualization::VisualizationData& data, SortingStats& stats, int left, int right) {
-        if (!stats.isSorting || left >= right) return;
+        stats.saveState(i, j, merging, width);
 
-        int mid = left + (right - left) / 2;
+        if (width >= n) {
+            data.markedLow = -1;
+            data.markedHigh = -1;
+            stats.sortingComplete = true;
+            stats.isSorting = false;
+            data.resetHighlighting();
+            return;
+        }
 
-        mergeSort(data, stats, left, mid);
-        if (!stats.isSorting) return;
+        int mid = left + width;
+        int right = std::min(left + 2 * width, n);
 
-        mergeSort(data, stats, mid + 1, right);
-        if (!stats.isSorting) return;
+        if (merging) {
+            stepMerge(data, stats, mid, right);
+        }
+        else {
+            startPair(data, stats, mid, right);
+        }
 
-        merge(data, stats, left, mid, right);
+        if (stats.steppingMode) {
+            stats.isSorting = false;
+        }
     }
 
-    void MergeSort::merge(Visualization::VisualizationData& data, SortingStats& stats, int left, int mid, int right) {
-        auto& array = data.getArray();
-        std::vector<Visualization::ArrayElement> temp;
+    template <typename Key, typename Compare>
+    void BasicMergeSort<Key, Compare>::startPair(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, int mid, int right) {
+        auto& array = data.getValues();
 
-        int i = left, j = mid + 1;
+        data.markedLow = left;
+        data.markedHigh = right - 1;
+        stats.recordRange(left, right - 1);
 
-        while (i <= mid && j <= right && stats.isSorting) {
-            data.resetHighlighting();
+        data.setComparing(mid - 1);
+        data.setComparing(mid);
+        stats.recordCompare(mid - 1, mid);
+        stats.comparisons++;
+        stats.currentStep++;
+
+        // Runs that already follow each other in order need no merge
+        if (!this->compare(array[mid], array[mid - 1])) {
+            nextPair(data.size(), right);
+            return;
+        }
+
+        for (int k = left; k < mid; k++) {
+            Key& slot = buffer[k - left];
+            stats.recordScratchWrite(k - left, slot, array[k]);
+            slot = array[k];
+        }
+        merging = true;
+    }
+
+    template <typename Key, typename Compare>
+    void BasicMergeSort<Key, Compare>::stepMerge(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, int mid, int right) {
+        auto& array = data.getValues();
+        int output = i + (j - mid);
+        stats.currentStep++;
 
-            array[i].isComparing = true;
-            array[j].isComparing = true;
+        if (j < right) {
+            // One comparison and one write per step
+            const Key& candidate = buffer[i - left];
+            data.setComparing(j);
+            stats.recordCompare(output, j);
             stats.comparisons++;
 
-            if (array[i].value <= array[j].value) {
-                temp.push_back(array[i++]);
+            Key value;
+            if (!this->compare(array[j], candidate)) {
+                value = candidate;
+                i++;
             }
             else {
-                temp.push_back(array[j++]);
+                value = array[j];
+                j++;
+            }
+
+            if (!(array[output] == value)) {
+                data.setSwapping(output);
+                stats.swaps++;
+                stats.writes++;
+                stats.recordWrite(output, array[output], value);
+                data.set(output, value);
+            }
+        }
+        else {
+            // The right run is used up, the rest of the left run goes to the end in one step
+            for (; i < mid; i++, output++) {
+                const Key& value = buffer[i - left];
+                if (!(array[output] == value)) {
+                    data.setSwapping(output);
+                    stats.swaps++;
+                    stats.writes++;
+                    stats.recordWrite(output, array[output], value);
+                    data.set(output, value);
+                }
             }
+        }
 
-            stats.currentStep++;
-            std::this_thread::sleep_for(std::chrono::milliseconds(stats.speedFactor));
+        // Once the left run is used up the rest of the right run is already in place
+        if (i == mid) {
+            merging = false;
+            nextPair(data.size(), right);
         }
+    }
 
-        while (i <= mid && stats.isSorting) {
-            temp.push_back(array[i++]);
+    template <typename Key, typename Compare>
+    void BasicMergeSort<Key, Compare>::nextPair(int n, int right) {
+        // Skip a trailing run without a partner; it is merged by a later, wider pass
+        if (right + width < n) {
+            left = right;
+            i = right;
+            j = right + width;
+            return;
         }
 
-        while (j <= right && stats.isSorting) {
-            temp.push_back(array[j++]);
+        width *= 2;
+        left = 0;
+        i = 0;
+        j = width;
+    }
+
+    template <typename Key, typename Compare>
+    void BasicMergeSort<Key, Compare>::runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation) {
+        this->runKernel(data, stats, instrumentation, [&](auto policy) {
+            sortAll<decltype(policy)>(data, stats);
+        });
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicMergeSort<Key, Compare>::sortAll(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        auto& array = data.getValues();
+        int n = array.size();
+        Probe<Policy, Key> probe(data);
+
+        int largestWidth = 1;
+        while (largestWidth * 2 < n) {
+            largestWidth *= 2;
         }
+        buffer.resize(largestWidth);
 
-        stats.currentStep++;
-     
-        for (int k = 0; k < temp.size(); ++k) {
-            if (array[left + k].value != temp[k].value) {
-                array[left + k].isSwapping = true;
-                stats.swaps++;
+        // A stop request is honoured between passes, when the array is a whole permutation
+        for (int runWidth = 1; runWidth < n && stats.isSorting; runWidth *= 2) {
+            for (int first = 0; first + runWidth < n; first += 2 * runWidth) {
+                int mid = first + runWidth;
+                int last = std::min(first + 2 * runWidth, n);
+                probe.mark(first, last - 1);
+                probe.compare(mid - 1, mid);
+                probe.step();
+
+                // Runs that already follow each other in order need no merge
+                if (!this->compare(array[mid], array[mid - 1])) {
+                    continue;
+                }
+
+                std::copy(array.begin() + first, array.begin() + mid, buffer.begin());
+                int a = 0;
+                int b = mid;
+                int output = first;
+                while (a < runWidth && b < last) {
+                    probe.compare(output, b);
+                    // Taking from the left run on ties keeps the sort stable
+                    if (!this->compare(array[b], buffer[a])) {
+                        array[output] = buffer[a++];
+                    }
+                    else {
+                        array[output] = array[b++];
+                    }
+                    probe.write(output);
+                    probe.step();
+                    output++;
+                }
+
+                // Once the left run is used up the rest of the right run is already in place
+                for (; a < runWidth; a++, output++) {
+                    array[output] = buffer[a];
+                    probe.write(output);
+                }
             }
-            array[left + k] = temp[k];
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(stats.speedFactor));
+        probe.flush(stats);
     }
 
+    template <typename Key, typename Compare>
+    void BasicMergeSort<Key, Compare>::run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        if (stats.currentStep == 0) {
+            reset();
+            stats.reset();
+        }
+
+        stats.isSorting = true;
+
+        if (stats.steppingMode) {
+            step(data, stats);
+            return;
+        }
+
+        while (stats.isSorting && !stats.sortingComplete) {
+            step(data, stats);
+            this->pace(stats);
+        }
+
+        data.resetHighlighting();
+        if (stats.isSorting) {
+            stats.sortingComplete = true;
+            stats.isSorting = false;
+        }
+    }
+
+#define INSTANTIATE(Key) template class BasicMergeSort<Key>;
+    FOR_EACH_KEY_TYPE(INSTANTIATE)
+#undef INSTANTIATE
+
 }
@@ -1,21 +1,45 @@
 #pragma once
 #include "Algorithm.h"
+#include <vector>
 
 namespace Algorithms {
 
-    class MergeSort : public Algorithm {
+    // Bottom-up MergeSort. Each pass merges neighbouring runs of the current width in
+    // place: the left run is copied into one buffer allocated per sort, then merged back
+    // with the right run. Pairs that are already in order are skipped with one comparison.
+    template <typename Key, typename Compare = typename Utils::KeyTraits<Key>::Compare>
+    class BasicMergeSort : public BasicAlgorithm<Key, Compare> {
     public:
-        MergeSort();
+        BasicMergeSort();
 
-        void step(Visualization::VisualizationData&, SortingStats&) override {} // brak trybu krokowego
-        void run(Visualization::VisualizationData& data, SortingStats& stats) override;
+        void step(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) override;
+        void run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) override;
+        void runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation) override;
+        bool supportsInstrumentation() const override { return true; }
         bool isComplete(const SortingStats& stats) const override;
         void reset() override;
 
     private:
-        void mergeSort(Visualization::VisualizationData& data, SortingStats& stats, int left, int right);
-        void merge(Visualization::VisualizationData& data, SortingStats& stats, int left, int mid, int right);
-        bool completed = false;
+        // Width of the runs merged by the current pass and start of the current pair
+        int width = 1;
+        int left = 0;
+        // Next unread element of the left run (array index) and of the right run
+        int i = 0;
+        int j = 1;
+        // Whether the current pair has been copied out and is being merged
+        bool merging = false;
+        // Left run of the current pair, indexed from the start of the pair
+        std::vector<Key> buffer;
+
+        void startPair(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, int mid, int right);
+        void stepMerge(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, int mid, int right);
+        void nextPair(int n, int right);
+
+        // The passes of step() in plain loops; the policy decides what they report
+        template <typename Policy>
+        void sortAll(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
     };
 
+    using MergeSort = BasicMergeSort<int>;
+
 }
@@ -0,0 +1,223 @@
+#include "NumberLoader.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <charconv>
+#include <climits>
+
+namespace Utils {
+
+    namespace {
+        // Bytes per chunk; large enough that finding the boundaries and scheduling cost nothing
+        constexpr size_t CHUNK_BYTES = size_t(4) << 20;
+        // Longest piece of a bad token quoted in its error message
+        constexpr size_t MAX_QUOTED = 32;
+
+        // One table lookup per byte instead of a chain of comparisons
+        struct DelimiterTable {
+            bool delimiter[256] = {};
+
+            constexpr DelimiterTable() {
+                for (unsigned char c : { ',', ' ', '\n', '\r', '\t' }) {
+                    delimiter[c] = true;
+                }
+            }
+        };
+        constexpr DelimiterTable DELIMITERS;
+
+        bool isDelimiter(char c) {
+            return DELIMITERS.delimiter[static_cast<unsigned char>(c)];
+        }
+
+        // Chunk k begins at the first token start at or after k * CHUNK_BYTES, so every token belongs
+        // to the chunk it starts in and no chunk needs to look at its neighbours
+        size_t getChunkBegin(const char* text, size_t size, size_t chunk) {
+            if (chunk == 0) {
+                return 0;
+            }
+            size_t position = std::min(chunk * CHUNK_BYTES, size);
+            while (position < size && !isDelimiter(text[position - 1])) {
+                position++;
+            }
+            return position;
+        }
+
+        // Calls onToken(begin, end) for every token starting in [begin, end)
+        template <typename OnToken>
+        void forEachToken(const char* text, size_t begin, size_t end, const OnToken& onToken) {
+            size_t position = begin;
+            while (true) {
+                while (position < end && isDelimiter(text[position])) {
+                    position++;
+                }
+                if (position >= end) {
+                    return;
+                }
+                size_t tokenBegin = position;
+                while (position < end && !isDelimiter(text[position])) {
+                    position++;
+                }
+                onToken(tokenBegin, position);
+            }
+        }
+
+        // Runs body(chunk, begin, end) over every chunk on the calling thread and idle pool threads
+        template <typename Body>
+        void forEachChunk(const std::vector<size_t>& bounds, const Body& body) {
+            size_t chunkCount = bounds.size() - 1;
+            auto& scheduler = Algorithms::Scheduler::getDefault();
+            int members = static_cast<int>(std::min<size_t>(chunkCount, scheduler.getThreadCount()));
+
+            std::atomic<size_t> nextChunk{ 0 };
+            scheduler.runTeam(members, [&](int) {
+                for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++) {
+                    body(chunk, bounds[chunk], bounds[chunk + 1]);
+                }
+            });
+        }
+    }
+
+    NumberLoader::NumberLoader() : scheduler(Algorithms::Scheduler::getDefault()) {}
+
+    NumberLoader::~NumberLoader() {
+        cancel();
+        scheduler.remove(*this);
+    }
+
+    bool NumberLoader::start(const std::string& path) {
+        if (isLoading()) {
+            return false;
+        }
+        this->path = path;
+        result = LoadResult();
+        progress = 0;
+        total = 0;
+        cancelled = false;
+        state.store(State::Loading, std::memory_order_release);
+        scheduler.notify(*this);
+        return true;
+    }
+
+    void NumberLoader::cancel() {
+        cancelled = true;
+    }
+
+    float NumberLoader::getProgress() const {
+        size_t bytes = total.load(std::memory_order_relaxed);
+        return bytes > 0 ? static_cast<float>(static_cast<double>(progress.load(std::memory_order_relaxed)) / bytes) : 0.0f;
+    }
+
+    void NumberLoader::clear() {
+        if (isFinished()) {
+            result = LoadResult();
+            state.store(State::Idle, std::memory_order_release);
+        }
+    }
+
+    bool NumberLoader::runSlice(Algorithms::Scheduler::Clock::time_point&) {
+        // Blocks this pool thread for the whole load, as a non-steppable algorithm's run does
+        LoadResult loaded;
+        MappedFile file;
+        if (!file.open(path)) {
+            loaded.failure = "could not open '" + path + "', please check the path";
+        }
+        else {
+            total = 2 * file.size();
+            parse(file.data(), file.size(), loaded, &progress, &cancelled);
+        }
+
+        result = std::move(loaded);
+        state.store(State::Finished, std::memory_order_release);
+        return false;
+    }
+
+    void NumberLoader::parse(const char* text, size_t size, LoadResult& result,
+        std::atomic<size_t>* progress, const std::atomic<bool>* cancelled) {
+        result = LoadResult();
+
+        size_t chunkCount = std::max<size_t>((size + CHUNK_BYTES - 1) / CHUNK_BYTES, 1);
+        std::vector<size_t> bounds(chunkCount + 1);
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            bounds[chunk] = getChunkBegin(text, size, chunk);
+        }
+        bounds[chunkCount] = size;
+
+        auto isCancelled = [cancelled]() { return cancelled != nullptr && cancelled->load(std::memory_order_relaxed); };
+        auto advance = [progress](size_t bytes) {
+            if (progress != nullptr) {
+                progress->fetch_add(bytes, std::memory_order_relaxed);
+            }
+        };
+
+        // First pass: tokens per chunk, which give every chunk its first index in the array
+        std::vector<size_t> offsets(chunkCount + 1, 0);
+        forEachChunk(bounds, [&](size_t chunk, size_t begin, size_t end) {
+            if (isCancelled()) {
+                return;
+            }
+            size_t count = 0;
+            forEachToken(text, begin, end, [&count](size_t, size_t) { count++; });
+            offsets[chunk + 1] = count;
+            advance(end - begin);
+        });
+        if (isCancelled()) {
+            result.failure = "cancelled";
+            result.cancelled = true;
+            return;
+        }
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            offsets[chunk + 1] += offsets[chunk];
+        }
+        if (offsets[chunkCount] > static_cast<size_t>(INT_MAX)) {
+            result.failure = "more than " + std::to_string(INT_MAX) + " values";
+            return;
+        }
+        result.values.resize(offsets[chunkCount]);
+
+        // Second pass: parse each chunk into its slice of the array. Errors are kept per chunk,
+        // so joining them in chunk order leaves them sorted by offset.
+        std::vector<std::vector<ParseError>> chunkErrors(chunkCount);
+        std::vector<size_t> chunkErrorCounts(chunkCount, 0);
+        int* values = result.values.data();
+        forEachChunk(bounds, [&](size_t chunk, size_t begin, size_t end) {
+            if (isCancelled()) {
+                return;
+            }
+            size_t index = offsets[chunk];
+            forEachToken(text, begin, end, [&](size_t tokenBegin, size_t tokenEnd) {
+                const char* first = text + tokenBegin;
+                const char* last = text + tokenEnd;
+                // from_chars takes no plus sign
+                if (*first == '+' && last - first > 1 && first[1] != '-') {
+                    first++;
+                }
+                auto [position, error] = std::from_chars(first, last, values[index]);
+                if (error != std::errc() || position != last) {
+                    if (chunkErrors[chunk].size() < MAX_REPORTED_ERRORS) {
+                        std::string token(text + tokenBegin, std::min(tokenEnd - tokenBegin, MAX_QUOTED));
+                        std::string reason = error == std::errc::result_out_of_range ? "Out of range" : "Not an integer";
+                        chunkErrors[chunk].push_back({ tokenBegin, reason + ": '" + token + "'" });
+                    }
+                    chunkErrorCounts[chunk]++;
+                }
+                index++;
+            });
+            advance(end - begin);
+        });
+        if (isCancelled()) {
+            result.values.clear();
+            result.failure = "cancelled";
+            result.cancelled = true;
+            return;
+        }
+
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            result.errorCount += chunkErrorCounts[chunk];
+            for (auto& error : chunkErrors[chunk]) {
+                if (result.errors.size() < MAX_REPORTED_ERRORS) {
+                    result.errors.push_back(std::move(error));
+                }
+            }
+        }
+    }
+
+}
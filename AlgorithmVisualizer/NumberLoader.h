@@ -0,0 +1,77 @@
+#pragma once
+#include "Scheduler.h"
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Utils {
+
+    // A token that is not an integer, at its byte offset in the input
+    struct ParseError {
+        size_t offset = 0;
+        std::string message;
+    };
+
+    struct LoadResult {
+        std::vector<int> values;
+        // The first MAX_REPORTED_ERRORS parse errors in file order, out of errorCount
+        std::vector<ParseError> errors;
+        size_t errorCount = 0;
+        // Set when the input could not be read at all, or the load was cancelled
+        std::string failure;
+        bool cancelled = false;
+
+        bool succeeded() const { return failure.empty() && errorCount == 0; }
+    };
+
+    // Loads integers separated by commas, spaces, tabs or line breaks from a text file, off the UI
+    // thread. The file is memory-mapped and cut into chunks at delimiters; one parallel pass counts
+    // each chunk's tokens so the array is allocated once at its final size, and a second parses them
+    // with std::from_chars straight into place. Any bad token fails the whole load.
+    class NumberLoader : public Algorithms::Scheduler::Job {
+    public:
+        static constexpr size_t MAX_REPORTED_ERRORS = 16;
+
+        NumberLoader();
+        // Cancels a load in progress and waits for it to stop
+        ~NumberLoader() override;
+
+        NumberLoader(const NumberLoader&) = delete;
+        NumberLoader& operator=(const NumberLoader&) = delete;
+
+        // UI thread only. Starts loading the file on the shared scheduler; false while a load is running.
+        bool start(const std::string& path);
+        void cancel();
+
+        bool isLoading() const { return state.load(std::memory_order_acquire) == State::Loading; }
+        bool isFinished() const { return state.load(std::memory_order_acquire) == State::Finished; }
+        // Fraction of the two passes done so far
+        float getProgress() const;
+
+        // Once finished the result belongs to the UI thread; clear() hands the loader back for the next start
+        LoadResult& getResult() { return result; }
+        void clear();
+
+        // Parses text of the given size on the calling thread and idle pool threads. progress, when set,
+        // advances by twice the size in total; the parse stops early once cancelled is set.
+        static void parse(const char* text, size_t size, LoadResult& result,
+            std::atomic<size_t>* progress = nullptr, const std::atomic<bool>* cancelled = nullptr);
+
+    protected:
+        bool runSlice(Algorithms::Scheduler::Clock::time_point& due) override;
+
+    private:
+        enum class State : int { Idle, Loading, Finished };
+
+        Algorithms::Scheduler& scheduler;
+        std::atomic<State> state{ State::Idle };
+        std::atomic<bool> cancelled{ false };
+        std::atomic<size_t> progress{ 0 };
+        std::atomic<size_t> total{ 0 };
+        // Written by the UI thread before the load starts, read by the loading thread
+        std::string path;
+        LoadResult result;
+    };
+
+}
@@ -0,0 +1,267 @@
+#include "OperationTrace.h"
+
+namespace Algorithms {
+
+    namespace {
+        // Tag byte layout: low 3 bits hold the event type, the upper 5 bits a short payload
+        constexpr uint8_t TYPE_MASK = 0x07;
+        constexpr uint8_t SHORT_PAIR = 0x08;
+        constexpr int EXTENDED_COUNT = 3;
+
+        uint64_t zigzag(long long value) {
+            return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        }
+
+        long long unzigzag(uint64_t value) {
+            return static_cast<long long>(value >> 1) ^ -static_cast<long long>(value & 1);
+        }
+    }
+
+    void OperationTrace::clear() {
+        bytes.clear();
+        blocks.clear();
+        stepCount = 0;
+        lastComparisons = 0;
+        lastSwaps = 0;
+        finalComparisons = 0;
+        finalSwaps = 0;
+        rangeLow = -1;
+        rangeHigh = -1;
+        previousFirst = 0;
+        previousSecond = 0;
+    }
+
+    size_t OperationTrace::getMemoryUsage() const {
+        return bytes.capacity() + blocks.capacity() * sizeof(Block);
+    }
+
+    void OperationTrace::writeVarint(uint64_t value) {
+        while (value >= 0x80) {
+            bytes.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    void OperationTrace::beginStep(long long comparisons, long long swaps) {
+        if (stepCount % STEPS_PER_BLOCK == 0) {
+            blocks.push_back({ bytes.size(), comparisons, swaps, rangeLow, rangeHigh });
+            previousFirst = 0;
+            previousSecond = 0;
+        }
+
+        // Counter deltas of the previous step, inline when they are small
+        long long deltaComparisons = comparisons - lastComparisons;
+        long long deltaSwaps = swaps - lastSwaps;
+        int inlineComparisons = deltaComparisons >= 0 && deltaComparisons < EXTENDED_COUNT ? static_cast<int>(deltaComparisons) : EXTENDED_COUNT;
+        int inlineSwaps = deltaSwaps >= 0 && deltaSwaps < EXTENDED_COUNT ? static_cast<int>(deltaSwaps) : EXTENDED_COUNT;
+
+        bytes.push_back(static_cast<uint8_t>(static_cast<uint8_t>(EventType::Step) | (inlineComparisons << 3) | (inlineSwaps << 5)));
+        if (inlineComparisons == EXTENDED_COUNT) {
+            writeVarint(zigzag(deltaComparisons));
+        }
+        if (inlineSwaps == EXTENDED_COUNT) {
+            writeVarint(zigzag(deltaSwaps));
+        }
+
+        lastComparisons = comparisons;
+        lastSwaps = swaps;
+        stepCount++;
+    }
+
+    void OperationTrace::writePair(EventType type, int first, int second) {
+        if (stepCount == 0) {
+            return;
+        }
+
+        long long deltaFirst = static_cast<long long>(first) - previousFirst;
+        long long deltaSecond = static_cast<long long>(second) - previousSecond;
+        previousFirst = first;
+        previousSecond = second;
+
+        // Neighbouring indices (delta -1, 0 or +1) fit in the tag byte
+        if (deltaFirst >= -1 && deltaFirst <= 1 && deltaSecond >= -1 && deltaSecond <= 1) {
+            bytes.push_back(static_cast<uint8_t>(static_cast<uint8_t>(type) | SHORT_PAIR |
+                ((deltaFirst + 1) << 4) | ((deltaSecond + 1) << 6)));
+            return;
+        }
+
+        bytes.push_back(static_cast<uint8_t>(type));
+        writeVarint(zigzag(deltaFirst));
+        writeVarint(zigzag(deltaSecond));
+    }
+
+    void OperationTrace::compare(int first, int second) {
+        writePair(EventType::Compare, first, second);
+    }
+
+    void OperationTrace::swap(int first, int second) {
+        writePair(EventType::Swap, first, second);
+    }
+
+    void OperationTrace::write(int index, int oldValue, int newValue) {
+        if (stepCount == 0) {
+            return;
+        }
+
+        bytes.push_back(static_cast<uint8_t>(EventType::Write));
+        writeVarint(zigzag(static_cast<long long>(index) - previousFirst));
+        writeVarint(zigzag(oldValue));
+        writeVarint(zigzag(newValue));
+        previousFirst = index;
+    }
+
+    void OperationTrace::range(int low, int high) {
+        if (stepCount == 0) {
+            return;
+        }
+
+        bytes.push_back(static_cast<uint8_t>(EventType::Range));
+        writeVarint(zigzag(low));
+        writeVarint(zigzag(high));
+        rangeLow = low;
+        rangeHigh = high;
+    }
+
+    void OperationTrace::finish(long long comparisons, long long swaps) {
+        finalComparisons = comparisons;
+        finalSwaps = swaps;
+        bytes.shrink_to_fit();
+        blocks.shrink_to_fit();
+    }
+
+    void OperationTrace::getCountersAt(size_t step, long long& comparisons, long long& swaps) const {
+        if (step >= stepCount) {
+            comparisons = finalComparisons;
+            swaps = finalSwaps;
+            return;
+        }
+
+        const Block& block = blocks[step / STEPS_PER_BLOCK];
+        comparisons = block.comparisons;
+        swaps = block.swaps;
+
+        // Step headers after the first one in the block carry the deltas
+        size_t blockStart = step - step % STEPS_PER_BLOCK;
+        Reader reader(*this, blockStart);
+        Event event;
+        while (reader.next(event)) {
+            if (event.type != EventType::Step) {
+                continue;
+            }
+            if (reader.getStep() > blockStart) {
+                comparisons += event.comparisons;
+                swaps += event.swaps;
+            }
+            if (reader.getStep() == step) {
+                break;
+            }
+        }
+    }
+
+    void OperationTrace::getRangeAt(size_t step, int& low, int& high) const {
+        if (blocks.empty()) {
+            low = high = -1;
+            return;
+        }
+
+        size_t blockIndex = step >= stepCount ? blocks.size() - 1 : step / STEPS_PER_BLOCK;
+        const Block& block = blocks[blockIndex];
+        low = block.rangeLow;
+        high = block.rangeHigh;
+
+        Reader reader(*this, blockIndex * STEPS_PER_BLOCK);
+        Event event;
+        while (reader.next(event)) {
+            if (event.type == EventType::Step && reader.getStep() == step) {
+                break;
+            }
+            if (event.type == EventType::Range) {
+                low = event.first;
+                high = event.second;
+            }
+        }
+    }
+
+    OperationTrace::Reader::Reader(const OperationTrace& trace, size_t target) : trace(trace), offset(0), step(0) {
+        if (target >= trace.stepCount) {
+            offset = trace.bytes.size();
+            step = trace.stepCount;
+            return;
+        }
+
+        offset = trace.blocks[target / STEPS_PER_BLOCK].offset;
+        step = target - target % STEPS_PER_BLOCK;
+
+        // Skip the earlier steps of the block so the target step header is read next
+        Event event;
+        while (offset < trace.bytes.size() &&
+            (step < target || static_cast<EventType>(trace.bytes[offset] & TYPE_MASK) != EventType::Step)) {
+            next(event);
+        }
+    }
+
+    uint64_t OperationTrace::Reader::readVarint() {
+        uint64_t value = 0;
+        int shift = 0;
+        while (true) {
+            uint8_t byte = trace.bytes[offset++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+            shift += 7;
+        }
+    }
+
+    bool OperationTrace::Reader::next(Event& event) {
+        if (offset >= trace.bytes.size()) {
+            return false;
+        }
+
+        uint8_t tag = trace.bytes[offset++];
+        event.type = static_cast<EventType>(tag & TYPE_MASK);
+
+        switch (event.type) {
+        case EventType::Step: {
+            int inlineComparisons = (tag >> 3) & 0x03;
+            int inlineSwaps = (tag >> 5) & 0x03;
+            event.comparisons = inlineComparisons == EXTENDED_COUNT ? unzigzag(readVarint()) : inlineComparisons;
+            event.swaps = inlineSwaps == EXTENDED_COUNT ? unzigzag(readVarint()) : inlineSwaps;
+            // Delta coding restarts with every block
+            if (step % STEPS_PER_BLOCK == 0) {
+                previousFirst = 0;
+                previousSecond = 0;
+            }
+            step++;
+            break;
+        }
+        case EventType::Compare:
+        case EventType::Swap:
+            if (tag & SHORT_PAIR) {
+                event.first = previousFirst + ((tag >> 4) & 0x03) - 1;
+                event.second = previousSecond + ((tag >> 6) & 0x03) - 1;
+            }
+            else {
+                event.first = static_cast<int>(previousFirst + unzigzag(readVarint()));
+                event.second = static_cast<int>(previousSecond + unzigzag(readVarint()));
+            }
+            previousFirst = event.first;
+            previousSecond = event.second;
+            break;
+        case EventType::Write:
+            event.first = static_cast<int>(previousFirst + unzigzag(readVarint()));
+            event.oldValue = static_cast<int>(unzigzag(readVarint()));
+            event.newValue = static_cast<int>(unzigzag(readVarint()));
+            previousFirst = event.first;
+            break;
+        case EventType::Range:
+            event.first = static_cast<int>(unzigzag(readVarint()));
+            event.second = static_cast<int>(unzigzag(readVarint()));
+            break;
+        }
+
+        return true;
+    }
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Algorithms {
+
+    // Compact binary stream of everything an algorithm did, step by step.
+    // Each event is a tag byte followed by zigzag varints; indices are delta coded
+    // against the previous event, so the common +-1 moves fit in the tag byte alone.
+    // Delta state resets every STEPS_PER_BLOCK steps so decoding can start at any block.
+    class OperationTrace {
+    public:
+        enum class EventType : unsigned char { Step, Compare, Swap, Write, Range };
+
+        struct Event {
+            EventType type = EventType::Step;
+            int first = 0;    // Compare/Swap: first index, Write: index, Range: low
+            int second = 0;   // Compare/Swap: second index, Range: high
+            int oldValue = 0; // Write: value before the write
+            int newValue = 0; // Write: value after the write
+            long long comparisons = 0; // Step: comparisons made by the previous step
+            long long swaps = 0;       // Step: swaps made by the previous step
+        };
+
+        static constexpr size_t STEPS_PER_BLOCK = 64;
+
+        // Sequential decoder positioned at the start of a step
+        class Reader {
+        public:
+            Reader(const OperationTrace& trace, size_t step);
+
+            // Returns false at the end of the trace
+            bool next(Event& event);
+
+            // Step whose header was read last
+            size_t getStep() const { return step - 1; }
+
+        private:
+            const OperationTrace& trace;
+            size_t offset;
+            size_t step; // Steps whose header has been read
+            int previousFirst = 0;
+            int previousSecond = 0;
+
+            uint64_t readVarint();
+        };
+
+        void clear();
+
+        // Recording
+        void beginStep(long long comparisons, long long swaps);
+        void compare(int first, int second);
+        void swap(int first, int second);
+        void write(int index, int oldValue, int newValue);
+        void range(int low, int high);
+        void finish(long long comparisons, long long swaps);
+
+        size_t getStepCount() const { return stepCount; }
+        size_t getByteSize() const { return bytes.size(); }
+        size_t getMemoryUsage() const;
+
+        // Counters and active range at the start of a step
+        void getCountersAt(size_t step, long long& comparisons, long long& swaps) const;
+        void getRangeAt(size_t step, int& low, int& high) const;
+
+    private:
+        struct Block {
+            size_t offset;
+            long long comparisons;
+            long long swaps;
+            int rangeLow;
+            int rangeHigh;
+        };
+
+        std::vector<uint8_t> bytes;
+        std::vector<Block> blocks;
+        size_t stepCount = 0;
+
+        long long lastComparisons = 0;
+        long long lastSwaps = 0;
+        long long finalComparisons = 0;
+        long long finalSwaps = 0;
+        int rangeLow = -1;
+        int rangeHigh = -1;
+        int previousFirst = 0;
+        int previousSecond = 0;
+
+        void writeVarint(uint64_t value);
+        void writePair(EventType type, int first, int second);
+    };
+
+}
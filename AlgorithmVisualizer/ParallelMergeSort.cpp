@@ -0,0 +1,270 @@
+#include "ParallelMergeSort.h"
+#include "Scheduler.h"
+#include "SortingNetwork.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace Algorithms {
+
+    template <typename Key, typename Compare>
+    BasicParallelMergeSort<Key, Compare>::BasicParallelMergeSort(int workerCount) : BasicAlgorithm<Key, Compare>("Parallel Merge Sort"), workerCount(workerCount) {
+        if (this->workerCount <= 0) {
+            this->workerCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        reset();
+    }
+
+    template <typename Key, typename Compare>
+    void BasicParallelMergeSort<Key, Compare>::reset() {
+        buffer.clear();
+        buffer.shrink_to_fit();
+        nextTask = 0;
+    }
+
+    template <typename Key, typename Compare>
+    bool BasicParallelMergeSort<Key, Compare>::isComplete(const SortingStats& stats) const {
+        return stats.sortingComplete;
+    }
+
+    template <typename Key, typename Compare>
+    void BasicParallelMergeSort<Key, Compare>::run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        runInstrumented(data, stats, Instrumentation::Visual);
+    }
+
+    template <typename Key, typename Compare>
+    void BasicParallelMergeSort<Key, Compare>::runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation) {
+        this->runKernel(data, stats, instrumentation, [&](auto policy) {
+            sortAll<decltype(policy)>(data, stats);
+        });
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicParallelMergeSort<Key, Compare>::sortAll(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        if constexpr (Policy::counts) {
+            stats.workers.assign(workerCount, WorkerStats());
+        }
+        if constexpr (Policy::highlights) {
+            data.clearGroups();
+        }
+
+        std::vector<Key>& array = data.getValues();
+        int n = data.size();
+
+        if (n > 1) {
+            buffer.resize(n);
+
+            // Leaves of the recursion tree: one chunk per worker, sorted sequentially
+            int chunkCount = std::clamp((n + MIN_SEGMENT - 1) / MIN_SEGMENT, 1, workerCount);
+            std::vector<int> bounds(chunkCount + 1);
+            for (int k = 0; k <= chunkCount; k++) {
+                bounds[k] = static_cast<int>(static_cast<long long>(n) * k / chunkCount);
+            }
+            parallelFor<Policy>(chunkCount, stats, [&](int id, int k) {
+                Counter<Policy::counts> comparisons;
+                Counter<Policy::counts> moves;
+                if constexpr (Policy::highlights) {
+                    data.setGroup(bounds[k], bounds[k + 1] - 1, static_cast<uint8_t>(id + 1));
+                }
+                sortChunk<Policy>(array, bounds[k], bounds[k + 1], comparisons, moves);
+                if constexpr (Policy::counts) {
+                    WorkerStats& counters = stats.workers[id];
+                    counters.comparisons += comparisons.value;
+                    counters.swaps += moves.value;
+                    counters.writes += moves.value;
+                    counters.tasks++;
+                }
+                if constexpr (Policy::highlights) {
+                    data.markDirty(bounds[k], bounds[k + 1] - 1);
+                    this->pace(stats, pacer);
+                }
+            });
+
+            // Inner levels: merge pairs of runs, ping-ponging between the array and the buffer.
+            // A stop request is honoured between passes, when the source is a whole permutation.
+            std::vector<Key>* source = &array;
+            std::vector<Key>* destination = &buffer;
+            int segmentSize = std::max(MIN_SEGMENT, (n + workerCount - 1) / workerCount);
+            std::vector<Segment> segments;
+            std::vector<int> merged;
+
+            while (bounds.size() > 2 && stats.isSorting) {
+                segments.clear();
+                merged.clear();
+                for (size_t run = 0; run + 1 < bounds.size(); run += 2) {
+                    int last = run + 2 < bounds.size() ? bounds[run + 2] : bounds[run + 1];
+                    splitMerge(*source, bounds[run], bounds[run + 1], last, segmentSize, segments);
+                    merged.push_back(bounds[run]);
+                }
+                merged.push_back(n);
+                bounds.swap(merged);
+
+                parallelFor<Policy>(static_cast<int>(segments.size()), stats, [&](int id, int k) {
+                    const Segment& segment = segments[k];
+                    int length = (segment.lastA - segment.firstA) + (segment.lastB - segment.firstB);
+                    Counter<Policy::counts> comparisons;
+                    if constexpr (Policy::highlights) {
+                        data.setGroup(segment.output, segment.output + length - 1, static_cast<uint8_t>(id + 1));
+                    }
+                    mergeInto<Policy>(source->data(), segment.firstA, segment.lastA, segment.firstB, segment.lastB,
+                        destination->data() + segment.output, comparisons);
+                    if constexpr (Policy::counts) {
+                        WorkerStats& counters = stats.workers[id];
+                        counters.comparisons += comparisons.value;
+                        counters.swaps += length;
+                        counters.writes += length;
+                        counters.tasks++;
+                    }
+                    if constexpr (Policy::highlights) {
+                        this->pace(stats, pacer);
+                    }
+                });
+                std::swap(source, destination);
+            }
+
+            if (source != &array) {
+                std::copy(buffer.begin(), buffer.end(), array.begin());
+                data.markAllDirty();
+            }
+        }
+
+        for (const auto& worker : stats.workers) {
+            stats.comparisons += worker.comparisons;
+            stats.swaps += worker.swaps;
+            stats.writes += worker.writes;
+            stats.currentStep += worker.tasks;
+        }
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicParallelMergeSort<Key, Compare>::parallelFor(int taskCount, SortingStats& stats, const std::function<void(int, int)>& task) {
+        int activeWorkers = std::min(workerCount, taskCount);
+        nextTask = 0;
+
+        if constexpr (!Policy::counts) {
+            Scheduler::getDefault().runTeam(activeWorkers, [&](int id) {
+                pacer.enter();
+                for (int k = nextTask++; k < taskCount; k = nextTask++) {
+                    task(id, k);
+                }
+                pacer.leave();
+            });
+            return;
+        }
+
+        using Clock = std::chrono::steady_clock;
+        auto start = Clock::now();
+        std::vector<Clock::time_point> finished(workerCount, start);
+
+        auto body = [&](int id) {
+            pacer.enter();
+            for (int k = nextTask++; k < taskCount; k = nextTask++) {
+                task(id, k);
+            }
+            pacer.leave();
+            finished[id] = Clock::now();
+        };
+
+        // The calling thread is worker 0 and idle pool threads join as the others; whoever runs takes the next task
+        Scheduler::getDefault().runTeam(activeWorkers, body);
+
+        // Time spent waiting for the slowest worker of the pass counts as idle
+        auto end = Clock::now();
+        for (int id = 0; id < workerCount; id++) {
+            stats.workers[id].idleSeconds += std::chrono::duration<double>(end - finished[id]).count();
+        }
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicParallelMergeSort<Key, Compare>::sortChunk(std::vector<Key>& array, int first, int last, Counter<Policy::counts>& comparisons, Counter<Policy::counts>& moves) {
+        // Sort short runs in place with the small-range kernel
+        int runSize = SortingNetwork::getBaseCaseSize();
+        for (int runStart = first; runStart < last; runStart += runSize) {
+            comparisons += SortingNetwork::sort(array.data() + runStart, std::min(runSize, last - runStart), this->compare);
+        }
+
+        // Then merge them bottom-up through this chunk's slice of the buffer
+        Key* source = array.data();
+        Key* destination = buffer.data();
+        for (int width = runSize; width < last - first; width *= 2) {
+            for (int left = first; left < last; left += 2 * width) {
+                int middle = std::min(left + width, last);
+                int right = std::min(left + 2 * width, last);
+                mergeInto<Policy>(source, left, middle, middle, right, destination + left, comparisons);
+            }
+            moves += last - first;
+            std::swap(source, destination);
+        }
+
+        if (source != array.data()) {
+            std::copy(source + first, source + last, array.data() + first);
+        }
+    }
+
+    template <typename Key, typename Compare>
+    void BasicParallelMergeSort<Key, Compare>::splitMerge(const std::vector<Key>& source, int first, int middle, int last, int segmentSize, std::vector<Segment>& segments) {
+        const Key* a = source.data() + first;
+        const Key* b = source.data() + middle;
+        int lengthA = middle - first;
+        int lengthB = last - middle;
+        int length = last - first;
+        int pieces = std::max(1, (length + segmentSize - 1) / segmentSize);
+
+        // Cut the output into equal diagonals and find where each one crosses the two runs
+        int previousDiagonal = 0;
+        int previousA = 0;
+        for (int piece = 1; piece <= pieces; piece++) {
+            int diagonal = static_cast<int>(static_cast<long long>(length) * piece / pieces);
+            int takenA = coRank(a, lengthA, b, lengthB, diagonal);
+            segments.push_back({ first + previousA, first + takenA,
+                middle + (previousDiagonal - previousA), middle + (diagonal - takenA),
+                first + previousDiagonal });
+            previousDiagonal = diagonal;
+            previousA = takenA;
+        }
+    }
+
+    template <typename Key, typename Compare>
+    int BasicParallelMergeSort<Key, Compare>::coRank(const Key* a, int lengthA, const Key* b, int lengthB, int diagonal) const {
+        // How many of the first diagonal elements of the stable merge come from a
+        int low = std::max(0, diagonal - lengthB);
+        int high = std::min(diagonal, lengthA);
+        while (low < high) {
+            int i = low + (high - low) / 2;
+            if (!this->compare(b[diagonal - i - 1], a[i])) {
+                low = i + 1;
+            }
+            else {
+                high = i;
+            }
+        }
+        return low;
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicParallelMergeSort<Key, Compare>::mergeInto(const Key* source, int firstA, int lastA, int firstB, int lastB, Key* destination, Counter<Policy::counts>& comparisons) const {
+        Counter<Policy::counts> count;
+        while (firstA < lastA && firstB < lastB) {
+            count++;
+            // Taking from the left run on ties keeps the sort stable
+            if (!this->compare(source[firstB], source[firstA])) {
+                *destination++ = source[firstA++];
+            }
+            else {
+                *destination++ = source[firstB++];
+            }
+        }
+        destination = std::copy(source + firstA, source + lastA, destination);
+        std::copy(source + firstB, source + lastB, destination);
+        comparisons += count.value;
+    }
+
+#define INSTANTIATE(Key) template class BasicParallelMergeSort<Key>;
+    FOR_EACH_KEY_TYPE(INSTANTIATE)
+#undef INSTANTIATE
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "Algorithm.h"
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace Algorithms {
+
+    // MergeSort on every core. The levels of the recursion tree run bottom-up: first each
+    // worker sorts one chunk, then every pass merges pairs of runs. Merges are cut into
+    // equal output segments by merge path (co-ranking), so even the last merge of two
+    // halves is shared by all workers. Swaps count element moves.
+    template <typename Key, typename Compare = typename Utils::KeyTraits<Key>::Compare>
+    class BasicParallelMergeSort : public BasicAlgorithm<Key, Compare> {
+    public:
+        BasicParallelMergeSort(int workerCount = 0);
+
+        void step(Visualization::BasicVisualizationData<Key>&, SortingStats&) override {}
+        void run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) override;
+        void runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation) override;
+        bool supportsInstrumentation() const override { return true; }
+        bool supportsStepping() const override { return false; }
+        bool supportsRecording() const override { return false; }
+        bool isComplete(const SortingStats& stats) const override;
+        void reset() override;
+
+    private:
+        // One contiguous piece of output written by a single worker
+        struct Segment {
+            int firstA, lastA;   // Half-open input range from the left run
+            int firstB, lastB;   // Half-open input range from the right run
+            int output;          // Where the segment starts in the destination
+        };
+
+        // Segments are never cut smaller than this, small merges stay on one worker
+        static constexpr int MIN_SEGMENT = 8192;
+
+        int workerCount;
+        std::vector<Key> buffer;
+        std::atomic<int> nextTask{ 0 };
+        // Keeps the workers out of the array while one of them publishes a frame
+        TeamPacer pacer;
+
+        // run() is the Visual instantiation: it colors segments by worker, keeps per-worker counters and paces.
+        // Counters keeps only the counters, None neither.
+        template <typename Policy>
+        void sortAll(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
+
+        // Runs task(worker, index) for every index on all workers and waits for them; timed only when counting
+        template <typename Policy>
+        void parallelFor(int taskCount, SortingStats& stats, const std::function<void(int, int)>& task);
+
+        template <typename Policy>
+        void sortChunk(std::vector<Key>& array, int first, int last, Counter<Policy::counts>& comparisons, Counter<Policy::counts>& moves);
+        void splitMerge(const std::vector<Key>& source, int first, int middle, int last, int segmentSize, std::vector<Segment>& segments);
+
+        // Merge path: how many elements of a come before output position diagonal
+        int coRank(const Key* a, int lengthA, const Key* b, int lengthB, int diagonal) const;
+        template <typename Policy>
+        void mergeInto(const Key* source, int firstA, int lastA, int firstB, int lastB, Key* destination, Counter<Policy::counts>& comparisons) const;
+    };
+
+    using ParallelMergeSort = BasicParallelMergeSort<int>;
+
+}
@@ -0,0 +1,259 @@
+#include "ParallelQuickSort.h"
+#include "Scheduler.h"
+#include "SortingNetwork.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace Algorithms {
+
+    template <typename Key, typename Compare>
+    BasicParallelQuickSort<Key, Compare>::BasicParallelQuickSort(int workerCount) : BasicAlgorithm<Key, Compare>("Parallel Quick Sort"), workerCount(workerCount) {
+        if (this->workerCount <= 0) {
+            this->workerCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        reset();
+    }
+
+    template <typename Key, typename Compare>
+    void BasicParallelQuickSort<Key, Compare>::reset() {
+        queues.clear();
+        for (int id = 0; id < workerCount; id++) {
+            queues.push_back(std::make_unique<WorkQueue>());
+        }
+        pendingTasks = 0;
+    }
+
+    template <typename Key, typename Compare>
+    bool BasicParallelQuickSort<Key, Compare>::isComplete(const SortingStats& stats) const {
+        return stats.sortingComplete;
+    }
+
+    template <typename Key, typename Compare>
+    void BasicParallelQuickSort<Key, Compare>::run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        runInstrumented(data, stats, Instrumentation::Visual);
+    }
+
+    template <typename Key, typename Compare>
+    void BasicParallelQuickSort<Key, Compare>::runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation) {
+        this->runKernel(data, stats, instrumentation, [&](auto policy) {
+            sortAll<decltype(policy)>(data, stats);
+        });
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicParallelQuickSort<Key, Compare>::sortAll(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        if constexpr (Policy::counts) {
+            stats.workers.assign(workerCount, WorkerStats());
+        }
+        if constexpr (Policy::highlights) {
+            data.clearGroups();
+        }
+
+        if (data.size() > 1) {
+            // Taken once here: asking for it ends sharing, which must not happen on every worker at once
+            std::vector<Key>& array = data.getValues();
+            push(0, { 0, data.size() - 1 });
+
+            // The calling thread is worker 0; idle pool threads join as the others.
+            // Workers that never join leave their deque empty, so nothing waits for them.
+            Scheduler::getDefault().runTeam(workerCount, [&](int id) {
+                pacer.enter();
+                worker<Policy>(id, array, data, stats);
+                pacer.leave();
+            });
+        }
+
+        for (const auto& worker : stats.workers) {
+            stats.comparisons += worker.comparisons;
+            stats.swaps += worker.swaps;
+            stats.currentStep += worker.tasks;
+        }
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicParallelQuickSort<Key, Compare>::worker(int id, std::vector<Key>& array, Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        Task task;
+        while (stats.isSorting) {
+            bool found = pop(id, task);
+            if (!found && steal(id, task)) {
+                if constexpr (Policy::counts) {
+                    stats.workers[id].steals++;
+                }
+                found = true;
+            }
+            if (found) {
+                process<Policy>(id, task, array, data, stats);
+                pendingTasks--;
+                continue;
+            }
+            if (pendingTasks == 0) {
+                break;
+            }
+
+            // Nothing to take yet; another worker is still splitting a range
+            pacer.park();
+            if constexpr (Policy::counts) {
+                auto idleStart = std::chrono::steady_clock::now();
+                std::this_thread::yield();
+                stats.workers[id].idleSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - idleStart).count();
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    template <typename Key, typename Compare>
+    void BasicParallelQuickSort<Key, Compare>::push(int id, Task task) {
+        pendingTasks++;
+        std::lock_guard<std::mutex> lock(queues[id]->mutex);
+        queues[id]->tasks.push_back(task);
+    }
+
+    template <typename Key, typename Compare>
+    bool BasicParallelQuickSort<Key, Compare>::pop(int id, Task& task) {
+        // The owner takes its newest range, which is the smallest and still warm in cache
+        std::lock_guard<std::mutex> lock(queues[id]->mutex);
+        if (queues[id]->tasks.empty()) {
+            return false;
+        }
+        task = queues[id]->tasks.back();
+        queues[id]->tasks.pop_back();
+        return true;
+    }
+
+    template <typename Key, typename Compare>
+    bool BasicParallelQuickSort<Key, Compare>::steal(int id, Task& task) {
+        // Thieves take the oldest range of the next busy worker, which is the largest one
+        for (int offset = 1; offset < workerCount; offset++) {
+            WorkQueue& victim = *queues[(id + offset) % workerCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicParallelQuickSort<Key, Compare>::process(int id, Task task, std::vector<Key>& array, Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        Counter<Policy::counts> comparisons;
+        Counter<Policy::counts> swaps;
+
+        // Color the range by the worker that owns it now
+        if constexpr (Policy::highlights) {
+            data.setGroup(task.low, task.high, static_cast<uint8_t>(id + 1));
+        }
+
+        int low = task.low;
+        int high = task.high;
+        while (high - low + 1 > SPLIT_THRESHOLD && stats.isSorting) {
+            int split = partition<Policy>(array, low, high, comparisons, swaps);
+            if constexpr (Policy::highlights) {
+                data.markDirty(low, high);
+            }
+
+            // Hand the larger side to the deque and keep splitting the smaller one
+            if (split - low > high - split) {
+                push(id, { low, split });
+                low = split + 1;
+            }
+            else {
+                push(id, { split + 1, high });
+                high = split;
+            }
+            if constexpr (Policy::highlights) {
+                this->pace(stats, pacer);
+            }
+        }
+
+        if (stats.isSorting && low < high) {
+            int depthLimit = 2 * static_cast<int>(std::log2(high - low + 1));
+            sortRange<Policy>(array, low, high, depthLimit, comparisons, swaps);
+            if constexpr (Policy::highlights) {
+                data.markDirty(low, high);
+            }
+        }
+
+        if constexpr (Policy::counts) {
+            WorkerStats& counters = stats.workers[id];
+            counters.comparisons += comparisons.value;
+            counters.swaps += swaps.value;
+            counters.tasks++;
+        }
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    int BasicParallelQuickSort<Key, Compare>::partition(std::vector<Key>& array, int low, int high, Counter<Policy::counts>& comparisons, Counter<Policy::counts>& swaps) {
+        // Median of three, then Hoare partition; returns the last index of the left side
+        int mid = low + (high - low) / 2;
+        if (this->compare(array[mid], array[low])) { std::swap(array[mid], array[low]); swaps++; }
+        if (this->compare(array[high], array[low])) { std::swap(array[high], array[low]); swaps++; }
+        if (this->compare(array[high], array[mid])) { std::swap(array[high], array[mid]); swaps++; }
+        comparisons += 3;
+        Key pivot = array[mid];
+
+        int i = low - 1;
+        int j = high + 1;
+        while (true) {
+            do {
+                i++;
+                comparisons++;
+            } while (this->compare(array[i], pivot));
+            do {
+                j--;
+                comparisons++;
+            } while (this->compare(pivot, array[j]));
+            if (i >= j) {
+                return j;
+            }
+            std::swap(array[i], array[j]);
+            swaps++;
+        }
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicParallelQuickSort<Key, Compare>::sortRange(std::vector<Key>& array, int low, int high, int depthLimit, Counter<Policy::counts>& comparisons, Counter<Policy::counts>& swaps) {
+        int baseCaseSize = SortingNetwork::getBaseCaseSize();
+        while (high - low + 1 > baseCaseSize) {
+            if (depthLimit-- == 0) {
+                auto counted = [this, &comparisons](const Key& a, const Key& b) {
+                    comparisons++;
+                    return this->compare(a, b);
+                };
+                std::make_heap(array.begin() + low, array.begin() + high + 1, counted);
+                std::sort_heap(array.begin() + low, array.begin() + high + 1, counted);
+                return;
+            }
+
+            // Recurse into the smaller side, loop on the larger one
+            int split = partition<Policy>(array, low, high, comparisons, swaps);
+            if (split - low < high - split) {
+                sortRange<Policy>(array, low, split, depthLimit, comparisons, swaps);
+                low = split + 1;
+            }
+            else {
+                sortRange<Policy>(array, split + 1, high, depthLimit, comparisons, swaps);
+                high = split;
+            }
+        }
+
+        if (low < high) {
+            comparisons += SortingNetwork::sort(array.data() + low, high - low + 1, this->compare);
+        }
+    }
+
+#define INSTANTIATE(Key) template class BasicParallelQuickSort<Key>;
+    FOR_EACH_KEY_TYPE(INSTANTIATE)
+#undef INSTANTIATE
+
+}
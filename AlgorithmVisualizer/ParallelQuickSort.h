@@ -0,0 +1,70 @@
+#pragma once
+#include "Algorithm.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Algorithms {
+
+    // QuickSort on every core. Each partition runs on one thread; the larger side goes
+    // into that worker's deque and idle workers steal the oldest (largest) ranges.
+    // Workers write the array directly, so there is no undo log, trace or stepping.
+    template <typename Key, typename Compare = typename Utils::KeyTraits<Key>::Compare>
+    class BasicParallelQuickSort : public BasicAlgorithm<Key, Compare> {
+    public:
+        BasicParallelQuickSort(int workerCount = 0);
+
+        void step(Visualization::BasicVisualizationData<Key>&, SortingStats&) override {}
+        void run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) override;
+        void runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation) override;
+        bool supportsInstrumentation() const override { return true; }
+        bool supportsStepping() const override { return false; }
+        bool supportsRecording() const override { return false; }
+        bool isComplete(const SortingStats& stats) const override;
+        void reset() override;
+
+    private:
+        struct Task {
+            int low;
+            int high;
+        };
+
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        // Ranges up to this size are sorted by the worker that owns them without splitting further
+        static constexpr int SPLIT_THRESHOLD = 4096;
+
+        int workerCount;
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        std::atomic<long long> pendingTasks{ 0 };
+        // Keeps the workers out of the array while one of them publishes a frame
+        TeamPacer pacer;
+
+        // run() is the Visual instantiation: it colors ranges by worker, keeps per-worker counters and paces.
+        // Counters keeps only the counters, None neither.
+        template <typename Policy>
+        void sortAll(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
+        template <typename Policy>
+        void worker(int id, std::vector<Key>& array, Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
+        void push(int id, Task task);
+        bool pop(int id, Task& task);
+        bool steal(int id, Task& task);
+        template <typename Policy>
+        void process(int id, Task task, std::vector<Key>& array, Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
+
+        // Sequential helpers; counters are accumulated locally and flushed once per task.
+        // Ranges up to SortingNetwork::getBaseCaseSize() are finished by SortingNetwork::sort.
+        template <typename Policy>
+        int partition(std::vector<Key>& array, int low, int high, Counter<Policy::counts>& comparisons, Counter<Policy::counts>& swaps);
+        template <typename Policy>
+        void sortRange(std::vector<Key>& array, int low, int high, int depthLimit, Counter<Policy::counts>& comparisons, Counter<Policy::counts>& swaps);
+    };
+
+    using ParallelQuickSort = BasicParallelQuickSort<int>;
+
+}
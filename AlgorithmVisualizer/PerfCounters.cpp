@@ -0,0 +1,352 @@
+#include "PerfCounters.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fstream>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Utils {
+
+    namespace {
+        constexpr size_t EVENT_COUNT = static_cast<size_t>(PerfEvent::Count);
+
+        struct Availability {
+            // Bit per event the kernel let this process open
+            unsigned events = 0;
+            std::string error;
+        };
+
+        std::atomic<bool> perfEnabled{ false };
+
+#if defined(__linux__)
+        // Counter value with the time it was enabled and the time it was actually on the CPU
+        struct Reading {
+            uint64_t value = 0;
+            uint64_t enabled = 0;
+            uint64_t running = 0;
+        };
+
+        void describeEvent(PerfEvent event, perf_event_attr& attr) {
+            auto cacheMiss = [](uint64_t cache) {
+                return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            };
+            switch (event) {
+            case PerfEvent::Cycles:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case PerfEvent::Instructions:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case PerfEvent::BranchMisses:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case PerfEvent::L1DMisses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = cacheMiss(PERF_COUNT_HW_CACHE_L1D);
+                break;
+            case PerfEvent::LLCMisses:
+                // The generic event is the last level on most CPUs, and more of them have it than the LL cache event
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            default:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = cacheMiss(PERF_COUNT_HW_CACHE_DTLB);
+                break;
+            }
+        }
+
+        // Counts event for the calling thread only, in user mode, from now on; -1 with errno set on failure
+        int openEvent(PerfEvent event) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            describeEvent(event, attr);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+        }
+
+        std::string describeError(int error) {
+            if (error == EACCES || error == EPERM) {
+                std::string message = "not permitted";
+                std::ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+                int level = 0;
+                if (paranoid >> level) {
+                    message += " (kernel.perf_event_paranoid is " + std::to_string(level) + ", user mode counting needs 2 or less)";
+                }
+                return message;
+            }
+            if (error == ENOENT || error == EOPNOTSUPP) {
+                return "the CPU exposes no hardware counters, e.g. in a virtual machine";
+            }
+            if (error == ENOSYS) {
+                return "the kernel has no perf_event_open";
+            }
+            return std::strerror(error);
+        }
+
+        Availability probe() {
+            Availability availability;
+            int firstError = 0;
+            for (size_t e = 0; e < EVENT_COUNT; e++) {
+                int descriptor = openEvent(static_cast<PerfEvent>(e));
+                if (descriptor >= 0) {
+                    availability.events |= 1u << e;
+                    close(descriptor);
+                }
+                else if (firstError == 0) {
+                    firstError = errno;
+                }
+            }
+            if (availability.events == 0) {
+                availability.error = describeError(firstError);
+            }
+            return availability;
+        }
+#else
+        Availability probe() {
+            Availability availability;
+            availability.error = "hardware counters are only read on Linux";
+            return availability;
+        }
+#endif
+
+        const Availability& getAvailability() {
+            static const Availability availability = probe();
+            return availability;
+        }
+
+        // The counters of one thread: opened on its first scope, closed when the thread exits
+        struct ThreadCounters {
+            PerfRecorder* recorder = nullptr;
+#if defined(__linux__)
+            std::array<int, EVENT_COUNT> descriptors;
+            bool opened = false;
+            std::array<Reading, EVENT_COUNT> baseline{};
+
+            ThreadCounters() {
+                descriptors.fill(-1);
+            }
+
+            ~ThreadCounters() {
+                for (int descriptor : descriptors) {
+                    if (descriptor >= 0) {
+                        close(descriptor);
+                    }
+                }
+            }
+
+            std::array<Reading, EVENT_COUNT> read() const {
+                std::array<Reading, EVENT_COUNT> readings{};
+                for (size_t e = 0; e < EVENT_COUNT; e++) {
+                    if (descriptors[e] >= 0 && ::read(descriptors[e], &readings[e], sizeof(Reading)) != sizeof(Reading)) {
+                        readings[e] = Reading();
+                    }
+                }
+                return readings;
+            }
+#endif
+
+            // Whether any counter is open; tries once per thread
+            bool open() {
+#if defined(__linux__)
+                if (!opened) {
+                    opened = true;
+                    unsigned events = getAvailability().events;
+                    for (size_t e = 0; e < EVENT_COUNT; e++) {
+                        if ((events >> e) & 1) {
+                            descriptors[e] = openEvent(static_cast<PerfEvent>(e));
+                        }
+                    }
+                    baseline = read();
+                }
+                for (int descriptor : descriptors) {
+                    if (descriptor >= 0) {
+                        return true;
+                    }
+                }
+#endif
+                return false;
+            }
+
+            // Counts since the last call, which start the next stretch
+            PerfSample take() {
+                PerfSample sample;
+#if defined(__linux__)
+                std::array<Reading, EVENT_COUNT> now = read();
+                for (size_t e = 0; e < EVENT_COUNT; e++) {
+                    uint64_t running = now[e].running - baseline[e].running;
+                    if (descriptors[e] < 0 || running == 0) {
+                        continue;
+                    }
+                    // The kernel counts an event only while it has a counter; scale up to the time it was enabled
+                    double enabled = static_cast<double>(now[e].enabled - baseline[e].enabled);
+                    sample.values[e] = static_cast<double>(now[e].value - baseline[e].value) * enabled / static_cast<double>(running);
+                    sample.counted |= 1u << e;
+                }
+                baseline = now;
+#endif
+                return sample;
+            }
+        };
+
+        thread_local ThreadCounters threadCounters;
+    }
+
+    const char* getPerfEventName(PerfEvent event) {
+        switch (event) {
+        case PerfEvent::Cycles: return "cycles";
+        case PerfEvent::Instructions: return "instructions";
+        case PerfEvent::BranchMisses: return "branch_misses";
+        case PerfEvent::L1DMisses: return "l1d_misses";
+        case PerfEvent::LLCMisses: return "llc_misses";
+        case PerfEvent::DTLBMisses: return "dtlb_misses";
+        default: return "unknown";
+        }
+    }
+
+    bool isPerfAvailable() {
+        return getAvailability().events != 0;
+    }
+
+    const std::string& getPerfError() {
+        return getAvailability().error;
+    }
+
+    void setPerfEnabled(bool enabled) {
+        perfEnabled = enabled && isPerfAvailable();
+    }
+
+    bool isPerfEnabled() {
+        return perfEnabled.load(std::memory_order_relaxed);
+    }
+
+    double PerfSample::getIpc() const {
+        if (!has(PerfEvent::Cycles) || !has(PerfEvent::Instructions) || get(PerfEvent::Cycles) <= 0.0) {
+            return 0.0;
+        }
+        return get(PerfEvent::Instructions) / get(PerfEvent::Cycles);
+    }
+
+    void PerfSample::add(const PerfSample& other) {
+        for (size_t e = 0; e < EVENT_COUNT; e++) {
+            values[e] += other.values[e];
+        }
+        counted |= other.counted;
+    }
+
+    void PerfSample::scale(double factor) {
+        for (double& value : values) {
+            value *= factor;
+        }
+    }
+
+    void PerfRecorder::setPhase(const char* name) {
+        if (phase.load(std::memory_order_relaxed) == name) {
+            return;
+        }
+        ThreadCounters& counters = threadCounters;
+        if (counters.recorder == this) {
+            add(counters.take());
+        }
+        phase.store(name, std::memory_order_relaxed);
+    }
+
+    void PerfRecorder::reset() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            phases.clear();
+        }
+        phase.store(nullptr, std::memory_order_relaxed);
+
+        // What the calling thread counted before the reset belongs to no run
+        ThreadCounters& counters = threadCounters;
+        if (counters.recorder == this) {
+            counters.take();
+        }
+    }
+
+    void PerfRecorder::copyFrom(const PerfRecorder& other) {
+        if (&other == this) {
+            return;
+        }
+        std::vector<PerfPhase> copied = other.getPhases();
+        std::lock_guard<std::mutex> lock(mutex);
+        phases = std::move(copied);
+    }
+
+    PerfSample PerfRecorder::getTotal() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        PerfSample total;
+        for (const auto& entry : phases) {
+            total.add(entry.sample);
+        }
+        return total;
+    }
+
+    std::vector<PerfPhase> PerfRecorder::getPhases() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return phases;
+    }
+
+    void PerfRecorder::add(const PerfSample& sample) {
+        if (sample.isEmpty()) {
+            return;
+        }
+        const char* name = phase.load(std::memory_order_relaxed);
+        if (name == nullptr) {
+            name = "";
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& entry : phases) {
+            if (entry.name == name) {
+                entry.sample.add(sample);
+                return;
+            }
+        }
+        phases.push_back({ name, sample });
+    }
+
+    PerfScope::PerfScope(PerfRecorder* recorder) {
+        if (recorder == nullptr || !isPerfEnabled()) {
+            return;
+        }
+        ThreadCounters& counters = threadCounters;
+        if (counters.recorder == recorder || !counters.open()) {
+            return;
+        }
+
+        // The recorder this thread counted for so far gets its counts up to here, and the rest after this scope
+        PerfSample sample = counters.take();
+        if (counters.recorder != nullptr) {
+            counters.recorder->add(sample);
+        }
+        previous = counters.recorder;
+        counters.recorder = recorder;
+        active = true;
+    }
+
+    PerfScope::~PerfScope() {
+        if (!active) {
+            return;
+        }
+        ThreadCounters& counters = threadCounters;
+        counters.recorder->add(counters.take());
+        counters.recorder = previous;
+    }
+
+    PerfRecorder* PerfScope::getRecorder() {
+        return threadCounters.recorder;
+    }
+
+}
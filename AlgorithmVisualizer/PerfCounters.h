@@ -0,0 +1,101 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Utils {
+
+    // Hardware events counted per thread through perf_event_open on Linux, in user mode only.
+    // Elsewhere, or when the kernel does not permit it, none are available.
+    enum class PerfEvent {
+        Cycles,
+        Instructions,
+        BranchMisses,
+        L1DMisses,
+        LLCMisses,
+        DTLBMisses,
+        Count
+    };
+
+    const char* getPerfEventName(PerfEvent event);
+
+    // Whether this process may count any of the events; found out once, on the first call
+    bool isPerfAvailable();
+    // Why not, e.g. the perf_event_paranoid setting, or empty when available
+    const std::string& getPerfError();
+
+    // Off by default; while off, scopes read nothing and cost nothing. Stays off when unavailable.
+    void setPerfEnabled(bool enabled);
+    bool isPerfEnabled();
+
+    // Counts of some stretch of work. Events the CPU could not count are missing rather than 0;
+    // counts of events that shared the counters with others are scaled up to the whole stretch.
+    struct PerfSample {
+        std::array<double, static_cast<size_t>(PerfEvent::Count)> values{};
+        // Bit per event that was counted
+        unsigned counted = 0;
+
+        bool has(PerfEvent event) const { return (counted >> static_cast<int>(event)) & 1; }
+        double get(PerfEvent event) const { return values[static_cast<size_t>(event)]; }
+        bool isEmpty() const { return counted == 0; }
+
+        // Instructions per cycle, 0 when either was not counted
+        double getIpc() const;
+
+        void add(const PerfSample& other);
+        void scale(double factor);
+    };
+
+    struct PerfPhase {
+        // The algorithm's phase name, empty for work outside any phase
+        std::string name;
+        PerfSample sample;
+    };
+
+    // Counts of one run, summed over every thread that counted for it and split by the phase the
+    // algorithm was in. Threads add to it from PerfScope; any thread may read it at any time.
+    class PerfRecorder {
+    public:
+        // Counts made from now on go to the phase of this name, nullptr for none. The counts of the
+        // calling thread so far go to the phase it leaves; other threads add theirs when their scope ends.
+        void setPhase(const char* name);
+
+        void reset();
+        // Replace these counts with a copy of other's, e.g. for a frame of the render loop
+        void copyFrom(const PerfRecorder& other);
+
+        PerfSample getTotal() const;
+        // In the order the phases were first entered
+        std::vector<PerfPhase> getPhases() const;
+
+    private:
+        friend class PerfScope;
+
+        mutable std::mutex mutex;
+        std::atomic<const char*> phase{ nullptr };
+        std::vector<PerfPhase> phases;
+
+        void add(const PerfSample& sample);
+    };
+
+    // Counts the calling thread for recorder until destroyed. Does nothing when recorder is null,
+    // counting is off, or the thread already counts for recorder, so scopes nest freely.
+    class PerfScope {
+    public:
+        explicit PerfScope(PerfRecorder* recorder);
+        ~PerfScope();
+
+        PerfScope(const PerfScope&) = delete;
+        PerfScope& operator=(const PerfScope&) = delete;
+
+        // What the calling thread counts for, so work handed to other threads can count for it too
+        static PerfRecorder* getRecorder();
+
+    private:
+        bool active = false;
+        PerfRecorder* previous = nullptr;
+    };
+
+}
@@ -1,17 +1,18 @@
 #include "QuickSort.h"
-#include <thread>
-#include <chrono>
+#include <cmath>
+#include <utility>
 
 namespace Algorithms {
 
-    QuickSort::QuickSort() : Algorithm("Quick Sort") {
+    template <typename Key, typename Compare>
+    BasicQuickSort<Key, Compare>::BasicQuickSort(Mode mode) : BasicAlgorithm<Key, Compare>(mode == Mode::Introsort ? "Quick Sort (Introsort)" : "Quick Sort"), mode(mode) {
         reset();
     }
 
-    void QuickSort::reset() {
-        while (!sortStack.empty()) {
-            sortStack.pop();
-        }
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::reset() {
+        ranges.clear();
+        started = false;
         currentLow = 0;
         currentHigh = 0;
         pivotIndex = 0;
@@ -19,34 +20,68 @@ namespace Algorithms {
         j = 0;
         partitioning = false;
         swapped = false;
+
+        phase = Phase::Next;
+        depth = 0;
+        depthLimit = 0;
+        pivotPairCount = 0;
+        pivotPairIndex = 0;
+        siftIndex = -1;
+
+        stepStates.clear();
+        rangeOps.clear();
     }
 
-    bool QuickSort::isComplete(const SortingStats& stats) const {
+    template <typename Key, typename Compare>
+    const char* BasicQuickSort<Key, Compare>::getPhaseName() const {
+        if (mode == Mode::Classic) {
+            return nullptr;
+        }
+
+        switch (phase) {
+        case Phase::Pivot: return pivotPairCount > 3 ? "Pivot selection (ninther)" : "Pivot selection (median of three)";
+        case Phase::Partition: return "Partition";
+        case Phase::Heapsort: return "Heapsort fallback";
+        case Phase::Insertion: return "Insertion sort";
+        default: return "Next range";
+        }
+    }
+
+    template <typename Key, typename Compare>
+    bool BasicQuickSort<Key, Compare>::isComplete(const SortingStats& stats) const {
         return stats.sortingComplete;
     }
 
-    void QuickSort::step(Visualization::VisualizationData& data, SortingStats& stats) {
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::step(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
         if (stats.sortingComplete || !stats.isSorting) {
             return;
         }
 
-        auto& array = data.getArray();
+        auto& array = data.getValues();
         int n = array.size();
 
         if (stats.stateRestored) {
-            currentLow = stats.lastRestoredI;
-            currentHigh = stats.lastRestoredJ;
-            swapped = stats.lastRestoredSwapped;
-            stats.stateRestored = false;
+            restoreStep(stats);
         } else {
             data.resetHighlighting();
-            
-            stats.saveState(data, currentLow, currentHigh, swapped);
+        }
+
+        stats.saveState(currentLow, currentHigh, swapped);
+        saveStep(stats);
+
+        if (mode == Mode::Introsort) {
+            stepIntrosort(data, stats);
+            if (stats.steppingMode) {
+                stats.isSorting = false;
+            }
+            return;
         }
 
         // Initialize the stack if this is the first step
-        if (sortStack.empty() && !partitioning) {
-            sortStack.push({0, n - 1});
+        if (!started) {
+            started = true;
+            pushRange({ 0, n - 1, 0 }, stats.recordHistory);
         }
 
         // If we're currently partitioning, continue the partition step
@@ -56,7 +91,7 @@ namespace Algorithms {
         }
 
         // If stack is empty and we're not partitioning, sorting is complete
-        if (sortStack.empty()) {
+        if (ranges.empty()) {
             stats.sortingComplete = true;
             stats.isSorting = false;
             data.resetHighlighting();
@@ -64,16 +99,16 @@ namespace Algorithms {
         }
 
         // Get the next range to sort
-        auto range = sortStack.top();
-        sortStack.pop();
-        currentLow = range.first;
-        currentHigh = range.second;
+        Range range = popRange(stats.recordHistory);
+        currentLow = range.low;
+        currentHigh = range.high;
 
         // If the range has more than one element, start partitioning
         if (currentLow < currentHigh) {
             // Choose pivot (last element)
             pivotIndex = currentHigh;
-            array[pivotIndex].isComparing = true;
+            data.setComparing(pivotIndex);
+            stats.recordRange(currentLow, currentHigh);
             
             // Initialize partition variables
             i = currentLow - 1;
@@ -91,28 +126,31 @@ namespace Algorithms {
         }
     }
 
-    void QuickSort::stepPartition(Visualization::VisualizationData& data, SortingStats& stats) {
-        auto& array = data.getArray();
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::stepPartition(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        auto& array = data.getValues();
         
         if (j < currentHigh) {
             if (j > currentLow) {
-                array[j - 1].isComparing = false;
+                data.clearHighlight(j - 1);
             }
             
-            array[j].isComparing = true;
-            array[pivotIndex].isComparing = true;
+            data.setComparing(j);
+            data.setComparing(pivotIndex);
+            stats.recordCompare(j, pivotIndex);
             
             stats.comparisons++;
             stats.currentStep++;
             
             // If current element is smaller than or equal to pivot
-            if (array[j].value <= array[pivotIndex].value) {
+            if (!this->compare(array[pivotIndex], array[j])) {
                 i++;
                 
                 if (i != j) {
-                    array[i].isSwapping = true;
-                    array[j].isSwapping = true;
-                    std::swap(array[i], array[j]);
+                    data.setSwapping(i);
+                    data.setSwapping(j);
+                    data.swap(i, j);
+                    stats.recordSwap(i, j);
                     stats.swaps++;
                     swapped = true;
                 } else {
@@ -126,9 +164,10 @@ namespace Algorithms {
         } else {
             // Partition is complete, place pivot in correct position
             if (i + 1 != pivotIndex) {
-                array[i + 1].isSwapping = true;
-                array[pivotIndex].isSwapping = true;
-                std::swap(array[i + 1], array[pivotIndex]);
+                data.setSwapping(i + 1);
+                data.setSwapping(pivotIndex);
+                data.swap(i + 1, pivotIndex);
+                stats.recordSwap(i + 1, pivotIndex);
                 stats.swaps++;
                 stats.currentStep++;
             }
@@ -137,17 +176,23 @@ namespace Algorithms {
             
             int pivotPos = i + 1;
             
-            if (pivotPos - 1 > currentLow) {
-                sortStack.push({currentLow, pivotPos - 1});
+            if (mode == Mode::Introsort) {
+                pushRanges(currentLow, pivotPos - 1, pivotPos + 1, currentHigh, stats.recordHistory);
+                phase = Phase::Next;
             }
-            
-            if (pivotPos + 1 < currentHigh) {
-                sortStack.push({pivotPos + 1, currentHigh});
+            else {
+                if (pivotPos - 1 > currentLow) {
+                    pushRange({ currentLow, pivotPos - 1, 0 }, stats.recordHistory);
+                }
+
+                if (pivotPos + 1 < currentHigh) {
+                    pushRange({ pivotPos + 1, currentHigh, 0 }, stats.recordHistory);
+                }
             }
             
             partitioning = false;
             
-            if (sortStack.empty()) {
+            if (mode == Mode::Classic && ranges.empty()) {
                 stats.sortingComplete = true;
                 stats.isSorting = false;
             }
@@ -158,47 +203,507 @@ namespace Algorithms {
         }
     }
 
-    int QuickSort::partition(Visualization::VisualizationData& data, SortingStats& stats, int low, int high) {
-        auto& array = data.getArray();
-        int pivot = array[high].value;
-        int i = low - 1;
-        
-        stats.comparisons++;
-        
-        for (int j = low; j < high; j++) {
-            if (!stats.isSorting) break;
-            
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::saveStep(const SortingStats& stats) {
+        if (!stats.recordHistory) {
+            return;
+        }
+        // Records of steps undone since are dropped with them
+        stepStates.resize(stats.history.size() - 1);
+        stepStates.push_back({ phase, started, partitioning, swapped, currentLow, currentHigh, pivotIndex, i, j, depth,
+            pivotPairIndex, heapSize, heapBuild, siftIndex, insertIndex, insertPosition, rangeOps.size() });
+    }
+
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::restoreStep(SortingStats& stats) {
+        stats.stateRestored = false;
+        // The last step undone is the one after those still in the history
+        size_t index = stats.history.size();
+        if (index >= stepStates.size()) {
+            return;
+        }
+        const StepState& state = stepStates[index];
+
+        for (size_t k = rangeOps.size(); k > state.firstRangeOp; k--) {
+            const RangeOp& op = rangeOps[k - 1];
+            if (op.pushed) {
+                ranges.pop_back();
+            }
+            else {
+                ranges.push_back(op.range);
+            }
+        }
+        rangeOps.resize(state.firstRangeOp);
+
+        phase = state.phase;
+        started = state.started;
+        partitioning = state.partitioning;
+        swapped = state.swapped;
+        currentLow = state.currentLow;
+        currentHigh = state.currentHigh;
+        pivotIndex = state.pivotIndex;
+        i = state.i;
+        j = state.j;
+        depth = state.depth;
+        pivotPairIndex = state.pivotPairIndex;
+        heapSize = state.heapSize;
+        heapBuild = state.heapBuild;
+        siftIndex = state.siftIndex;
+        insertIndex = state.insertIndex;
+        insertPosition = state.insertPosition;
+        stepStates.resize(index);
+
+        if (phase == Phase::Pivot) {
+            choosePivotPairs();
+        }
+    }
+
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::pushRange(const Range& range, bool record) {
+        ranges.push_back(range);
+        if (record) {
+            rangeOps.push_back({ true, range });
+        }
+    }
+
+    template <typename Key, typename Compare>
+    typename BasicQuickSort<Key, Compare>::Range BasicQuickSort<Key, Compare>::popRange(bool record) {
+        Range range = ranges.back();
+        ranges.pop_back();
+        if (record) {
+            rangeOps.push_back({ false, range });
+        }
+        return range;
+    }
+
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::pushRanges(int leftLow, int leftHigh, int rightLow, int rightHigh, bool record) {
+        // Push the larger side first so the smaller one is sorted next; the stack stays O(log n)
+        Range left{ leftLow, leftHigh, depth + 1 };
+        Range right{ rightLow, rightHigh, depth + 1 };
+        if (leftHigh - leftLow < rightHigh - rightLow) {
+            std::swap(left, right);
+        }
+        if (left.high > left.low) {
+            pushRange(left, record);
+        }
+        if (right.high > right.low) {
+            pushRange(right, record);
+        }
+    }
+
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::stepIntrosort(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        switch (phase) {
+        case Phase::Pivot:
+            stepPivot(data, stats);
+            break;
+        case Phase::Partition:
+            stepPartition(data, stats);
+            break;
+        case Phase::Heapsort:
+            stepHeapsort(data, stats);
+            break;
+        case Phase::Insertion:
+            stepInsertion(data, stats);
+            break;
+        default:
+            startRange(data, stats);
+            break;
+        }
+    }
+
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::startRange(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        int n = data.size();
+        if (!started) {
+            started = true;
+            depthLimit = n > 1 ? 2 * static_cast<int>(std::log2(n)) : 0;
+            if (n > 1) {
+                pushRange({ 0, n - 1, 0 }, stats.recordHistory);
+            }
+        }
+
+        if (ranges.empty()) {
+            data.markedLow = -1;
+            data.markedHigh = -1;
+            stats.sortingComplete = true;
+            stats.isSorting = false;
             data.resetHighlighting();
-            array[j].isComparing = true;
-            array[high].isComparing = true;
-            stats.comparisons++;
-            
-            if (array[j].value <= pivot) {
-                i++;
-                if (i != j) {
-                    array[i].isSwapping = true;
-                    array[j].isSwapping = true;
-                    std::swap(array[i], array[j]);
-                    stats.swaps++;
-                }
+            return;
+        }
+
+        Range range = popRange(stats.recordHistory);
+        currentLow = range.low;
+        currentHigh = range.high;
+        depth = range.depth;
+
+        data.markedLow = currentLow;
+        data.markedHigh = currentHigh;
+        stats.recordRange(currentLow, currentHigh);
+        stats.currentStep++;
+
+        int size = currentHigh - currentLow + 1;
+        if (size <= INSERTION_THRESHOLD) {
+            phase = Phase::Insertion;
+            insertIndex = currentLow + 1;
+            insertPosition = insertIndex;
+        }
+        else if (depth >= depthLimit) {
+            // Too many unbalanced partitions; heapsort keeps the range O(n log n)
+            phase = Phase::Heapsort;
+            heapSize = size;
+            heapBuild = size / 2 - 1;
+            siftIndex = -1;
+        }
+        else {
+            phase = Phase::Pivot;
+            pivotPairIndex = 0;
+            choosePivotPairs();
+            for (int k = 0; k < pivotPairCount; k++) {
+                data.setComparing(pivotPairs[k].first);
+                data.setComparing(pivotPairs[k].second);
             }
-            
+        }
+    }
+
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::choosePivotPairs() {
+        int size = currentHigh - currentLow + 1;
+        int mid = currentLow + size / 2;
+        pivotPairCount = 0;
+        auto addSort3 = [this](int a, int b, int c) {
+            pivotPairs[pivotPairCount++] = { a, b };
+            pivotPairs[pivotPairCount++] = { b, c };
+            pivotPairs[pivotPairCount++] = { a, b };
+        };
+        if (size >= NINTHER_THRESHOLD) {
+            // Tukey's ninther: the median of three medians of three
+            int s = size / 8;
+            addSort3(currentLow, currentLow + s, currentLow + 2 * s);
+            addSort3(mid - s, mid, mid + s);
+            addSort3(currentHigh - 2 * s, currentHigh - s, currentHigh);
+            addSort3(currentLow + s, mid, currentHigh - s);
+        }
+        else {
+            addSort3(currentLow, mid, currentHigh);
+        }
+        medianIndex = mid;
+    }
+
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::stepPivot(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        auto& array = data.getValues();
+
+        // One compare-exchange of the median network per step
+        if (pivotPairIndex < pivotPairCount) {
+            auto [a, b] = pivotPairs[pivotPairIndex++];
+            data.setComparing(a);
+            data.setComparing(b);
+            stats.recordCompare(a, b);
+            stats.comparisons++;
             stats.currentStep++;
-            std::this_thread::sleep_for(std::chrono::milliseconds(stats.speedFactor));
+            if (this->compare(array[b], array[a])) {
+                data.setSwapping(a);
+                data.setSwapping(b);
+                data.swap(a, b);
+                stats.recordSwap(a, b);
+                stats.swaps++;
+            }
+            return;
         }
-        
-        if (stats.isSorting && i + 1 != high) {
-            array[i + 1].isSwapping = true;
-            array[high].isSwapping = true;
-            std::swap(array[i + 1], array[high]);
+
+        // Move the median to the end so the partition can use it like the classic pivot
+        if (medianIndex != currentHigh) {
+            data.setSwapping(medianIndex);
+            data.setSwapping(currentHigh);
+            data.swap(medianIndex, currentHigh);
+            stats.recordSwap(medianIndex, currentHigh);
+            stats.swaps++;
+        }
+        stats.currentStep++;
+
+        pivotIndex = currentHigh;
+        i = currentLow - 1;
+        j = currentLow;
+        partitioning = true;
+        phase = Phase::Partition;
+    }
+
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::stepHeapsort(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        auto& array = data.getValues();
+
+        if (siftIndex < 0) {
+            if (heapBuild >= 0) {
+                siftIndex = heapBuild--;
+            }
+            else if (heapSize > 1) {
+                // Move the largest element behind the heap
+                heapSize--;
+                data.setSwapping(currentLow);
+                data.setSwapping(currentLow + heapSize);
+                data.swap(currentLow, currentLow + heapSize);
+                stats.recordSwap(currentLow, currentLow + heapSize);
+                stats.swaps++;
+                stats.currentStep++;
+                siftIndex = 0;
+                return;
+            }
+            else {
+                phase = Phase::Next;
+                return;
+            }
+        }
+
+        // One level of sift-down per step
+        int largest = siftIndex;
+        int left = 2 * siftIndex + 1;
+        int right = left + 1;
+        data.setComparing(currentLow + siftIndex);
+        if (left < heapSize) {
+            data.setComparing(currentLow + left);
+            stats.recordCompare(currentLow + left, currentLow + largest);
+            stats.comparisons++;
+            if (this->compare(array[currentLow + largest], array[currentLow + left])) {
+                largest = left;
+            }
+        }
+        if (right < heapSize) {
+            data.setComparing(currentLow + right);
+            stats.recordCompare(currentLow + right, currentLow + largest);
+            stats.comparisons++;
+            if (this->compare(array[currentLow + largest], array[currentLow + right])) {
+                largest = right;
+            }
+        }
+        stats.currentStep++;
+
+        if (largest != siftIndex) {
+            data.setSwapping(currentLow + siftIndex);
+            data.setSwapping(currentLow + largest);
+            data.swap(currentLow + siftIndex, currentLow + largest);
+            stats.recordSwap(currentLow + siftIndex, currentLow + largest);
             stats.swaps++;
+            siftIndex = largest;
+        }
+        else {
+            siftIndex = -1;
+        }
+    }
+
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::stepInsertion(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        auto& array = data.getValues();
+
+        if (insertIndex > currentHigh) {
+            phase = Phase::Next;
+            return;
+        }
+
+        // Sink the current element one position per step
+        if (insertPosition > currentLow) {
+            data.setComparing(insertPosition - 1);
+            data.setComparing(insertPosition);
+            stats.recordCompare(insertPosition - 1, insertPosition);
+            stats.comparisons++;
             stats.currentStep++;
+            if (this->compare(array[insertPosition], array[insertPosition - 1])) {
+                data.setSwapping(insertPosition - 1);
+                data.setSwapping(insertPosition);
+                data.swap(insertPosition - 1, insertPosition);
+                stats.recordSwap(insertPosition - 1, insertPosition);
+                stats.swaps++;
+                insertPosition--;
+                return;
+            }
         }
-        
-        return i + 1;
+
+        insertIndex++;
+        insertPosition = insertIndex;
     }
 
-    void QuickSort::run(Visualization::VisualizationData& data, SortingStats& stats) {
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation) {
+        this->runKernel(data, stats, instrumentation, [&](auto policy) {
+            sortAll<decltype(policy)>(data, stats);
+        });
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicQuickSort<Key, Compare>::sortAll(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
+        auto& array = data.getValues();
+        int n = array.size();
+        Probe<Policy, Key> probe(data);
+
+        depthLimit = n > 1 ? 2 * static_cast<int>(std::log2(n)) : 0;
+        ranges.clear();
+        if (n > 1) {
+            ranges.push_back({ 0, n - 1, 0 });
+        }
+
+        // Ranges are taken in the order step() takes them; a stop request is honoured between them
+        while (!ranges.empty() && stats.isSorting) {
+            Range range = ranges.back();
+            ranges.pop_back();
+            probe.mark(range.low, range.high);
+            probe.step();
+
+            if (mode == Mode::Classic) {
+                int pivot = partitionRange(array, range.low, range.high, probe);
+                if (pivot - 1 > range.low) {
+                    ranges.push_back({ range.low, pivot - 1, 0 });
+                }
+                if (pivot + 1 < range.high) {
+                    ranges.push_back({ pivot + 1, range.high, 0 });
+                }
+                continue;
+            }
+
+            int size = range.high - range.low + 1;
+            if (size <= INSERTION_THRESHOLD) {
+                insertionSortRange(array, range.low, range.high, probe);
+                continue;
+            }
+            if (range.depth >= depthLimit) {
+                heapsortRange(array, range.low, range.high, probe);
+                continue;
+            }
+
+            // The median network of stepPivot, then the median moves to the end
+            int mid = range.low + size / 2;
+            auto sort3 = [&](int a, int b, int c) {
+                compareExchange(array, a, b, probe);
+                compareExchange(array, b, c, probe);
+                compareExchange(array, a, b, probe);
+            };
+            if (size >= NINTHER_THRESHOLD) {
+                int s = size / 8;
+                sort3(range.low, range.low + s, range.low + 2 * s);
+                sort3(mid - s, mid, mid + s);
+                sort3(range.high - 2 * s, range.high - s, range.high);
+                sort3(range.low + s, mid, range.high - s);
+            }
+            else {
+                sort3(range.low, mid, range.high);
+            }
+            if (mid != range.high) {
+                std::swap(array[mid], array[range.high]);
+                probe.swap(mid, range.high);
+            }
+            probe.step();
+
+            int pivot = partitionRange(array, range.low, range.high, probe);
+            depth = range.depth;
+            pushRanges(range.low, pivot - 1, pivot + 1, range.high, false);
+        }
+
+        probe.flush(stats);
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicQuickSort<Key, Compare>::compareExchange(std::vector<Key>& array, int a, int b, Probe<Policy, Key>& probe) {
+        probe.compare(a, b);
+        if (this->compare(array[b], array[a])) {
+            std::swap(array[a], array[b]);
+            probe.swap(a, b);
+        }
+        probe.step();
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    int BasicQuickSort<Key, Compare>::partitionRange(std::vector<Key>& array, int low, int high, Probe<Policy, Key>& probe) {
+        // Lomuto around the last element, as stepPartition; returns where the pivot ends up
+        Key pivot = array[high];
+        int store = low - 1;
+        for (int k = low; k < high; k++) {
+            probe.compare(k, high);
+            if (!this->compare(pivot, array[k])) {
+                store++;
+                if (store != k) {
+                    std::swap(array[store], array[k]);
+                    probe.swap(store, k);
+                }
+            }
+            probe.step();
+        }
+
+        if (store + 1 != high) {
+            std::swap(array[store + 1], array[high]);
+            probe.swap(store + 1, high);
+            probe.step();
+        }
+        return store + 1;
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicQuickSort<Key, Compare>::heapsortRange(std::vector<Key>& array, int low, int high, Probe<Policy, Key>& probe) {
+        Key* heap = array.data() + low;
+        int size = high - low + 1;
+
+        // One level of sift-down per step, as stepHeapsort
+        auto siftDown = [&](int root, int heapSize) {
+            while (true) {
+                int largest = root;
+                int left = 2 * root + 1;
+                int right = left + 1;
+                if (left < heapSize) {
+                    probe.compare(low + left, low + largest);
+                    if (this->compare(heap[largest], heap[left])) {
+                        largest = left;
+                    }
+                }
+                if (right < heapSize) {
+                    probe.compare(low + right, low + largest);
+                    if (this->compare(heap[largest], heap[right])) {
+                        largest = right;
+                    }
+                }
+                probe.step();
+                if (largest == root) {
+                    return;
+                }
+                std::swap(heap[root], heap[largest]);
+                probe.swap(low + root, low + largest);
+                root = largest;
+            }
+        };
+
+        for (int root = size / 2 - 1; root >= 0; root--) {
+            siftDown(root, size);
+        }
+        for (int end = size - 1; end > 0; end--) {
+            // Move the largest element behind the heap
+            std::swap(heap[0], heap[end]);
+            probe.swap(low, low + end);
+            probe.step();
+            siftDown(0, end);
+        }
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Policy>
+    void BasicQuickSort<Key, Compare>::insertionSortRange(std::vector<Key>& array, int low, int high, Probe<Policy, Key>& probe) {
+        // Sink each element by swaps, as stepInsertion
+        for (int next = low + 1; next <= high; next++) {
+            for (int position = next; position > low; position--) {
+                probe.compare(position - 1, position);
+                probe.step();
+                if (!this->compare(array[position], array[position - 1])) {
+                    break;
+                }
+                std::swap(array[position - 1], array[position]);
+                probe.swap(position - 1, position);
+            }
+        }
+    }
+
+    template <typename Key, typename Compare>
+    void BasicQuickSort<Key, Compare>::run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) {
         if (stats.currentStep == 0) {
             reset();
             stats.reset();
@@ -212,7 +717,7 @@ namespace Algorithms {
 
         while (stats.isSorting && !stats.sortingComplete) {
             step(data, stats);
-            std::this_thread::sleep_for(std::chrono::milliseconds(stats.speedFactor));
+            this->pace(stats);
         }
 
         data.resetHighlighting();
@@ -221,4 +726,9 @@ namespace Algorithms {
             stats.isSorting = false;
         }
     }
-}
\ No newline at end of file
+
+#define INSTANTIATE(Key) template class BasicQuickSort<Key>;
+    FOR_EACH_KEY_TYPE(INSTANTIATE)
+#undef INSTANTIATE
+
+}
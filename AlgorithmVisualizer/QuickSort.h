@@ -1,22 +1,80 @@
 #pragma once
 #include "Algorithm.h"
-#include <stack>
+#include <utility>
+#include <vector>
 
 namespace Algorithms {
-    class QuickSort : public Algorithm {
+    // Classic always takes the last element as pivot.
+    // Introsort takes a median-of-three or ninther pivot, handles the smaller side first,
+    // insertion sorts small ranges and falls back to heapsort past 2*log2(n) levels.
+    enum class QuickSortMode { Classic, Introsort };
+
+    template <typename Key, typename Compare = typename Utils::KeyTraits<Key>::Compare>
+    class BasicQuickSort : public BasicAlgorithm<Key, Compare> {
     public:
-        QuickSort();
+        using Mode = QuickSortMode;
+
+        BasicQuickSort(Mode mode = Mode::Classic);
+
+        void step(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) override;
 
-        void step(Visualization::VisualizationData& data, SortingStats& stats) override;
+        void run(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats) override;
 
-        void run(Visualization::VisualizationData& data, SortingStats& stats) override;
+        void runInstrumented(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats, Instrumentation instrumentation) override;
+
+        bool supportsInstrumentation() const override { return true; }
 
         bool isComplete(const SortingStats& stats) const override;
 
         void reset() override;
 
+        const char* getPhaseName() const override;
+
     private:
-        std::stack<std::pair<int, int>> sortStack;
+        enum class Phase { Next, Pivot, Partition, Heapsort, Insertion };
+
+        struct Range {
+            int low;
+            int high;
+            int depth;
+        };
+
+        // A change to ranges made by a step: a pushed range, or a popped one kept to push back
+        struct RangeOp {
+            bool pushed;
+            Range range;
+        };
+
+        // Everything but the array and ranges a step may change, saved before each step so Step
+        // Backward can put it back; ranges are put back by undoing the steps' RangeOps
+        struct StepState {
+            Phase phase;
+            bool started;
+            bool partitioning;
+            bool swapped;
+            int currentLow;
+            int currentHigh;
+            int pivotIndex;
+            int i;
+            int j;
+            int depth;
+            int pivotPairIndex;
+            int heapSize;
+            int heapBuild;
+            int siftIndex;
+            int insertIndex;
+            int insertPosition;
+            size_t firstRangeOp;
+        };
+
+        static constexpr int INSERTION_THRESHOLD = 16;
+        static constexpr int NINTHER_THRESHOLD = 40;
+
+        Mode mode;
+
+        // Ranges left to sort, the next one last; Classic leaves depth at 0
+        std::vector<Range> ranges;
+        bool started = false;
         int currentLow = 0;
         int currentHigh = 0;
         int pivotIndex = 0;
@@ -24,8 +82,52 @@ namespace Algorithms {
         int j = 0;
         bool partitioning = false;
         bool swapped = false;
-        
-        int partition(Visualization::VisualizationData& data, SortingStats& stats, int low, int high);
-        void stepPartition(Visualization::VisualizationData& data, SortingStats& stats);
+
+        // Introsort state
+        Phase phase = Phase::Next;
+        int depth = 0;
+        int depthLimit = 0;
+        std::pair<int, int> pivotPairs[12];
+        int pivotPairCount = 0;
+        int pivotPairIndex = 0;
+        int medianIndex = 0;
+        int heapSize = 0;
+        int heapBuild = 0;
+        int siftIndex = -1;
+        int insertIndex = 0;
+        int insertPosition = 0;
+
+        // Undo records of the steps in stats.history, kept only while it is recorded
+        std::vector<StepState> stepStates;
+        std::vector<RangeOp> rangeOps;
+
+        void saveStep(const SortingStats& stats);
+        void restoreStep(SortingStats& stats);
+        void pushRange(const Range& range, bool record);
+        Range popRange(bool record);
+
+        void stepPartition(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
+        void stepIntrosort(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
+        void startRange(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
+        void stepPivot(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
+        void stepHeapsort(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
+        void stepInsertion(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
+        void pushRanges(int leftLow, int leftHigh, int rightLow, int rightHigh, bool record);
+        // The median network of the current range, from its bounds alone
+        void choosePivotPairs();
+
+        // The phases of step() in plain loops, a whole range at a time; the policy decides what they report
+        template <typename Policy>
+        void sortAll(Visualization::BasicVisualizationData<Key>& data, SortingStats& stats);
+        template <typename Policy>
+        void compareExchange(std::vector<Key>& array, int a, int b, Probe<Policy, Key>& probe);
+        template <typename Policy>
+        int partitionRange(std::vector<Key>& array, int low, int high, Probe<Policy, Key>& probe);
+        template <typename Policy>
+        void heapsortRange(std::vector<Key>& array, int low, int high, Probe<Policy, Key>& probe);
+        template <typename Policy>
+        void insertionSortRange(std::vector<Key>& array, int low, int high, Probe<Policy, Key>& probe);
     };
-}
\ No newline at end of file
+
+    using QuickSort = BasicQuickSort<int>;
+}
@@ -0,0 +1,319 @@
+#include "RadixSort.h"
+#include <algorithm>
+
+namespace Algorithms {
+
+    RadixSort::RadixSort(Mode mode) : Algorithm(mode == Mode::MSD ? "Radix Sort (MSD)" : "Radix Sort (LSD)"), mode(mode) {
+        // Wide digits save a pass over the whole array; MSD keeps them narrow because
+        // every bucket it refines pays for a full histogram
+        digitBits = mode == Mode::MSD ? 8 : 11;
+        radix = 1 << digitBits;
+        digits = (32 + digitBits - 1) / digitBits;
+        for (auto& histogram : histograms) {
+            histogram.assign(radix, 0);
+        }
+        lines.assign(static_cast<size_t>(radix) * LINE, 0);
+        lineFill.assign(radix, 0);
+        bucketCounts.assign(radix, 0);
+        bucketOffsets.assign(radix, 0);
+        reset();
+    }
+
+    void RadixSort::reset() {
+        pass = 0;
+    }
+
+    const char* RadixSort::getPhaseName() const {
+        static const char* lsdPhases[] = {
+            "Counting digit histograms",
+            "Digit pass 1 (bits 0-10)",
+            "Digit pass 2 (bits 11-21)",
+            "Digit pass 3 (bits 22-31)",
+        };
+        static const char* msdPhases[] = {
+            "Level 1 (bits 24-31)",
+            "Level 2 (bits 16-23)",
+            "Level 3 (bits 8-15)",
+            "Level 4 (bits 0-7)",
+        };
+
+        if (mode == Mode::MSD) {
+            return msdPhases[std::min(pass, digits - 1)];
+        }
+        return lsdPhases[std::min(pass, digits)];
+    }
+
+    bool RadixSort::isComplete(const SortingStats& stats) const {
+        return stats.sortingComplete;
+    }
+
+    void RadixSort::step(Visualization::VisualizationData& data, SortingStats& stats) {
+        if (stats.sortingComplete || !stats.isSorting) {
+            return;
+        }
+
+        // A pass rewrites the whole array, so the pass number is all there is to restore
+        if (stats.stateRestored) {
+            pass = stats.lastRestoredK;
+            stats.stateRestored = false;
+        }
+        data.resetHighlighting();
+
+        stats.saveState(0, 0, false, pass);
+        stats.perf.setPhase(getPhaseName());
+
+        if (buffer.size() != data.getValues().size()) {
+            buffer.resize(data.size());
+        }
+
+        if (mode == Mode::MSD) {
+            stepMSD(data, stats);
+        }
+        else {
+            stepLSD(data, stats);
+        }
+
+        if (stats.steppingMode) {
+            stats.isSorting = false;
+        }
+    }
+
+    void RadixSort::stepLSD(Visualization::VisualizationData& data, SortingStats& stats) {
+        auto& array = data.getValues();
+        size_t n = array.size();
+
+        if (pass == 0) {
+            // Digit counts do not depend on the order, so these stay valid for every later pass
+            countHistograms(array);
+            stats.currentStep++;
+            pass++;
+            return;
+        }
+
+        if (pass > digits) {
+            stats.sortingComplete = true;
+            stats.isSorting = false;
+            return;
+        }
+
+        int digit = pass - 1;
+        const auto& histogram = histograms[digit];
+        stats.currentStep++;
+        pass++;
+
+        // When every value has the same digit the pass would not move anything
+        if (std::find(histogram.begin(), histogram.end(), n) != histogram.end()) {
+            return;
+        }
+
+        std::vector<size_t>& offsets = bucketOffsets;
+        size_t sum = 0;
+        for (int bucket = 0; bucket < radix; bucket++) {
+            offsets[bucket] = sum;
+            sum += histogram[bucket];
+        }
+
+        stats.recordRange(0, static_cast<int>(n) - 1);
+        scatter(array.data(), buffer.data(), 0, n, digit * digitBits, offsets);
+
+        if (stats.recordHistory || stats.trace) {
+            commitRange(data, stats, 0, static_cast<int>(n));
+        }
+        else {
+            // Nothing to record: the buffer simply becomes the array
+            array.swap(buffer);
+            data.markAllDirty();
+            stats.swaps += n;
+            stats.writes += n;
+        }
+    }
+
+    void RadixSort::stepMSD(Visualization::VisualizationData& data, SortingStats& stats) {
+        auto& array = data.getValues();
+        int n = data.size();
+
+        if (pass >= digits) {
+            stats.sortingComplete = true;
+            stats.isSorting = false;
+            return;
+        }
+
+        // After pass levels the array is ordered by its top pass digits, so the buckets to
+        // refine are the runs of equal prefix; small runs were insertion sorted already
+        int shift = (digits - 1 - pass) * digitBits;
+        int prefixShift = shift + digitBits;
+        bool refined = false;
+
+        if (pass == 0 && n <= INSERTION_THRESHOLD) {
+            insertionSort(data, stats, 0, n);
+        }
+
+        for (int first = 0; first < n;) {
+            int last = first + 1;
+            if (pass > 0) {
+                uint32_t prefix = keyOf(array[first]) >> prefixShift;
+                while (last < n && keyOf(array[last]) >> prefixShift == prefix) {
+                    last++;
+                }
+            }
+            else {
+                last = n;
+            }
+
+            if (last - first > INSERTION_THRESHOLD) {
+                partitionRange(data, stats, first, last, shift);
+                refined = true;
+            }
+            first = last;
+        }
+
+        stats.currentStep++;
+        pass++;
+
+        // No bucket was big enough to split, so everything is in order
+        if (!refined) {
+            pass = digits;
+        }
+    }
+
+    void RadixSort::partitionRange(Visualization::VisualizationData& data, SortingStats& stats, int first, int last, int shift) {
+        auto& array = data.getValues();
+
+        std::vector<size_t>& counts = bucketCounts;
+        std::vector<size_t>& offsets = bucketOffsets;
+        std::fill(counts.begin(), counts.end(), 0);
+        for (int i = first; i < last; i++) {
+            counts[(keyOf(array[i]) >> shift) & (radix - 1)]++;
+        }
+
+        size_t sum = first;
+        for (int bucket = 0; bucket < radix; bucket++) {
+            offsets[bucket] = sum;
+            sum += counts[bucket];
+        }
+
+        stats.recordRange(first, last - 1);
+        scatter(array.data(), buffer.data(), first, last, shift, offsets);
+        commitRange(data, stats, first, last);
+
+        // Finish the small buckets now so later levels only look at the large ones.
+        // The scatter advanced each offset to the end of its bucket.
+        for (int bucket = 0; bucket < radix; bucket++) {
+            int bucketLast = static_cast<int>(offsets[bucket]);
+            int bucketFirst = bucketLast - static_cast<int>(counts[bucket]);
+            if (bucketLast - bucketFirst > 1 && bucketLast - bucketFirst <= INSERTION_THRESHOLD) {
+                insertionSort(data, stats, bucketFirst, bucketLast);
+            }
+        }
+    }
+
+    void RadixSort::insertionSort(Visualization::VisualizationData& data, SortingStats& stats, int first, int last) {
+        auto& array = data.getValues();
+        for (int i = first + 1; i < last; i++) {
+            for (int j = i; j > first; j--) {
+                stats.comparisons++;
+                if (array[j - 1] <= array[j]) {
+                    break;
+                }
+                data.swap(j - 1, j);
+                stats.recordSwap(j - 1, j);
+                stats.swaps++;
+            }
+        }
+    }
+
+    void RadixSort::commitRange(Visualization::VisualizationData& data, SortingStats& stats, int first, int last) {
+        auto& array = data.getValues();
+        for (int i = first; i < last; i++) {
+            if (array[i] != buffer[i]) {
+                stats.recordWrite(i, array[i], buffer[i]);
+            }
+        }
+        std::copy(buffer.begin() + first, buffer.begin() + last, array.begin() + first);
+        data.markDirty(first, last - 1);
+        stats.swaps += last - first;
+        stats.writes += last - first;
+    }
+
+    void RadixSort::countHistograms(const std::vector<int>& array) {
+        // Two sets of counters take alternate values, so a run of equal digits does not
+        // keep incrementing the counter whose store is still in flight
+        std::vector<uint32_t> counts(2 * digits * radix, 0);
+        uint32_t* even = counts.data();
+        uint32_t* odd = counts.data() + digits * radix;
+        uint32_t mask = radix - 1;
+
+        size_t n = array.size();
+        size_t i = 0;
+        for (; i + 1 < n; i += 2) {
+            uint32_t a = keyOf(array[i]);
+            uint32_t b = keyOf(array[i + 1]);
+            for (int digit = 0; digit < digits; digit++) {
+                even[digit * radix + ((a >> (digit * digitBits)) & mask)]++;
+                odd[digit * radix + ((b >> (digit * digitBits)) & mask)]++;
+            }
+        }
+        if (i < n) {
+            uint32_t a = keyOf(array[i]);
+            for (int digit = 0; digit < digits; digit++) {
+                even[digit * radix + ((a >> (digit * digitBits)) & mask)]++;
+            }
+        }
+
+        for (int digit = 0; digit < digits; digit++) {
+            for (int bucket = 0; bucket < radix; bucket++) {
+                histograms[digit][bucket] = even[digit * radix + bucket] + odd[digit * radix + bucket];
+            }
+        }
+    }
+
+    void RadixSort::scatter(const int* source, int* destination, size_t first, size_t last, int shift, std::vector<size_t>& offsets) {
+        std::fill(lineFill.begin(), lineFill.end(), 0);
+        uint32_t mask = radix - 1;
+
+        for (size_t i = first; i < last; i++) {
+            int value = source[i];
+            int bucket = (keyOf(value) >> shift) & mask;
+            int* line = lines.data() + bucket * LINE;
+            line[lineFill[bucket]++] = value;
+
+            // A full line goes out in one burst instead of sixteen scattered stores
+            if (lineFill[bucket] == LINE) {
+                std::copy(line, line + LINE, destination + offsets[bucket]);
+                offsets[bucket] += LINE;
+                lineFill[bucket] = 0;
+            }
+        }
+
+        for (int bucket = 0; bucket < radix; bucket++) {
+            const int* line = lines.data() + bucket * LINE;
+            std::copy(line, line + lineFill[bucket], destination + offsets[bucket]);
+            offsets[bucket] += lineFill[bucket];
+        }
+    }
+
+    void RadixSort::run(Visualization::VisualizationData& data, SortingStats& stats) {
+        if (stats.currentStep == 0) {
+            reset();
+            stats.reset();
+        }
+        stats.isSorting = true;
+
+        if (stats.steppingMode) {
+            step(data, stats);
+            return;
+        }
+
+        while (stats.isSorting && !stats.sortingComplete) {
+            step(data, stats);
+            pace(stats);
+        }
+
+        data.resetHighlighting();
+        if (stats.isSorting) {
+            stats.sortingComplete = true;
+            stats.isSorting = false;
+        }
+    }
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "Algorithm.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Algorithms {
+
+    // Radix sort on the digits of the value with its sign bit flipped, so negative
+    // values order before positive ones. Every step is one digit pass over the array.
+    class RadixSort : public Algorithm {
+    public:
+        // LSD uses three 11-bit digits: it counts all their histograms in one pass, then
+        // scatters once per digit, skipping digits every value shares. MSD uses four 8-bit
+        // digits, partitions by the top one first and refines the buckets level by level;
+        // buckets of up to 32 values are insertion sorted.
+        enum class Mode { LSD, MSD };
+
+        RadixSort(Mode mode = Mode::LSD);
+
+        void step(Visualization::VisualizationData& data, SortingStats& stats) override;
+
+        void run(Visualization::VisualizationData& data, SortingStats& stats) override;
+
+        bool isComplete(const SortingStats& stats) const override;
+
+        void reset() override;
+
+        const char* getPhaseName() const override;
+
+    private:
+        static constexpr int MAX_DIGITS = 4;
+        static constexpr int INSERTION_THRESHOLD = 32;
+        // Values per write-combining line: one 64-byte cache line of ints
+        static constexpr int LINE = 16;
+
+        Mode mode;
+        int digitBits;
+        int radix;
+        int digits;
+
+        // LSD: 0 counts the histograms, 1..digits scatter by digit pass - 1.
+        // MSD: 0..digits-1 partition by digit digits - 1 - pass.
+        int pass = 0;
+        std::array<std::vector<size_t>, MAX_DIGITS> histograms;
+        std::vector<int> buffer;
+        std::vector<size_t> bucketCounts;
+        std::vector<size_t> bucketOffsets;
+
+        // Software write combining: values are gathered per bucket in cache-resident
+        // lines and written to the destination a whole line at a time
+        std::vector<int> lines;
+        std::vector<uint8_t> lineFill;
+
+        static uint32_t keyOf(int value) { return static_cast<uint32_t>(value) ^ 0x80000000u; }
+
+        void countHistograms(const std::vector<int>& array);
+        void scatter(const int* source, int* destination, size_t first, size_t last, int shift, std::vector<size_t>& offsets);
+        void stepLSD(Visualization::VisualizationData& data, SortingStats& stats);
+        void stepMSD(Visualization::VisualizationData& data, SortingStats& stats);
+        void partitionRange(Visualization::VisualizationData& data, SortingStats& stats, int first, int last, int shift);
+        void insertionSort(Visualization::VisualizationData& data, SortingStats& stats, int first, int last);
+        void commitRange(Visualization::VisualizationData& data, SortingStats& stats, int first, int last);
+    };
+
+}
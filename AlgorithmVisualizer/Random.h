@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+
+namespace Utils {
+
+    // SplitMix64: a tiny generator used to spread one 64-bit seed over a larger state
+    class SplitMix64 {
+    public:
+        explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+        uint64_t next() {
+            state += 0x9E3779B97F4A7C15ull;
+            return mix(state);
+        }
+
+        // Bijective finalizer; nearby inputs give unrelated outputs
+        static uint64_t mix(uint64_t value) {
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+            return value ^ (value >> 31);
+        }
+
+    private:
+        uint64_t state;
+    };
+
+    // xoshiro256**: a few shifts and rotates per number, several times faster than mt19937 and
+    // good enough for any test input. The stream picks an independent sequence for the same seed,
+    // so parallel generators can each take one and still reproduce the same output.
+    class Xoshiro256 {
+    public:
+        using result_type = uint64_t;
+
+        explicit Xoshiro256(uint64_t seed, uint64_t stream = 0) {
+            SplitMix64 seeder(SplitMix64::mix(seed ^ SplitMix64::mix(stream)));
+            for (uint64_t& word : state) {
+                word = seeder.next();
+            }
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        result_type operator()() { return next(); }
+
+        uint64_t next() {
+            uint64_t result = rotate(state[1] * 5, 7) * 9;
+            uint64_t shifted = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= shifted;
+            state[3] = rotate(state[3], 45);
+            return result;
+        }
+
+        // Uniform in [0, bound) for bound <= 2^32, by multiply-shift instead of a division.
+        // The bias is at most bound / 2^32, far below anything a sort could notice.
+        uint64_t nextBelow(uint64_t bound) {
+            return ((next() >> 32) * bound) >> 32;
+        }
+
+        // Uniform in [0, 1) with 53 random bits
+        double nextDouble() {
+            return static_cast<double>(next() >> 11) * 0x1.0p-53;
+        }
+
+    private:
+        uint64_t state[4];
+
+        static uint64_t rotate(uint64_t value, int bits) {
+            return (value << bits) | (value >> (64 - bits));
+        }
+    };
+
+}
@@ -1,99 +1,212 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include "Renderer.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
 #include <cstring>
-#include <fstream>
-#include <sstream>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace Rendering {
 
     Renderer::Renderer() {}
 
-    bool Renderer::renderControls(Visualization::VisualizationData& data, Algorithms::SortingStats& stats, int& arraySize, bool isStepsEnable) {
+    void Renderer::openDataset(Visualization::VisualizationData& data, int& arraySize) {
+        auto dataset = std::make_shared<Utils::Dataset>();
+        std::string error;
+        if (!dataset->open(datasetPath, error)) {
+            fileMessage = "Error: " + error;
+            ImGui::OpenPopup("File Error");
+            return;
+        }
+        const Utils::DatasetHeader header = dataset->getHeader();
+        if (header.count > static_cast<uint64_t>(INT_MAX)) {
+            fileMessage = "Error: the dataset holds more than " + std::to_string(INT_MAX) + " values";
+            ImGui::OpenPopup("File Error");
+            return;
+        }
+
+        // The data reads straight from the mapping until the first write copies it
+        std::span<const int> values = dataset->getValues();
+        data.shareValues(std::move(dataset), values);
+        data.origin = { header.seed, header.distribution };
+        arraySize = data.size();
+    }
+
+    void Renderer::exportDataset(const Visualization::VisualizationData& data, const Algorithms::SortingStats& stats) {
+        Utils::DatasetHeader header;
+        header.seed = data.origin.seed;
+        header.distribution = data.origin.distribution;
+        header.flags = stats.sortingComplete ? Utils::Dataset::SORTED : 0;
+
+        std::string error;
+        if (!Utils::Dataset::write(datasetPath, header, data.getValues(), error)) {
+            fileMessage = "Error: " + error;
+            ImGui::OpenPopup("File Error");
+        }
+    }
+
+    std::string Renderer::describeLoadFailure(const Utils::LoadResult& result) {
+        if (!result.failure.empty()) {
+            return "Error: " + result.failure;
+        }
+        std::string message = std::to_string(result.errorCount) + " invalid value(s):";
+        for (const auto& error : result.errors) {
+            message += "\n  at byte " + std::to_string(error.offset) + ": " + error.message;
+        }
+        if (result.errorCount > result.errors.size()) {
+            message += "\n  ...";
+        }
+        return message;
+    }
+
+    void Renderer::renderValueInput(Visualization::VisualizationData& data, int& arraySize) {
+        ImGui::InputTextWithHint("##Num", "Enter numbers separated by spaces or commas (e.g., 5 3 8 1 9)", data.buf, 256);
+        if (ImGui::Button("Enter", ImVec2(200, 30))) {
+            if (strlen(data.buf) > 0) {
+                Utils::LoadResult result;
+                Utils::NumberLoader::parse(data.buf, strlen(data.buf), result);
+                if (result.succeeded()) {
+                    data.setValues(std::move(result.values));
+                    arraySize = data.size();
+                }
+                else {
+                    fileMessage = describeLoadFailure(result);
+                    ImGui::OpenPopup("File Error");
+                }
+            }
+        }
+    
+        ImGui::InputTextWithHint("##Path", "Enter CSV file path (e.g., C:\\data\\numbers.csv)", data.buf1, 256);
+        // The file is parsed on the scheduler; the array changes only once it is all read without errors
+        if (loader.isLoading()) {
+            ImGui::ProgressBar(loader.getProgress(), ImVec2(200, 0));
+            ImGui::SameLine();
+            if (ImGui::Button("Cancel Load")) {
+                loader.cancel();
+            }
+        }
+        else if (ImGui::Button("Load File", ImVec2(200, 30))) {
+            loader.start(data.buf1);
+        }
+
+        if (loader.isFinished()) {
+            auto& result = loader.getResult();
+            if (result.succeeded()) {
+                data.setValues(std::move(result.values));
+                arraySize = data.size();
+            }
+            else if (!result.cancelled) {
+                fileMessage = describeLoadFailure(result);
+                ImGui::OpenPopup("File Error");
+            }
+            loader.clear();
+        }
+    }
+
+    void Renderer::stepBackward(Visualization::VisualizationData& data, Algorithms::SortingStats& stats) {
+        // Undo the last step by applying the inverse of its recorded operations
+        if (stats.stepBackward(data)) {
+            data.resetHighlighting();
+
+            // Explicitly set highlighting for the elements being compared
+            // This ensures the highlighting is visible when stepping backward
+            int j = stats.lastRestoredJ;
+            if (j >= 0 && j + 1 < data.size()) {
+                data.setComparing(j);
+                data.setComparing(j + 1);
+
+                // If a swap occurred, also set the swapping flag
+                if (stats.lastRestoredSwapped) {
+                    data.setSwapping(j);
+                    data.setSwapping(j + 1);
+                }
+            }
+        }
+    }
+
+    void Renderer::renderDatasetControls(Visualization::VisualizationData& data, const Algorithms::SortingStats& stats, int& arraySize) {
+        ImGui::Separator();
+        ImGui::InputTextWithHint("##Dataset", "Enter dataset file path (e.g., C:\\data\\input.avdata)", datasetPath, sizeof(datasetPath));
+        if (!stats.sortingComplete) {
+            if (ImGui::Button("Open Dataset", ImVec2(200, 30))) {
+                openDataset(data, arraySize);
+            }
+            ImGui::SameLine();
+        }
+        if (ImGui::Button("Export Dataset", ImVec2(200, 30))) {
+            exportDataset(data, stats);
+        }
+    }
+
+    template <typename Key>
+    bool Renderer::renderControls(Visualization::BasicVisualizationData<Key>& data, Algorithms::SortingStats& stats, Algorithms::SortingWorker& worker, int& arraySize,
+        Utils::Distribution& distribution, Utils::GeneratorOptions& generatorOptions, bool isStepsEnable) {
         bool generateNewArray = false;
         
         ImGui::Text("Sorting Algorithm Controls");
         ImGui::Separator();
 
+        // Scheduling priority on the shared pool; changing it never touches the data
+        int priority = static_cast<int>(worker.getPriority());
+        if (ImGui::Combo("Priority", &priority, "Low\0Normal\0High\0")) {
+            worker.setPriority(static_cast<Algorithms::Scheduler::Priority>(priority));
+        }
+
+        // While the worker runs, the data and stats are its own; the only controls send it commands.
+        // Past this point they belong to this thread until the next command is sent, so every send returns.
+        if (!worker.isIdle()) {
+            ImGui::Text("Execution Speed");
+            if (ImGui::SliderInt("Delay (ms)", &delaySetting, 1, 500, "%d ms")) {
+                worker.setSpeed(delaySetting);
+            }
+            if (ImGui::Button("Stop Sorting", ImVec2(200, 30))) {
+                worker.pause();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Cancel", ImVec2(95, 30))) {
+                worker.cancel();
+            }
+            return false;
+        }
+        delaySetting = stats.speedFactor;
+
         // Array size slider
         if (!stats.isSorting && !stats.sortingComplete) {
-            if (ImGui::SliderInt("Array Size", &arraySize, 10, 200)) {
+            if (ImGui::SliderInt("Array Size", &arraySize, 10, 10000000, "%d", ImGuiSliderFlags_Logarithmic)) {
                 data.resize(arraySize);
 				generateNewArray = true;
             }
             
+            int distributionIndex = static_cast<int>(distribution);
+            if (ImGui::Combo("Input", &distributionIndex, [](void*, int index) {
+                return Utils::ArrayGenerator::getDistributionName(static_cast<Utils::Distribution>(index));
+            }, nullptr, static_cast<int>(Utils::Distribution::Count))) {
+                distribution = static_cast<Utils::Distribution>(distributionIndex);
+                generateNewArray = true;
+            }
+            // The same seed gives the same array again, e.g. to compare runs
+            if (ImGui::InputScalar("Seed", ImGuiDataType_U64, &generatorOptions.seed)) {
+                generateNewArray = true;
+            }
+
             if (ImGui::Button("Generate New Array", ImVec2(200, 30))) {
+                generatorOptions.seed = Utils::ArrayGenerator::randomSeed();
 				generateNewArray = true;
             }
            
         
-            ImGui::InputTextWithHint("##Num", "Enter numbers separated by spaces (e.g., 5 3 8 1 9)", data.buf, 256);
-            if (ImGui::Button("Enter", ImVec2(200, 30))) {
-                if (strlen(data.buf) > 0) {
-                    data.array.clear();
-                    
-                    char bufCopy[256];
-                    strcpy(bufCopy, data.buf);
-                    
-                    char* token = std::strtok(bufCopy, " ");
-
-                    while (token != nullptr) {
-                        Visualization::ArrayElement elem{ std::atoi(token), false, false };
-                        data.array.push_back(elem);
-
-                        token = std::strtok(NULL, " ");
-                    }
-                }
-            }
-        
-            ImGui::InputTextWithHint("##Path", "Enter CSV file path (e.g., C:\\data\\numbers.csv)", data.buf1, 256);
-            if (ImGui::Button("Input", ImVec2(200, 30))) {
-                std::ifstream file(data.buf1);
-                std::string line;
-
-                if (file.is_open()) {
-                    data.array.clear();
-                
-                    while (std::getline(file, line)) {
-                        std::stringstream strstream(line);
-                        std::string value;
-                        while (std::getline(strstream, value, ' ')) {
-                            const char* v1 = value.c_str();
-                            Visualization::ArrayElement elem{ std::atoi(v1), false, false };
-                            data.array.push_back(elem);
-                        }
-                    }
-                    file.close();
-                }
-                else {
-                    ImGui::OpenPopup("File Error");
-                }
-            }
-
-            if (ImGui::BeginPopupModal("File Error", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
-                ImGui::Text("Error: Could not open the file.\nPlease check the path and try again.");
-                ImGui::Separator();
-
-                if (ImGui::Button("OK", ImVec2(120, 0))) {
-                    ImGui::CloseCurrentPopup();
-                }
-                ImGui::EndPopup();
-
+            // Numbers typed in or loaded from files are ints, as are datasets
+            if constexpr (std::is_same_v<Key, int>) {
+                renderValueInput(data, arraySize);
             }
         }
         // Execution mode checkbox
         if (!stats.isSorting && !stats.sortingComplete && isStepsEnable) {
-            // Store previous stepping mode state
-            bool prevSteppingMode = stats.steppingMode;
-            
-            // Toggle stepping mode
+            // Toggle stepping mode; leaving it keeps the algorithm state for Resume
             ImGui::Checkbox("Step-by-Step Mode", &stats.steppingMode);
-            
-            // If we're exiting stepping mode, make sure we preserve the algorithm state
-            // but don't start sorting automatically
-            if (prevSteppingMode && !stats.steppingMode) {
-                stats.isSorting = false;
-            }
             if (stats.steppingMode) {
                 ImGui::SameLine();
                 ImGui::TextDisabled("(?)");
@@ -114,37 +227,29 @@ namespace Rendering {
                 // Speed control slider
                 ImGui::Separator();
                 ImGui::Text("Execution Speed");
-                ImGui::SliderInt("Delay (ms)", &stats.speedFactor, 1, 500, "%d ms");
+                if (ImGui::SliderInt("Delay (ms)", &delaySetting, 1, 500, "%d ms")) {
+                    stats.speedFactor = delaySetting;
+                }
             }
 
             if (!stats.isSorting && !stats.sortingComplete && stats.steppingMode == false) {
                 // If we have a currentStep > 0, show Resume button instead of Start
                 if (stats.currentStep > 0) {
                     if (ImGui::Button("Resume Sorting", ImVec2(200, 30))) {
-                        stats.isSorting = true;
-                        stats.sortingComplete = false;
+                        worker.resume();
+                        return false;
                     }
                 } else {
                     if (ImGui::Button("Start Sorting", ImVec2(200, 30))) {
-                        stats.isSorting = true;
-                        stats.sortingComplete = false;
-                        
-                        if (stats.currentStep == 0) {
-                            stats.comparisons = 0;
-                            stats.swaps = 0;
-                            stats.history.clear();
-                        }
+                        worker.start();
+                        return false;
                     }
                 }
             }
-            else if (stats.isSorting && stats.steppingMode == false) {
-                if (ImGui::Button("Stop Sorting", ImVec2(200, 30))) {
-                    stats.isSorting = false;
-                }
-            }
             else if (stats.sortingComplete) {
                 if (ImGui::Button("Reset", ImVec2(200, 30))) {
-                    stats.reset();
+                    worker.cancel();
+                    return false;
                 }
             }
             
@@ -153,105 +258,499 @@ namespace Rendering {
                 ImGui::Separator();
                 ImGui::Text("Stepping Controls");
                 
-                // Step forward button
+                // Step forward button; the worker runs the steps and pauses again
                 if (ImGui::Button("Step Forward", ImVec2(95, 30))) {
-                    stats.isSorting = true; // This will trigger one step and then pause again
+                    worker.step(stepCount);
+                    return false;
                 }
                 
-                // Step backward button (only enabled if we have history)
-                ImGui::SameLine();
-                if (ImGui::Button("Step Backward", ImVec2(95, 30)) && stats.canStepBackward() && !stats.history.empty()) {
-                    // Get the previous state
-                    if (stats.currentStep > 0) {
-                        stats.currentStep--;
-                        
-                        // Pop the last state from history
-                        auto& prevState = stats.history.back();
-                        
-                        // Restore algorithm state
-                        stats.comparisons = prevState.comparisons;
-                        stats.swaps = prevState.swaps;
-                        
-                        // Restore array state with highlighting
-                        auto& array = data.getArray();
-                        array = prevState.array;
-                        
-                        // Explicitly set highlighting for the elements being compared
-                        // This ensures the highlighting is visible when stepping backward
-                        if (prevState.j < array.size() && prevState.j + 1 < array.size()) {
-                            array[prevState.j].isComparing = true;
-                            array[prevState.j + 1].isComparing = true;
-                            
-                            // If a swap occurred, also set the swapping flag
-                            if (prevState.swapped) {
-                                array[prevState.j].isSwapping = true;
-                                array[prevState.j + 1].isSwapping = true;
-                            }
-                        }
-                        
-                        // Store algorithm state variables for BubbleSort to retrieve
-                        stats.lastRestoredI = prevState.i;
-                        stats.lastRestoredJ = prevState.j;
-                        stats.lastRestoredSwapped = prevState.swapped;
-                        stats.stateRestored = true;
-                        
-                        // Remove the state from history
-                        stats.history.pop_back();
+                // Step backward button (only enabled if we have history); the undo log holds ints
+                if constexpr (std::is_same_v<Key, int>) {
+                    ImGui::SameLine();
+                    if (ImGui::Button("Step Backward", ImVec2(95, 30)) && stats.canStepBackward()) {
+                        stepBackward(data, stats);
                     }
                 }
+
+                ImGui::SetNextItemWidth(95);
+                if (ImGui::InputInt("Steps per click", &stepCount)) {
+                    stepCount = std::max(stepCount, 1);
+                }
             }
         }
 
+        // Binary datasets: open one as the array without copying it, or save the array as it is now, e.g. sorted
+        if constexpr (std::is_same_v<Key, int>) {
+            if (!stats.isSorting) {
+                renderDatasetControls(data, stats, arraySize);
+            }
+        }
+
+        if (ImGui::BeginPopupModal("File Error", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+            ImGui::TextUnformatted(fileMessage.c_str());
+            ImGui::Separator();
+
+            if (ImGui::Button("OK", ImVec2(120, 0))) {
+                ImGui::CloseCurrentPopup();
+            }
+            ImGui::EndPopup();
+        }
+
         return generateNewArray;
     }
 
+#define INSTANTIATE(Key) template bool Renderer::renderControls(Visualization::BasicVisualizationData<Key>&, Algorithms::SortingStats&, \
+        Algorithms::SortingWorker&, int&, Utils::Distribution&, Utils::GeneratorOptions&, bool);
+    FOR_EACH_KEY_TYPE(INSTANTIATE)
+#undef INSTANTIATE
+
     void Renderer::renderStatistics(const Algorithms::SortingStats& stats, int arraySize) {
         ImGui::Separator();
         ImGui::Text("Array Size: %d", arraySize);
-        ImGui::Text("Comparisons: %d", stats.comparisons);
-        ImGui::Text("Swaps: %d", stats.swaps);
-        ImGui::Text("Current Step: %d", stats.currentStep);
+        ImGui::Text("Comparisons: %lld", stats.comparisons);
+        ImGui::Text("Swaps: %lld", stats.swaps);
+        ImGui::Text("Writes (counted in swaps): %lld", stats.writes);
+        if (stats.bytesRead > 0 || stats.bytesWritten > 0) {
+            double elements = std::max(arraySize, 1);
+            ImGui::Text("Temporary files: %.1f MiB read, %.1f MiB written (%.1f / %.1f bytes per element)",
+                stats.bytesRead / 1048576.0, stats.bytesWritten / 1048576.0, stats.bytesRead / elements, stats.bytesWritten / elements);
+        }
+        ImGui::Text("Current Step: %lld", stats.currentStep);
         ImGui::Text("Status: %s", stats.isSorting ? "Sorting..." : (stats.sortingComplete ? "Sorting Complete" : "Ready"));
+
+        // Load balance of parallel algorithms, one row per worker in its range color
+        if (!stats.workers.empty() && ImGui::BeginTable("Workers", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit)) {
+            ImGui::TableSetupColumn("Worker");
+            ImGui::TableSetupColumn("Tasks");
+            ImGui::TableSetupColumn("Comparisons");
+            ImGui::TableSetupColumn("Swaps");
+            ImGui::TableSetupColumn("Steals");
+            ImGui::TableSetupColumn("Idle");
+            ImGui::TableHeadersRow();
+            for (size_t id = 0; id < stats.workers.size(); id++) {
+                const auto& worker = stats.workers[id];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(getGroupColor(static_cast<uint8_t>(id + 1))), "#%zu", id);
+                ImGui::TableNextColumn();
+                ImGui::Text("%lld", worker.tasks.get());
+                ImGui::TableNextColumn();
+                ImGui::Text("%lld", worker.comparisons.get());
+                ImGui::TableNextColumn();
+                ImGui::Text("%lld", worker.swaps.get());
+                ImGui::TableNextColumn();
+                ImGui::Text("%lld", worker.steals.get());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f ms", worker.idleSeconds.get() * 1000.0);
+            }
+            ImGui::EndTable();
+        }
+
+        renderPerfCounters(stats, arraySize);
+    }
+
+    void Renderer::renderPerfCounters(const Algorithms::SortingStats& stats, int arraySize) {
+        std::vector<Utils::PerfPhase> phases = stats.perf.getPhases();
+        if (phases.empty()) {
+            return;
+        }
+
+        constexpr int eventCount = static_cast<int>(Utils::PerfEvent::Count);
+        ImGui::Text("Hardware counters per element");
+        if (!ImGui::BeginTable("PerfCounters", eventCount + 2, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit)) {
+            return;
+        }
+        ImGui::TableSetupColumn("Phase");
+        for (int e = 0; e < eventCount; e++) {
+            ImGui::TableSetupColumn(Utils::getPerfEventName(static_cast<Utils::PerfEvent>(e)));
+            // IPC goes right after the two it is made of
+            if (static_cast<Utils::PerfEvent>(e) == Utils::PerfEvent::Instructions) {
+                ImGui::TableSetupColumn("ipc");
+            }
+        }
+        ImGui::TableHeadersRow();
+
+        double elements = std::max(arraySize, 1);
+        auto renderRow = [elements](const char* name, const Utils::PerfSample& sample) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(name);
+            for (int e = 0; e < eventCount; e++) {
+                auto event = static_cast<Utils::PerfEvent>(e);
+                ImGui::TableNextColumn();
+                if (sample.has(event)) {
+                    ImGui::Text("%.2f", sample.get(event) / elements);
+                }
+                else {
+                    ImGui::TextDisabled("-");
+                }
+                if (event == Utils::PerfEvent::Instructions) {
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", sample.getIpc());
+                }
+            }
+        };
+
+        // A run without phases is its own total
+        if (phases.size() > 1 || !phases[0].name.empty()) {
+            for (const auto& phase : phases) {
+                renderRow(phase.name.empty() ? "(other)" : phase.name.c_str(), phase.sample);
+            }
+        }
+        renderRow("Total", stats.perf.getTotal());
+        ImGui::EndTable();
+    }
+
+    bool Renderer::renderTimelineControls(Algorithms::Timeline& timeline, bool canRecord) {
+        bool recordRequested = false;
+
+        ImGui::Separator();
+        ImGui::Text("Timeline");
+
+        if (timeline.isRecording()) {
+            ImGui::Text("Recording...");
+        }
+        else if (!timeline.isReady()) {
+            if (canRecord && ImGui::Button("Record Timeline", ImVec2(200, 30))) {
+                recordRequested = true;
+            }
+        }
+        else {
+            ImU64 position = timeline.getPosition();
+            ImU64 first = 0;
+            ImU64 last = timeline.getStepCount();
+
+            // Scrubber over the whole recorded run
+            if (ImGui::SliderScalar("Step##Timeline", ImGuiDataType_U64, &position, &first, &last)) {
+                timeline.pause();
+                timeline.seek(position);
+            }
+
+            // Playback decodes the trace at the chosen rate, independent of how fast it was recorded
+            if (ImGui::Button("Reverse", ImVec2(80, 0))) {
+                timeline.play(false);
+            }
+            ImGui::SameLine();
+            if (timeline.isPlaying()) {
+                if (ImGui::Button("Pause", ImVec2(80, 0))) {
+                    timeline.pause();
+                }
+            }
+            else if (ImGui::Button("Play", ImVec2(80, 0))) {
+                timeline.play(true);
+            }
+            ImGui::SameLine();
+            float rate = static_cast<float>(timeline.getPlaybackRate());
+            if (ImGui::SliderFloat("Steps/s", &rate, 1.0f, 1e9f, "%.0f", ImGuiSliderFlags_Logarithmic)) {
+                timeline.setPlaybackRate(rate);
+            }
+
+            if (ImGui::Button("<<", ImVec2(40, 0))) {
+                timeline.seek(0);
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("<", ImVec2(40, 0)) && position > 0) {
+                timeline.seek(position - 1);
+            }
+            ImGui::SameLine();
+            if (ImGui::Button(">", ImVec2(40, 0))) {
+                timeline.seek(position + 1);
+            }
+            ImGui::SameLine();
+            if (ImGui::Button(">>", ImVec2(40, 0))) {
+                timeline.seek(last);
+            }
+
+            ImGui::InputScalar("##TimelineTarget", ImGuiDataType_U64, &timelineTarget);
+            ImGui::SameLine();
+            if (ImGui::Button("Go to Step")) {
+                timeline.seek(timelineTarget);
+            }
+
+            // Checkpoint density follows the memory budget
+            ImGui::SliderInt("Checkpoint Budget", &timelineBudgetMB, 1, 1024, "%d MB");
+            if (ImGui::IsItemDeactivatedAfterEdit()) {
+                timeline.setMemoryBudget(static_cast<size_t>(timelineBudgetMB) * 1024 * 1024);
+            }
+            ImGui::Text("Checkpoints: %zu (every %zu steps), %.1f MB total",
+                timeline.getCheckpointCount(), timeline.getCheckpointInterval(),
+                timeline.getMemoryUsage() / (1024.0 * 1024.0));
+            ImGui::Text("Trace: %.2f MB (%.2f bytes/step)",
+                timeline.getTraceSize() / (1024.0 * 1024.0),
+                last > 0 ? static_cast<double>(timeline.getTraceSize()) / last : 0.0);
+
+            if (ImGui::Button("Close Timeline", ImVec2(200, 30))) {
+                timeline.clear();
+            }
+        }
+
+        return recordRequested;
     }
 
     void Renderer::renderArrayVisualization(const Visualization::VisualizationData& data, const Algorithms::SortingStats& stats) {
+        auto start = std::chrono::steady_clock::now();
+
         ImGui::Separator();
         ImGui::Text("Array Visualization");
+        ImGui::SameLine();
+        ImGui::Checkbox("Pixel Column LOD", &useColumnLod);
+
+        // Frame time of the whole UI and the time this view took to build last frame
+        const ImGuiIO& io = ImGui::GetIO();
+        ImGui::Text("Frame: %.2f ms (%.0f FPS), bars: %.3f ms", 1000.0f / io.Framerate, io.Framerate, visualizationMs);
 
         float windowWidth = ImGui::GetContentRegionAvail().x;
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
 
-        const auto& array = data.getArray();
+        // Past one element per pixel, draw one summary per pixel column instead of one bar per element
+        int columnCount = static_cast<int>(windowWidth);
+        if (useColumnLod && columnCount > 0 && data.size() > columnCount) {
+            barSource = nullptr;
+            updateColumns(data, columnCount);
+            renderColumns(data, stats, windowWidth);
+        }
+        else if (data.size() > 0) {
+            lodSource = nullptr;
 
-        if (!array.empty()) {
-            float barWidth = (windowWidth - (array.size() * padding)) / array.size();
+            // Shade the active range behind the bars
+            if (data.markedLow >= 0 && data.markedHigh >= data.markedLow) {
+                float step = windowWidth / data.size();
+                drawList->AddRectFilled(
+                    ImVec2(origin.x + data.markedLow * step, origin.y),
+                    ImVec2(origin.x + (data.markedHigh + 1) * step, origin.y + maxBarHeight),
+                    IM_COL32(60, 60, 110, 255)
+                );
+            }
 
-            for (int i = 0; i < array.size(); i++) {
-                
-                float barHeight = (array[i].value / 200.0f) * maxBarHeight;
-                float barX = ImGui::GetCursorScreenPos().x + (i * (barWidth + padding));
-                float barY = ImGui::GetCursorScreenPos().y + maxBarHeight - barHeight;
+            updateBars(data, stats, origin, windowWidth);
+            emitBars(drawList);
+        }
 
-                ImU32 barColor = IM_COL32(200, 200, 200, 255); // Default color (gray)
+        ImGui::Dummy(ImVec2(windowWidth, maxBarHeight));
 
-                if (array[i].isSwapping) {
-                    barColor = IM_COL32(255, 0, 0, 255); // Swapping (red)
-                }
-                else if (array[i].isComparing) {
-                    barColor = IM_COL32(255, 165, 0, 255); // Comparing (orange)
-                }
-                else if (stats.sortingComplete) {
-                    barColor = IM_COL32(0, 255, 0, 255); // Sorted (green)
-                }
+        visualizationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
 
-                ImGui::GetWindowDrawList()->AddRectFilled(
-                    ImVec2(barX, barY),
-                    ImVec2(barX + barWidth, barY + barHeight),
-                    barColor
-                );
+    ImU32 Renderer::getBarColor(bool swapping, bool comparing, bool sorted, uint8_t group) {
+        if (swapping) {
+            return IM_COL32(255, 0, 0, 255); // Swapping (red)
+        }
+        if (comparing) {
+            return IM_COL32(255, 165, 0, 255); // Comparing (orange)
+        }
+        if (sorted) {
+            return IM_COL32(0, 255, 0, 255); // Sorted (green)
+        }
+        if (group != 0) {
+            return getGroupColor(group);
+        }
+        return IM_COL32(200, 200, 200, 255); // Default color (gray)
+    }
+
+    ImU32 Renderer::getGroupColor(uint8_t group) {
+        // Distinct hues for the owners of array ranges, e.g. worker threads
+        static const ImU32 palette[] = {
+            IM_COL32(86, 180, 233, 255),
+            IM_COL32(230, 159, 0, 255),
+            IM_COL32(204, 121, 167, 255),
+            IM_COL32(0, 158, 115, 255),
+            IM_COL32(240, 228, 66, 255),
+            IM_COL32(0, 114, 178, 255),
+            IM_COL32(213, 94, 0, 255),
+            IM_COL32(170, 170, 255, 255),
+        };
+        return palette[(group - 1) % (sizeof(palette) / sizeof(palette[0]))];
+    }
+
+    void Renderer::updateBars(const Visualization::VisualizationData& data, const Algorithms::SortingStats& stats, ImVec2 origin, float width) {
+        int n = data.size();
+        ImVec2 uv = ImGui::GetFontTexUvWhitePixel();
+        bool rebuild = barSource != &data || barVertices.size() != static_cast<size_t>(n) * 4 ||
+            barAreaWidth != width || barSorted != stats.sortingComplete || barUv.x != uv.x || barUv.y != uv.y;
+
+        if (rebuild) {
+            barSource = &data;
+            barAreaWidth = width;
+            barSorted = stats.sortingComplete;
+            barUv = uv;
+            barOrigin = origin;
+
+            // Bars keep their gap until it would eat more than half of the width
+            float gap = n * padding < width / 2 ? padding : 0.0f;
+            barStep = width / n;
+            barWidth = barStep - gap;
+
+            barVertices.resize(static_cast<size_t>(n) * 4);
+            for (int block = 0; block < data.getBlockCount(); block++) {
+                data.takeDirtyBlock(block);
+            }
+            for (int i = 0; i < n; i++) {
+                writeBar(data, i);
+            }
+            return;
+        }
+
+        // Moving the window only shifts the cached quads
+        if (origin.x != barOrigin.x || origin.y != barOrigin.y) {
+            ImVec2 delta(origin.x - barOrigin.x, origin.y - barOrigin.y);
+            for (auto& vertex : barVertices) {
+                vertex.pos.x += delta.x;
+                vertex.pos.y += delta.y;
             }
+            barOrigin = origin;
+        }
+
+        // Patch the heights and colors of the bars that changed since the last frame
+        for (int block = 0; block < data.getBlockCount(); block++) {
+            if (!data.takeDirtyBlock(block)) {
+                continue;
+            }
+            int first = block << Visualization::VisualizationData::DIRTY_BLOCK_SHIFT;
+            int last = std::min(first + Visualization::VisualizationData::DIRTY_BLOCK_SIZE, n);
+            for (int i = first; i < last; i++) {
+                writeBar(data, i);
+            }
+        }
+    }
+
+    void Renderer::writeBar(const Visualization::VisualizationData& data, int index) {
+        float barHeight = (data.getValues()[index] / 200.0f) * maxBarHeight;
+        float left = barOrigin.x + index * barStep;
+        float right = left + barWidth;
+        float bottom = barOrigin.y + maxBarHeight;
+        float top = bottom - barHeight;
+        ImU32 color = getBarColor(data.isSwapping(index), data.isComparing(index), barSorted, data.getGroup(index));
+
+        ImDrawVert* vertex = &barVertices[static_cast<size_t>(index) * 4];
+        vertex[0] = { ImVec2(left, top), barUv, color };
+        vertex[1] = { ImVec2(right, top), barUv, color };
+        vertex[2] = { ImVec2(right, bottom), barUv, color };
+        vertex[3] = { ImVec2(left, bottom), barUv, color };
+    }
+
+    void Renderer::emitBars(ImDrawList* drawList) const {
+        // With 16-bit indices a single reservation must stay below 64k vertices.
+        // The OpenGL3 backend sets RendererHasVtxOffset, so ImGui starts a new vertex offset per chunk.
+        const size_t barCount = barVertices.size() / 4;
+        const size_t barsPerChunk = sizeof(ImDrawIdx) == 2 ? (1 << 16) / 4 : barCount;
+
+        for (size_t first = 0; first < barCount; first += barsPerChunk) {
+            size_t count = std::min(barsPerChunk, barCount - first);
+            drawList->PrimReserve(static_cast<int>(count * 6), static_cast<int>(count * 4));
+
+            std::memcpy(drawList->_VtxWritePtr, &barVertices[first * 4], count * 4 * sizeof(ImDrawVert));
+
+            ImDrawIdx* indices = drawList->_IdxWritePtr;
+            unsigned int base = drawList->_VtxCurrentIdx;
+            for (size_t k = 0; k < count; k++) {
+                ImDrawIdx corner = static_cast<ImDrawIdx>(base + k * 4);
+                indices[0] = corner;
+                indices[1] = static_cast<ImDrawIdx>(corner + 1);
+                indices[2] = static_cast<ImDrawIdx>(corner + 2);
+                indices[3] = corner;
+                indices[4] = static_cast<ImDrawIdx>(corner + 2);
+                indices[5] = static_cast<ImDrawIdx>(corner + 3);
+                indices += 6;
+            }
+
+            drawList->_VtxWritePtr += count * 4;
+            drawList->_IdxWritePtr = indices;
+            drawList->_VtxCurrentIdx += static_cast<unsigned int>(count * 4);
+        }
+    }
+
+    void Renderer::updateColumns(const Visualization::VisualizationData& data, int columnCount) {
+        int n = data.size();
+        bool rebuild = lodSource != &data || lodElementCount != n || static_cast<int>(lodColumns.size()) != columnCount;
+        if (rebuild) {
+            lodSource = &data;
+            lodElementCount = n;
+            lodColumns.assign(columnCount, ColumnSummary());
+            lodDirtyColumns.assign(columnCount, 1);
+        }
+
+        // Fold the blocks changed since the last frame into the columns they overlap
+        for (int block = 0; block < data.getBlockCount(); block++) {
+            if (!data.takeDirtyBlock(block) || rebuild) {
+                continue;
+            }
+            long long first = static_cast<long long>(block) << Visualization::VisualizationData::DIRTY_BLOCK_SHIFT;
+            long long last = std::min<long long>(first + Visualization::VisualizationData::DIRTY_BLOCK_SIZE, n) - 1;
+            int firstColumn = static_cast<int>(first * columnCount / n);
+            int lastColumn = static_cast<int>(last * columnCount / n);
+            for (int column = firstColumn; column <= lastColumn; column++) {
+                lodDirtyColumns[column] = 1;
+            }
+        }
+
+        const auto& array = data.getValues();
+        for (int column = 0; column < columnCount; column++) {
+            if (!lodDirtyColumns[column]) {
+                continue;
+            }
+            lodDirtyColumns[column] = 0;
+
+            int begin = static_cast<int>(static_cast<long long>(column) * n / columnCount);
+            int end = static_cast<int>(static_cast<long long>(column + 1) * n / columnCount);
+
+            ColumnSummary& summary = lodColumns[column];
+            summary = ColumnSummary();
+            if (begin >= end) {
+                continue;
+            }
+            summary.minValue = array[begin];
+            summary.maxValue = array[begin];
+            summary.group = data.getGroup(begin);
+            long long sum = 0;
+            for (int i = begin; i < end; i++) {
+                summary.minValue = std::min(summary.minValue, array[i]);
+                summary.maxValue = std::max(summary.maxValue, array[i]);
+                sum += array[i];
+                summary.comparing = summary.comparing || data.isComparing(i);
+                summary.swapping = summary.swapping || data.isSwapping(i);
+            }
+            summary.meanValue = static_cast<float>(sum) / (end - begin);
+        }
+    }
+
+    void Renderer::renderColumns(const Visualization::VisualizationData& data, const Algorithms::SortingStats& stats, float width) {
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        float bottom = origin.y + maxBarHeight;
+        int columnCount = static_cast<int>(lodColumns.size());
+        float columnWidth = width / columnCount;
+        int n = data.size();
+
+        if (data.markedLow >= 0 && data.markedHigh >= data.markedLow) {
+            float low = static_cast<float>(static_cast<long long>(data.markedLow) * columnCount / n);
+            float high = static_cast<float>(static_cast<long long>(data.markedHigh) * columnCount / n + 1);
+            drawList->AddRectFilled(
+                ImVec2(origin.x + low * columnWidth, origin.y),
+                ImVec2(origin.x + high * columnWidth, bottom),
+                IM_COL32(60, 60, 110, 255)
+            );
+        }
+
+        for (int column = 0; column < columnCount; column++) {
+            const ColumnSummary& summary = lodColumns[column];
+
+            ImU32 barColor = getBarColor(summary.swapping, summary.comparing, stats.sortingComplete, summary.group);
+            ImU32 envelopeColor = (barColor & ~IM_COL32_A_MASK) | (90u << IM_COL32_A_SHIFT);
 
-            ImGui::Dummy(ImVec2(windowWidth, maxBarHeight));
+            // Faint band from the column's minimum to its maximum, solid bar up to its mean
+            float x = origin.x + column * columnWidth;
+            drawList->AddRectFilled(
+                ImVec2(x, bottom - (summary.maxValue / 200.0f) * maxBarHeight),
+                ImVec2(x + columnWidth, bottom - (summary.minValue / 200.0f) * maxBarHeight),
+                envelopeColor
+            );
+            drawList->AddRectFilled(
+                ImVec2(x, bottom - (summary.meanValue / 200.0f) * maxBarHeight),
+                ImVec2(x + columnWidth, bottom),
+                barColor
+            );
         }
     }
 
-}
\ No newline at end of file
+}
@@ -1,7 +1,15 @@
 #pragma once
 #include "VisualizationData.h"
+#include "ArrayGenerator.h"
+#include "NumberLoader.h"
+#include "Dataset.h"
 #include "SortingStats.h"
+#include "Timeline.h"
+#include "SortingWorker.h"
 #include "imgui.h"
+#include <cstdint>
+#include <string>
+#include <vector>
 
 namespace Rendering {
 
@@ -9,15 +17,83 @@ namespace Rendering {
     public:
         Renderer();
 
-        bool renderControls(Visualization::VisualizationData& data, Algorithms::SortingStats& stats, int& arraySize, bool isStepsEnable);
+        // Touches the data and stats only while the worker is idle; everything else goes to the worker as commands
+        // Returns true when the array should be generated again from the distribution and options.
+        // Arrays of other keys than int can only be generated, and not stepped backward.
+        template <typename Key>
+        bool renderControls(Visualization::BasicVisualizationData<Key>& data, Algorithms::SortingStats& stats, Algorithms::SortingWorker& worker, int& arraySize,
+            Utils::Distribution& distribution, Utils::GeneratorOptions& generatorOptions, bool isStepsEnable);
 
         void renderArrayVisualization(const Visualization::VisualizationData& data, const Algorithms::SortingStats& stats);
 
         void renderStatistics(const Algorithms::SortingStats& stats, int arraySize);
 
+        // Returns true when the user asked to record a new timeline
+        bool renderTimelineControls(Algorithms::Timeline& timeline, bool canRecord);
+
     private:
+        // Min/max/mean of the elements that fall into one pixel column
+        struct ColumnSummary {
+            int minValue = 0;
+            int maxValue = 0;
+            float meanValue = 0.0f;
+            bool comparing = false;
+            bool swapping = false;
+            uint8_t group = 0; // Owner of the column's first element
+        };
+
         float maxBarHeight = 300.0f;
         float padding = 1.0f;
+        bool useColumnLod = true;
+        // Delay slider value, synced from the stats while the worker is idle
+        int delaySetting = 50;
+        int stepCount = 1;
+        // Loads the text file named in the path box; fileMessage is what the error popup shows
+        Utils::NumberLoader loader;
+        std::string fileMessage;
+        // Binary dataset to open or export
+        char datasetPath[256]{};
+        double visualizationMs = 0.0;
+
+        // Vertex cache for the bar path: four screen-space vertices per bar, patched where the data changed
+        const Visualization::VisualizationData* barSource = nullptr;
+        std::vector<ImDrawVert> barVertices;
+        ImVec2 barOrigin;
+        ImVec2 barUv;
+        float barAreaWidth = 0.0f;
+        float barStep = 0.0f;
+        float barWidth = 0.0f;
+        bool barSorted = false;
+
+        // Level-of-detail cache, refreshed only where the data reports changes
+        const Visualization::VisualizationData* lodSource = nullptr;
+        int lodElementCount = 0;
+        std::vector<ColumnSummary> lodColumns;
+        std::vector<uint8_t> lodDirtyColumns;
+
+        ImU64 timelineTarget = 0;
+        int timelineBudgetMB = 64;
+
+        static ImU32 getBarColor(bool swapping, bool comparing, bool sorted, uint8_t group);
+        static ImU32 getGroupColor(uint8_t group);
+        static std::string describeLoadFailure(const Utils::LoadResult& result);
+        // Hardware counters of the run per element, one row per phase and one for the whole run
+        static void renderPerfCounters(const Algorithms::SortingStats& stats, int arraySize);
+
+        // Controls only arrays of ints have
+        void renderValueInput(Visualization::VisualizationData& data, int& arraySize);
+        void stepBackward(Visualization::VisualizationData& data, Algorithms::SortingStats& stats);
+        void renderDatasetControls(Visualization::VisualizationData& data, const Algorithms::SortingStats& stats, int& arraySize);
+
+        void openDataset(Visualization::VisualizationData& data, int& arraySize);
+        void exportDataset(const Visualization::VisualizationData& data, const Algorithms::SortingStats& stats);
+
+        void updateBars(const Visualization::VisualizationData& data, const Algorithms::SortingStats& stats, ImVec2 origin, float width);
+        void writeBar(const Visualization::VisualizationData& data, int index);
+        void emitBars(ImDrawList* drawList) const;
+
+        void updateColumns(const Visualization::VisualizationData& data, int columnCount);
+        void renderColumns(const Visualization::VisualizationData& data, const Algorithms::SortingStats& stats, float width);
     };
 
 }
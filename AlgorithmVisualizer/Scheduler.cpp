@@ -0,0 +1,237 @@
+#include "Scheduler.h"
+#include <algorithm>
+
+namespace Algorithms {
+
+    Scheduler::Scheduler(int threadCount) {
+        if (threadCount <= 0) {
+            threadCount = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+        budget = threadCount;
+        for (int t = 0; t < threadCount; t++) {
+            threads.emplace_back(&Scheduler::loop, this);
+        }
+    }
+
+    Scheduler::~Scheduler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        workAvailable.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    Scheduler& Scheduler::getDefault() {
+        static Scheduler scheduler;
+        return scheduler;
+    }
+
+    void Scheduler::notify(Job& job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (job.detached) {
+                return;
+            }
+            if (job.running) {
+                // The thread running the slice queues the job again when it returns
+                job.notified = true;
+                return;
+            }
+
+            auto now = Clock::now();
+            if (!job.queued) {
+                enqueue(job, now);
+            }
+            else if (job.due > now) {
+                job.due = now;
+            }
+        }
+        workAvailable.notify_one();
+    }
+
+    void Scheduler::remove(Job& job) {
+        std::unique_lock<std::mutex> lock(mutex);
+        job.detached = true;
+        if (job.queued) {
+            ready.erase(std::find(ready.begin(), ready.end(), &job));
+            job.queued = false;
+        }
+        finished.wait(lock, [&job]() { return !job.running; });
+    }
+
+    void Scheduler::setPriority(Job& job, Priority priority) {
+        std::lock_guard<std::mutex> lock(mutex);
+        job.priority = priority;
+    }
+
+    Scheduler::Priority Scheduler::getPriority(const Job& job) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return job.priority;
+    }
+
+    void Scheduler::runTeam(int maxMembers, const std::function<void(int)>& body) {
+        if (maxMembers <= 1) {
+            body(0);
+            return;
+        }
+
+        Team team;
+        team.body = &body;
+        team.maxMembers = maxMembers;
+        team.perf = Utils::PerfScope::getRecorder();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            teams.push_back(&team);
+        }
+        workAvailable.notify_all();
+
+        body(0);
+
+        // Close the team to late helpers, then wait for the ones already inside
+        std::unique_lock<std::mutex> lock(mutex);
+        teams.erase(std::find(teams.begin(), teams.end(), &team));
+        finished.wait(lock, [&team]() { return team.active == 0; });
+    }
+
+    int Scheduler::getBusyThreads() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return busy;
+    }
+
+    int Scheduler::getThreadBudget() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return budget;
+    }
+
+    void Scheduler::setThreadBudget(int budget) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->budget = std::clamp(budget, 1, getThreadCount());
+        }
+        workAvailable.notify_all();
+    }
+
+    void Scheduler::loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            if (busy < budget) {
+                // Helping a team speeds up a slice that already holds a thread, so it comes first
+                if (Team* team = findOpenTeam()) {
+                    int member = team->nextMember++;
+                    team->active++;
+                    busy++;
+                    if (!timerArmed && !ready.empty()) {
+                        workAvailable.notify_one();
+                    }
+
+                    lock.unlock();
+                    {
+                        Utils::PerfScope perf(team->perf);
+                        (*team->body)(member);
+                    }
+                    lock.lock();
+
+                    busy--;
+                    if (--team->active == 0) {
+                        finished.notify_all();
+                    }
+                    continue;
+                }
+
+                if (Job* job = takeDueJob(Clock::now())) {
+                    job->running = true;
+                    busy++;
+                    // This thread may have been the one waiting for the next deadline; hand that over
+                    if (!timerArmed && !ready.empty()) {
+                        workAvailable.notify_one();
+                    }
+
+                    lock.unlock();
+                    Clock::time_point due;
+                    bool again = job->runSlice(due);
+                    lock.lock();
+
+                    busy--;
+                    job->running = false;
+                    if (job->notified) {
+                        job->notified = false;
+                        again = true;
+                        due = Clock::now();
+                    }
+                    if (job->detached) {
+                        finished.notify_all();
+                    }
+                    else if (again) {
+                        // This thread looks for work right away, so nobody else needs waking
+                        enqueue(*job, due);
+                    }
+                    continue;
+                }
+            }
+
+            // Nothing to run now. One thread waits for the earliest due job; the rest wait to be notified.
+            Clock::time_point earliest = Clock::time_point::max();
+            if (busy < budget) {
+                for (Job* job : ready) {
+                    earliest = std::min(earliest, job->due);
+                }
+            }
+            if (earliest != Clock::time_point::max() && (!timerArmed || earliest < timerDeadline)) {
+                timerArmed = true;
+                timerDeadline = earliest;
+                workAvailable.wait_until(lock, earliest);
+                if (timerDeadline == earliest) {
+                    timerArmed = false;
+                }
+            }
+            else {
+                workAvailable.wait(lock);
+            }
+        }
+    }
+
+    void Scheduler::enqueue(Job& job, Clock::time_point due) {
+        job.due = due;
+        job.order = nextOrder++;
+        job.queued = true;
+        ready.push_back(&job);
+    }
+
+    Scheduler::Job* Scheduler::takeDueJob(Clock::time_point now) {
+        // Highest priority first; within one, the job that has been due longest
+        auto best = ready.end();
+        for (auto it = ready.begin(); it != ready.end(); ++it) {
+            Job* job = *it;
+            if (job->due > now) {
+                continue;
+            }
+            if (best == ready.end() || job->priority > (*best)->priority ||
+                (job->priority == (*best)->priority && (job->due < (*best)->due ||
+                    (job->due == (*best)->due && job->order < (*best)->order)))) {
+                best = it;
+            }
+        }
+        if (best == ready.end()) {
+            return nullptr;
+        }
+
+        Job* job = *best;
+        *best = ready.back();
+        ready.pop_back();
+        job->queued = false;
+        return job;
+    }
+
+    Scheduler::Team* Scheduler::findOpenTeam() {
+        for (Team* team : teams) {
+            if (team->nextMember < team->maxMembers) {
+                return team;
+            }
+        }
+        return nullptr;
+    }
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include "PerfCounters.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Algorithms {
+
+    // Fixed pool of threads shared by every algorithm instance. Jobs are advanced one short slice
+    // at a time, the highest priority first and round-robin by due time within a priority, so any
+    // number of instances share the cores fairly. A slice may ask for the next one after a delay,
+    // which costs no thread while it waits. Parallel algorithms borrow idle threads through teams.
+    // The CPU budget caps how many pool threads are busy at once, helpers included.
+    class Scheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        enum class Priority : int { Low, Normal, High };
+
+        // Something the pool advances a slice at a time; at most one slice of a job runs at once
+        class Job {
+        public:
+            virtual ~Job() = default;
+
+        protected:
+            // Does a bounded amount of work on a pool thread. Returns true, with due set,
+            // when the job wants another slice; otherwise it waits for the next notify.
+            virtual bool runSlice(Clock::time_point& due) = 0;
+
+        private:
+            friend class Scheduler;
+
+            // Guarded by the scheduler's mutex
+            Priority priority = Priority::Normal;
+            Clock::time_point due;
+            unsigned long long order = 0;
+            bool queued = false;
+            bool running = false;
+            bool notified = false;
+            bool detached = false;
+        };
+
+        // threadCount <= 0 uses one thread per core, and at least two
+        explicit Scheduler(int threadCount = 0);
+        ~Scheduler();
+
+        Scheduler(const Scheduler&) = delete;
+        Scheduler& operator=(const Scheduler&) = delete;
+
+        // The pool every algorithm instance and parallel algorithm runs on
+        static Scheduler& getDefault();
+
+        // Run a slice of the job as soon as a thread is free; a job in its slice gets another right after
+        void notify(Job& job);
+        // Stop scheduling the job and wait for its running slice, if any, to return
+        void remove(Job& job);
+
+        void setPriority(Job& job, Priority priority);
+        Priority getPriority(const Job& job) const;
+
+        // Runs body(member) on the calling thread as member 0 and on up to maxMembers - 1 idle pool
+        // threads, then waits for the members that joined. Busy pools lend nothing, so the body
+        // must finish the work with any number of members, e.g. by taking tasks from a shared counter.
+        void runTeam(int maxMembers, const std::function<void(int)>& body);
+
+        int getThreadCount() const { return static_cast<int>(threads.size()); }
+        int getBusyThreads() const;
+        int getThreadBudget() const;
+        // Clamped to [1, thread count]; threads above the budget finish their slice and then stay idle
+        void setThreadBudget(int budget);
+
+    private:
+        struct Team {
+            const std::function<void(int)>* body = nullptr;
+            int maxMembers = 0;
+            int nextMember = 1;
+            int active = 0;
+            // What the caller counts hardware events for; helpers count for it too
+            Utils::PerfRecorder* perf = nullptr;
+        };
+
+        mutable std::mutex mutex;
+        // Pool threads wait here for work; callers of remove and runTeam wait on finished
+        std::condition_variable workAvailable;
+        std::condition_variable finished;
+
+        std::vector<Job*> ready;
+        std::vector<Team*> teams;
+        unsigned long long nextOrder = 0;
+        int busy = 0;
+        int budget = 0;
+        bool stopping = false;
+        // Earliest deadline some idle thread is waiting for, so the others need not
+        bool timerArmed = false;
+        Clock::time_point timerDeadline;
+
+        std::vector<std::thread> threads;
+
+        void loop();
+        void enqueue(Job& job, Clock::time_point due);
+        Job* takeDueJob(Clock::time_point now);
+        Team* findOpenTeam();
+    };
+
+}
@@ -0,0 +1,90 @@
+#include "SnapshotBuffer.h"
+#include <cstdio>
+
+namespace Visualization {
+
+    SnapshotBuffer::SnapshotBuffer(const VisualizationState& live) : live(live) {}
+
+    void SnapshotBuffer::publish(const Algorithms::SortingStats& stats, const char* phaseName) {
+        // Teams of parallel algorithms send one member here at a time; any other caller meanwhile skips its frame
+        if (publishing.test_and_set(std::memory_order_acquire)) {
+            return;
+        }
+
+        // Stamp the blocks the algorithm touched since the last publish
+        publishCount++;
+        int blockCount = live.getBlockCount();
+        if (blockVersions.size() != static_cast<size_t>(blockCount)) {
+            blockVersions.assign(blockCount, publishCount);
+            for (int block = 0; block < blockCount; block++) {
+                live.takeDirtyBlock(block);
+            }
+        }
+        else {
+            for (int block = 0; block < blockCount; block++) {
+                if (live.takeDirtyBlock(block)) {
+                    blockVersions[block] = publishCount;
+                }
+            }
+        }
+
+        // Bring the back slot up to date; it missed every change since it was last filled
+        Slot& slot = slots[back];
+        if (slot.data.size() != live.size()) {
+            slot.data.resize(live.size());
+            slot.version = 0;
+        }
+        for (int block = 0; block < blockCount; block++) {
+            if (blockVersions[block] > slot.version) {
+                live.copyBlockTo(slot.data, block);
+            }
+        }
+        slot.data.markedLow = live.markedLow;
+        slot.data.markedHigh = live.markedHigh;
+        slot.version = publishCount;
+
+        slot.stats.comparisons = stats.comparisons;
+        slot.stats.swaps = stats.swaps;
+        slot.stats.writes = stats.writes;
+        slot.stats.currentStep = stats.currentStep;
+        slot.stats.bytesRead = stats.bytesRead;
+        slot.stats.bytesWritten = stats.bytesWritten;
+        slot.stats.isSorting = stats.isSorting.load();
+        slot.stats.sortingComplete = stats.sortingComplete;
+        slot.stats.steppingMode = stats.steppingMode;
+        slot.stats.speedFactor = stats.speedFactor.load();
+        // Workers may still be counting; their counters are relaxed atomics, so this copy reads each one whole
+        slot.stats.workers = stats.workers;
+        slot.stats.perf.copyFrom(stats.perf);
+
+        slot.hasPhase = phaseName != nullptr;
+        if (slot.hasPhase) {
+            std::snprintf(slot.phaseName, sizeof(slot.phaseName), "%s", phaseName);
+        }
+
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+        publishing.clear(std::memory_order_release);
+    }
+
+    bool SnapshotBuffer::update() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+
+        // The slot's marks cover every block changed since this reader last held it
+        const VisualizationData& frame = slots[front].data;
+        if (view.size() != frame.size()) {
+            view.resize(frame.size());
+        }
+        for (int block = 0; block < frame.getBlockCount(); block++) {
+            if (frame.takeDirtyBlock(block)) {
+                view.copyBlock(frame, block);
+            }
+        }
+        view.markedLow = frame.markedLow;
+        view.markedHigh = frame.markedHigh;
+        return true;
+    }
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "VisualizationData.h"
+#include "SortingStats.h"
+#include <atomic>
+#include <vector>
+
+namespace Visualization {
+
+    // Lock-free triple buffer of what the render loop shows: the array with its highlights
+    // and groups, the marked range, the counters and the phase name. The thread driving the
+    // algorithm fills the back slot and swaps it with the shared middle slot; the render loop
+    // swaps the middle slot with its front slot when a newer frame is waiting. Neither side
+    // ever blocks. A publish copies only the blocks that changed since that slot was last
+    // filled, and the reader patches one stable view from the blocks that changed since it
+    // last looked, so the renderer's caches keep working across frames. Live arrays of other keys
+    // than int are published as the heights they are drawn with.
+    class SnapshotBuffer {
+    public:
+        SnapshotBuffer(const VisualizationState& live);
+
+        SnapshotBuffer(const SnapshotBuffer&) = delete;
+        SnapshotBuffer& operator=(const SnapshotBuffer&) = delete;
+
+        // Producer side: the sorting thread while one runs, the UI thread otherwise.
+        // A call made while another thread is publishing returns at once without publishing.
+        // Nothing may write the live array meanwhile; parallel algorithms pace through a TeamPacer.
+        void publish(const Algorithms::SortingStats& stats, const char* phaseName);
+
+        // Consumer side, render loop only: switch to the newest published frame, if any
+        bool update();
+
+        const VisualizationData& getView() const { return view; }
+        const Algorithms::SortingStats& getStats() const { return slots[front].stats; }
+        const char* getPhaseName() const { return slots[front].hasPhase ? slots[front].phaseName : nullptr; }
+
+    private:
+        struct Slot {
+            VisualizationData data{ 0 };
+            // Counters only; the undo log stays with the live stats
+            Algorithms::SortingStats stats;
+            char phaseName[64]{};
+            bool hasPhase = false;
+            // Publish count at which the slot was last filled
+            unsigned long long version = 0;
+        };
+
+        static constexpr int INDEX_MASK = 3;
+        static constexpr int FRESH = 4;
+
+        const VisualizationState& live;
+        Slot slots[3];
+        // Index of the middle slot, plus FRESH while the reader has not taken it
+        std::atomic<int> middle{ 1 };
+        std::atomic_flag publishing = ATOMIC_FLAG_INIT;
+
+        // Producer state: the slot being filled, and the publish count at which each live block last changed
+        int back = 2;
+        unsigned long long publishCount = 0;
+        std::vector<unsigned long long> blockVersions;
+
+        // Consumer state
+        int front = 0;
+        VisualizationData view{ 0 };
+    };
+
+}
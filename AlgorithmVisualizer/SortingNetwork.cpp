@@ -0,0 +1,108 @@
+#include "SortingNetwork.h"
+#include <atomic>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SORTING_NETWORK_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+#endif
+
+namespace Algorithms {
+    namespace SortingNetwork {
+
+#ifdef SORTING_NETWORK_X86
+        // Defined in the translation units built for each instruction set
+        long long sortAvx2(int* values, int count);
+        long long sortSse41(int* values, int count);
+#endif
+
+        namespace {
+            Kernel detectBestKernel() {
+#if defined(SORTING_NETWORK_X86) && defined(_MSC_VER)
+                int info[4];
+                __cpuid(info, 0);
+                int maxLeaf = info[0];
+                __cpuid(info, 1);
+                bool sse41 = (info[2] & (1 << 19)) != 0;
+                // AVX2 also needs the OS to save the upper halves of the ymm registers
+                bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+                bool avx2 = false;
+                if (maxLeaf >= 7 && osSavesYmm) {
+                    __cpuidex(info, 7, 0);
+                    avx2 = (info[1] & (1 << 5)) != 0;
+                }
+#elif defined(SORTING_NETWORK_X86)
+                __builtin_cpu_init();
+                bool sse41 = __builtin_cpu_supports("sse4.1");
+                bool avx2 = __builtin_cpu_supports("avx2");
+#else
+                bool sse41 = false;
+                bool avx2 = false;
+#endif
+                if (avx2) {
+                    return Kernel::Avx2;
+                }
+                return sse41 ? Kernel::Sse41 : Kernel::Insertion;
+            }
+
+            const Kernel bestKernel = detectBestKernel();
+            std::atomic<Kernel> currentKernel{ bestKernel };
+
+            long long insertionSort(int* values, int count) {
+                long long comparisons = 0;
+                for (int i = 1; i < count; i++) {
+                    int value = values[i];
+                    int j = i - 1;
+                    while (j >= 0 && (comparisons++, values[j] > value)) {
+                        values[j + 1] = values[j];
+                        j--;
+                    }
+                    values[j + 1] = value;
+                }
+                return comparisons;
+            }
+        }
+
+        Kernel getBestKernel() {
+            return bestKernel;
+        }
+
+        Kernel getKernel() {
+            return currentKernel.load(std::memory_order_relaxed);
+        }
+
+        void setKernel(Kernel kernel) {
+            currentKernel.store(static_cast<int>(kernel) <= static_cast<int>(bestKernel) ? kernel : bestKernel, std::memory_order_relaxed);
+        }
+
+        const char* getKernelName(Kernel kernel) {
+            switch (kernel) {
+            case Kernel::Avx2: return "avx2";
+            case Kernel::Sse41: return "sse41";
+            default: return "insertion";
+            }
+        }
+
+        int getBaseCaseSize() {
+            // Insertion sort stops paying off well before 32 values
+            return getKernel() == Kernel::Insertion ? 16 : MAX_SIZE;
+        }
+
+        long long sort(int* values, int count) {
+            if (count <= 1) {
+                return 0;
+            }
+
+            switch (getKernel()) {
+#ifdef SORTING_NETWORK_X86
+            case Kernel::Avx2: return sortAvx2(values, count);
+            case Kernel::Sse41: return sortSse41(values, count);
+#endif
+            default: return insertionSort(values, count);
+            }
+        }
+
+    }
+}
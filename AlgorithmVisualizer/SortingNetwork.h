@@ -0,0 +1,53 @@
+#pragma once
+#include <functional>
+#include <type_traits>
+
+namespace Algorithms {
+    namespace SortingNetwork {
+
+        // Largest block the network kernels sort in registers
+        constexpr int MAX_SIZE = 32;
+
+        // Insertion is the scalar small-range path the algorithms used before the networks.
+        // Sse41 and Avx2 run bitonic networks on 8 lanes of ints held in registers.
+        enum class Kernel { Insertion, Sse41, Avx2 };
+
+        // Fastest kernel this CPU supports, detected once at startup
+        Kernel getBestKernel();
+
+        // Kernel used by sort(); a request for an unsupported one falls back to the best available
+        Kernel getKernel();
+        void setKernel(Kernel kernel);
+
+        const char* getKernelName(Kernel kernel);
+
+        // Ranges of up to this many values should be handed to sort() by the calling algorithm
+        int getBaseCaseSize();
+
+        // Sorts count <= MAX_SIZE values ascending and returns the number of comparisons made
+        long long sort(int* values, int count);
+
+        // Sorts count <= MAX_SIZE keys of any type in the order of compare. Ints in ascending order
+        // go to the kernel; other keys are insertion sorted, which is what the kernel replaced.
+        template <typename Key, typename Compare>
+        long long sort(Key* values, int count, Compare compare) {
+            if constexpr (std::is_same_v<Key, int> && std::is_same_v<Compare, std::less<int>>) {
+                return sort(values, count);
+            }
+            else {
+                long long comparisons = 0;
+                for (int i = 1; i < count; i++) {
+                    Key value = values[i];
+                    int j = i - 1;
+                    while (j >= 0 && (comparisons++, compare(value, values[j]))) {
+                        values[j + 1] = values[j];
+                        j--;
+                    }
+                    values[j + 1] = value;
+                }
+                return comparisons;
+            }
+        }
+
+    }
+}
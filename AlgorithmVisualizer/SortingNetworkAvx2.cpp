@@ -0,0 +1,63 @@
+#include "SortingNetwork.h"
+#include <climits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+
+// Everything included above keeps the default target; only the kernels below use AVX2
+#if defined(__GNUC__) && !defined(_MSC_VER)
+#pragma GCC target("avx2")
+#endif
+
+#include <immintrin.h>
+#include "SortingNetworkKernels.h"
+
+namespace Algorithms {
+    namespace SortingNetwork {
+
+        namespace {
+            struct Avx2 {
+                using Type = __m256i;
+
+                static Type load(const int* values) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values)); }
+                static void store(int* values, Type v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(values), v); }
+                static Type min(Type a, Type b) { return _mm256_min_epi32(a, b); }
+                static Type max(Type a, Type b) { return _mm256_max_epi32(a, b); }
+
+                template <int J>
+                static Type swapLanes(Type v) {
+                    if constexpr (J == 1) {
+                        return _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+                    }
+                    else if constexpr (J == 2) {
+                        return _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+                    }
+                    else {
+                        return _mm256_permute2x128_si256(v, v, 0x01);
+                    }
+                }
+
+                template <int MASK>
+                static Type blend(Type a, Type b) { return _mm256_blend_epi32(a, b, MASK); }
+
+                static Type reverse(Type v) { return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0)); }
+            };
+        }
+
+        long long sortAvx2(int* values, int count) {
+            // Pad to the next block size with the largest int, which sorts to the end
+            int size = count <= 8 ? 8 : (count <= 16 ? 16 : 32);
+            alignas(32) int block[MAX_SIZE];
+            for (int i = 0; i < size; i++) {
+                block[i] = i < count ? values[i] : INT_MAX;
+            }
+            long long comparisons = Kernels::sortBlock<Avx2>(block, size);
+            for (int i = 0; i < count; i++) {
+                values[i] = block[i];
+            }
+            return comparisons;
+        }
+
+    }
+}
+
+#endif
@@ -0,0 +1,112 @@
+#pragma once
+// Bitonic sorting networks written once against an 8-lane vector type V, which provides
+//   Type                                         the register type
+//   load(const int*), store(int*, Type)          unaligned access to 8 ints
+//   min(Type, Type), max(Type, Type)             lane-wise
+//   swapLanes<J>(Type)                           lane i takes lane i ^ J, J in {1, 2, 4}
+//   blend<MASK>(Type a, Type b)                  lane i from b when bit i of MASK is set
+//   reverse(Type)                                lane i takes lane 7 - i
+// Each instruction set includes this from its own translation unit.
+
+namespace Algorithms {
+    namespace SortingNetwork {
+        namespace Kernels {
+
+            // Lanes that keep the larger value of their pair in the stage merging blocks of
+            // k lanes at distance j; blocks are alternately ascending and descending until k = 8
+            constexpr int stageMask(int k, int j) {
+                int mask = 0;
+                for (int lane = 0; lane < 8; lane++) {
+                    bool upper = (lane & j) != 0;
+                    bool descending = k < 8 && (lane & k) != 0;
+                    if (upper != descending) {
+                        mask |= 1 << lane;
+                    }
+                }
+                return mask;
+            }
+
+            template <typename V, int K, int J>
+            inline typename V::Type layer(typename V::Type v) {
+                typename V::Type partner = V::template swapLanes<J>(v);
+                return V::template blend<stageMask(K, J)>(V::min(v, partner), V::max(v, partner));
+            }
+
+            // 24 comparators
+            template <typename V>
+            inline typename V::Type sort8(typename V::Type v) {
+                v = layer<V, 2, 1>(v);
+                v = layer<V, 4, 2>(v);
+                v = layer<V, 4, 1>(v);
+                v = layer<V, 8, 4>(v);
+                v = layer<V, 8, 2>(v);
+                return layer<V, 8, 1>(v);
+            }
+
+            // Sorts a bitonic register ascending; 12 comparators
+            template <typename V>
+            inline typename V::Type clean8(typename V::Type v) {
+                v = layer<V, 8, 4>(v);
+                v = layer<V, 8, 2>(v);
+                return layer<V, 8, 1>(v);
+            }
+
+            // Merges two ascending registers into lo and hi; 32 comparators
+            template <typename V>
+            inline void merge16(typename V::Type& lo, typename V::Type& hi) {
+                typename V::Type reversed = V::reverse(hi);
+                typename V::Type low = V::min(lo, reversed);
+                typename V::Type high = V::max(lo, reversed);
+                lo = clean8<V>(low);
+                hi = clean8<V>(high);
+            }
+
+            // Sorts a bitonic pair of registers ascending; 32 comparators
+            template <typename V>
+            inline void clean16(typename V::Type& lo, typename V::Type& hi) {
+                typename V::Type low = V::min(lo, hi);
+                typename V::Type high = V::max(lo, hi);
+                lo = clean8<V>(low);
+                hi = clean8<V>(high);
+            }
+
+            template <typename V>
+            inline long long sortBlock(int* block, int size) {
+                using T = typename V::Type;
+                if (size == 8) {
+                    V::store(block, sort8<V>(V::load(block)));
+                    return 24;
+                }
+
+                T r0 = sort8<V>(V::load(block));
+                T r1 = sort8<V>(V::load(block + 8));
+                merge16<V>(r0, r1);
+                if (size == 16) {
+                    V::store(block, r0);
+                    V::store(block + 8, r1);
+                    return 80;
+                }
+
+                T r2 = sort8<V>(V::load(block + 16));
+                T r3 = sort8<V>(V::load(block + 24));
+                merge16<V>(r2, r3);
+
+                // Ascending 16 against the reversed second 16 splits into two bitonic halves
+                T b0 = V::reverse(r3);
+                T b1 = V::reverse(r2);
+                T l0 = V::min(r0, b0);
+                T l1 = V::min(r1, b1);
+                T h0 = V::max(r0, b0);
+                T h1 = V::max(r1, b1);
+                clean16<V>(l0, l1);
+                clean16<V>(h0, h1);
+                V::store(block, l0);
+                V::store(block + 8, l1);
+                V::store(block + 16, h0);
+                V::store(block + 24, h1);
+                return 240;
+            }
+
+        }
+    }
+}
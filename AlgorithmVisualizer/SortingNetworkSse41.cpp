@@ -0,0 +1,91 @@
+#include "SortingNetwork.h"
+#include <climits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+
+// Everything included above keeps the default target; only the kernels below use SSE4.1
+#if defined(__GNUC__) && !defined(_MSC_VER)
+#pragma GCC target("sse4.1")
+#endif
+
+#include <smmintrin.h>
+#include "SortingNetworkKernels.h"
+
+namespace Algorithms {
+    namespace SortingNetwork {
+
+        namespace {
+            // Eight lanes as two 4-lane registers: lanes 0-3 in lo, 4-7 in hi
+            struct Sse41 {
+                struct Type {
+                    __m128i lo;
+                    __m128i hi;
+                };
+
+                static Type load(const int* values) {
+                    return { _mm_loadu_si128(reinterpret_cast<const __m128i*>(values)),
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + 4)) };
+                }
+                static void store(int* values, Type v) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(values), v.lo);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(values + 4), v.hi);
+                }
+                static Type min(Type a, Type b) { return { _mm_min_epi32(a.lo, b.lo), _mm_min_epi32(a.hi, b.hi) }; }
+                static Type max(Type a, Type b) { return { _mm_max_epi32(a.lo, b.lo), _mm_max_epi32(a.hi, b.hi) }; }
+
+                template <int J>
+                static Type swapLanes(Type v) {
+                    if constexpr (J == 1) {
+                        return { _mm_shuffle_epi32(v.lo, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_epi32(v.hi, _MM_SHUFFLE(2, 3, 0, 1)) };
+                    }
+                    else if constexpr (J == 2) {
+                        return { _mm_shuffle_epi32(v.lo, _MM_SHUFFLE(1, 0, 3, 2)), _mm_shuffle_epi32(v.hi, _MM_SHUFFLE(1, 0, 3, 2)) };
+                    }
+                    else {
+                        return { v.hi, v.lo };
+                    }
+                }
+
+                // _mm_blend_epi16 selects 16-bit halves, so every lane bit becomes two mask bits
+                static constexpr int wordMask(int lanes) {
+                    int mask = 0;
+                    for (int lane = 0; lane < 4; lane++) {
+                        if (lanes & (1 << lane)) {
+                            mask |= 3 << (2 * lane);
+                        }
+                    }
+                    return mask;
+                }
+
+                template <int MASK>
+                static Type blend(Type a, Type b) {
+                    // Named constants, so the immediates are constant even in unoptimized builds
+                    constexpr int lo = wordMask(MASK & 0xF);
+                    constexpr int hi = wordMask(MASK >> 4);
+                    return { _mm_blend_epi16(a.lo, b.lo, lo), _mm_blend_epi16(a.hi, b.hi, hi) };
+                }
+
+                static Type reverse(Type v) {
+                    return { _mm_shuffle_epi32(v.hi, _MM_SHUFFLE(0, 1, 2, 3)), _mm_shuffle_epi32(v.lo, _MM_SHUFFLE(0, 1, 2, 3)) };
+                }
+            };
+        }
+
+        long long sortSse41(int* values, int count) {
+            // Pad to the next block size with the largest int, which sorts to the end
+            int size = count <= 8 ? 8 : (count <= 16 ? 16 : 32);
+            alignas(16) int block[MAX_SIZE];
+            for (int i = 0; i < size; i++) {
+                block[i] = i < count ? values[i] : INT_MAX;
+            }
+            long long comparisons = Kernels::sortBlock<Sse41>(block, size);
+            for (int i = 0; i < count; i++) {
+                values[i] = block[i];
+            }
+            return comparisons;
+        }
+
+    }
+}
+
+#endif
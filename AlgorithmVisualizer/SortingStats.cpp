@@ -1 +1,44 @@
-#include "SortingStats.h"
\ No newline at end of file
+#include "SortingStats.h"
+#include <utility>
+
+namespace Algorithms {
+
+    bool SortingStats::stepBackward(Visualization::VisualizationData& data) {
+        if (history.empty()) {
+            return false;
+        }
+
+        const AlgorithmState state = history.back();
+        history.pop_back();
+
+        // Apply the inverse operations in reverse order
+        for (size_t k = operations.size(); k > state.firstOp; k--) {
+            const ArrayOp& op = operations[k - 1];
+            if (op.type == ArrayOp::Type::Swap) {
+                data.swap(op.first, op.second);
+            }
+            else if (op.type == ArrayOp::Type::ScratchWrite) {
+                (*scratch)[op.first] = op.second;
+            }
+            else {
+                data.set(op.first, op.second);
+            }
+        }
+        operations.resize(state.firstOp);
+
+        comparisons = state.comparisons;
+        swaps = state.swaps;
+        writes = state.writes;
+        currentStep = state.currentStep;
+
+        // Store algorithm state variables for the algorithm to retrieve on the next step
+        lastRestoredI = state.i;
+        lastRestoredJ = state.j;
+        lastRestoredSwapped = state.swapped;
+        lastRestoredK = state.k;
+        stateRestored = true;
+
+        return true;
+    }
+
+}
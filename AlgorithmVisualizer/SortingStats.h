@@ -1,74 +1,230 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
 #include <vector>
 #include "VisualizationData.h"
+#include "OperationTrace.h"
+#include "PerfCounters.h"
+
+namespace Visualization {
+    class SnapshotBuffer;
+}
 
 namespace Algorithms {
+    class SortingWorker;
+
+    // Single array mutation recorded in the undo log
+    struct ArrayOp {
+        enum class Type : unsigned char { Swap, Write, ScratchWrite };
+
+        Type type = Type::Swap;
+        int first = 0;   // Swap: first index, Write/ScratchWrite: written index
+        int second = 0;  // Swap: second index, Write/ScratchWrite: value before the write
+        int value = 0;   // Write/ScratchWrite: value after the write
+    };
+
     // Structure to store the state of the algorithm at each step
     struct AlgorithmState {
         int i = 0;
         int j = 0;
         bool swapped = false;
-        int comparisons = 0;
-        int swaps = 0;
-        std::vector<Visualization::ArrayElement> array;
+        int k = 0;
+        long long comparisons = 0;
+        long long swaps = 0;
+        long long writes = 0;
+        long long currentStep = 0;
+        // Index of the first operation made by this step in SortingStats::operations
+        size_t firstOp = 0;
+    };
+
+    // Counter that one thread adds to while others may read it, e.g. to publish a snapshot mid-run
+    template <typename T>
+    class RelaxedCounter {
+    public:
+        RelaxedCounter(T initial = T()) : value(initial) {}
+        RelaxedCounter(const RelaxedCounter& other) : value(other.get()) {}
+
+        RelaxedCounter& operator=(const RelaxedCounter& other) {
+            value.store(other.get(), std::memory_order_relaxed);
+            return *this;
+        }
+
+        T get() const { return value.load(std::memory_order_relaxed); }
+        operator T() const { return get(); }
+
+        // Only the owner writes, so a load and a store instead of a locked read-modify-write
+        RelaxedCounter& operator+=(T amount) {
+            value.store(get() + amount, std::memory_order_relaxed);
+            return *this;
+        }
+
+        void operator++(int) { *this += 1; }
+
+    private:
+        std::atomic<T> value;
+    };
+
+    // Counters of one worker thread of a parallel algorithm, written only by that worker
+    struct WorkerStats {
+        RelaxedCounter<long long> comparisons;
+        RelaxedCounter<long long> swaps;
+        RelaxedCounter<long long> writes;
+        RelaxedCounter<long long> tasks;
+        RelaxedCounter<long long> steals;
+        RelaxedCounter<double> idleSeconds;
     };
 
     struct SortingStats {
-        int comparisons = 0;
-        int swaps = 0;
-        int currentStep = 0;
-        bool isSorting = false;
+        long long comparisons = 0;
+        // Every element move; writes counts those that stored a single element rather than exchanging two
+        long long swaps = 0;
+        long long writes = 0;
+        long long currentStep = 0;
+        // Traffic to temporary files of algorithms that sort out of memory
+        long long bytesRead = 0;
+        long long bytesWritten = 0;
+        // Cleared from another thread to stop a run, e.g. by the worker taking a pause command
+        std::atomic<bool> isSorting{ false };
         bool sortingComplete = false;
-        int speedFactor = 50;
+        // Delay between steps in ms; changed by the worker while the algorithm's threads read it
+        std::atomic<int> speedFactor{ 50 };
         bool steppingMode = false;
-        
+        // Keep the undo log; headless runs turn it off to measure the bare algorithm
+        bool recordHistory = true;
+        // Optional sink receiving every step and event for later playback
+        OperationTrace* trace = nullptr;
+        // Optional frame buffer the algorithm publishes to whenever it paces, read by the render loop
+        Visualization::SnapshotBuffer* snapshots = nullptr;
+        // Worker thread driving the algorithm; when set, pacing takes its commands and sleeps interruptibly
+        SortingWorker* worker = nullptr;
+        // Auxiliary buffer of the running algorithm; its recorded writes are undone with the array's
+        std::vector<int>* scratch = nullptr;
+
         // Variables for state restoration when stepping backward
         int lastRestoredI = 0;
         int lastRestoredJ = 0;
         bool lastRestoredSwapped = false;
+        int lastRestoredK = 0;
         bool stateRestored = false;
-        
+
         // History of algorithm states for stepping backward
         std::vector<AlgorithmState> history;
-        
+        // Undo log: array mutations of every step in history, in execution order
+        std::vector<ArrayOp> operations;
+        // Per-thread counters, empty for single-threaded algorithms
+        std::vector<WorkerStats> workers;
+        // Hardware counters of the run by phase, filled by the PerfScopes open for it while counting is on
+        Utils::PerfRecorder perf;
+
         void reset() {
             comparisons = 0;
             swaps = 0;
+            writes = 0;
             currentStep = 0;
+            bytesRead = 0;
+            bytesWritten = 0;
             isSorting = false;
             sortingComplete = false;
             steppingMode = false;
             lastRestoredI = 0;
             lastRestoredJ = 0;
             lastRestoredSwapped = false;
+            lastRestoredK = 0;
             stateRestored = false;
+            workers.clear();
+            perf.reset();
+            clearHistory();
+        }
+
+        void clearHistory() {
             history.clear();
+            operations.clear();
         }
-        
-        // Save current state to history
-        void saveState(const Visualization::VisualizationData& data, int i, int j, bool swapped) {
-            // Limit history size to prevent excessive memory usage
-            const size_t MAX_HISTORY_SIZE = 100;
-            
-            // If history is getting too large, remove oldest entries
-            if (history.size() >= MAX_HISTORY_SIZE) {
-                // Remove the oldest entry
-                history.erase(history.begin());
+
+        // Start a new step in the history; array mutations recorded after this call belong to it
+        void saveState(int i, int j, bool swapped, int k = 0) {
+            if (trace) {
+                trace->beginStep(comparisons, swaps);
+            }
+            if (!recordHistory) {
+                return;
             }
-            
+
             AlgorithmState state;
             state.i = i;
             state.j = j;
             state.swapped = swapped;
+            state.k = k;
             state.comparisons = comparisons;
             state.swaps = swaps;
-            state.array = data.getArray();
+            state.writes = writes;
+            state.currentStep = currentStep;
+            state.firstOp = operations.size();
             history.push_back(state);
         }
-        
+
+        // Record a swap of two array elements made by the current step
+        void recordSwap(int first, int second) {
+            if (trace) {
+                trace->swap(first, second);
+            }
+            if (recordHistory) {
+                operations.push_back({ ArrayOp::Type::Swap, first, second, 0 });
+            }
+        }
+
+        // Record a single element write made by the current step
+        void recordWrite(int index, int oldValue, int newValue) {
+            if (trace) {
+                trace->write(index, oldValue, newValue);
+            }
+            if (recordHistory) {
+                operations.push_back({ ArrayOp::Type::Write, index, oldValue, newValue });
+            }
+        }
+
+        // Record a write to the scratch buffer made by the current step (undo only, not traced)
+        void recordScratchWrite(int index, int oldValue, int newValue) {
+            if (recordHistory) {
+                operations.push_back({ ArrayOp::Type::ScratchWrite, index, oldValue, newValue });
+            }
+        }
+
+        // Keys other than int are never recorded: the log holds ints, and windows sorting other keys keep none
+        template <typename Key>
+        void recordWrite(int, const Key&, const Key&) {}
+        template <typename Key>
+        void recordScratchWrite(int, const Key&, const Key&) {}
+
+        // Set scratch to the running algorithm's buffer, if it holds ints
+        template <typename Key>
+        void setScratch(std::vector<Key>* buffer) {
+            if constexpr (std::is_same_v<Key, int>) {
+                scratch = buffer;
+            }
+        }
+
+        // Record a comparison made by the current step (trace only, nothing to undo)
+        void recordCompare(int first, int second) {
+            if (trace) {
+                trace->compare(first, second);
+            }
+        }
+
+        // Mark the range the algorithm is working on (trace only, nothing to undo)
+        void recordRange(int low, int high) {
+            if (trace) {
+                trace->range(low, high);
+            }
+        }
+
         // Can we step backward?
         bool canStepBackward() const {
             return currentStep > 0 && !history.empty();
         }
+
+        // Undo the most recent step by applying the inverse of its operations
+        bool stepBackward(Visualization::VisualizationData& data);
     };
-}
\ No newline at end of file
+}
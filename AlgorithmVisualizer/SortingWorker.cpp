@@ -0,0 +1,313 @@
+#include "SortingWorker.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace Algorithms {
+
+    SortingWorker::SortingWorker(AlgorithmBase& algorithm, Visualization::VisualizationState& data, SortingStats& stats,
+        Visualization::SnapshotBuffer& snapshots, Advance advance)
+        : algorithm(algorithm), data(data), stats(stats), snapshots(snapshots), advance(advance), scheduler(Scheduler::getDefault()) {
+        stats.worker = this;
+    }
+
+    SortingWorker::~SortingWorker() {
+        // The queue drains at every slice and every pace, so a full one frees up quickly
+        while (!send(CommandType::Quit)) {
+            std::this_thread::yield();
+        }
+        scheduler.remove(*this);
+        stats.worker = nullptr;
+    }
+
+    bool SortingWorker::start() {
+        return send(CommandType::Start);
+    }
+
+    bool SortingWorker::pause() {
+        return send(CommandType::Pause);
+    }
+
+    bool SortingWorker::resume() {
+        return send(CommandType::Resume);
+    }
+
+    bool SortingWorker::step(int count) {
+        return send(CommandType::Step, count);
+    }
+
+    bool SortingWorker::cancel() {
+        return send(CommandType::Cancel);
+    }
+
+    bool SortingWorker::setSpeed(int delayMs) {
+        return send(CommandType::SetSpeed, delayMs);
+    }
+
+    bool SortingWorker::race(const VirtualClock& clock, const CostModel& costModel) {
+        // The worker reads these only while running a command, and the command is not sent yet
+        if (!isIdle()) {
+            return false;
+        }
+        raceClock = &clock;
+        this->costModel = costModel;
+        return send(CommandType::Race);
+    }
+
+    bool SortingWorker::send(CommandType type, int value) {
+        if (!commands.push({ type, value })) {
+            return false;
+        }
+        submitted++;
+        wake.release();
+        scheduler.notify(*this);
+        return true;
+    }
+
+    bool SortingWorker::runSlice(Scheduler::Clock::time_point& due) {
+        // Team members lent to a parallel algorithm count for the same run
+        Utils::PerfScope perf(&stats.perf);
+
+        Command command;
+        while (!quitRequested && commands.pop(command)) {
+            taken++;
+            execute(command);
+        }
+        if (quitRequested) {
+            return false;
+        }
+
+        bool more = false;
+        if (running) {
+            more = advanceRun(due);
+        }
+        else if (pendingSteps > 0) {
+            more = advanceSteps();
+            due = Scheduler::Clock::now();
+        }
+        publish();
+        if (more) {
+            return true;
+        }
+
+        // Hand the data back to the UI thread until the next command
+        completed.store(taken, std::memory_order_release);
+        return false;
+    }
+
+    void SortingWorker::execute(const Command& command) {
+        bool busy = running || pendingSteps > 0;
+
+        switch (command.type) {
+        case CommandType::Start:
+        case CommandType::Race:
+            if (busy) {
+                break;
+            }
+            if (command.type == CommandType::Start) {
+                raceClock = nullptr;
+            }
+            stats.sortingComplete = false;
+            if (stats.currentStep == 0) {
+                stats.comparisons = 0;
+                stats.swaps = 0;
+                stats.writes = 0;
+                stats.bytesRead = 0;
+                stats.bytesWritten = 0;
+                stats.perf.reset();
+                stats.clearHistory();
+            }
+            beginRun();
+            break;
+        case CommandType::Resume:
+            // The run picks up from the current step; it only starts over when nothing has run yet
+            if (!busy && !stats.sortingComplete) {
+                beginRun();
+            }
+            break;
+        case CommandType::Step:
+            if (!busy) {
+                pendingSteps = command.value;
+            }
+            break;
+        case CommandType::Pause:
+            if (running) {
+                running = false;
+                data.resetHighlighting();
+            }
+            pendingSteps = 0;
+            stats.isSorting = false;
+            break;
+        case CommandType::Cancel:
+            running = false;
+            pendingSteps = 0;
+            raceClock = nullptr;
+            cancelRequested = true;
+            break;
+        case CommandType::SetSpeed:
+            stats.speedFactor = command.value;
+            break;
+        case CommandType::Quit:
+            quitRequested = true;
+            break;
+        }
+
+        if (cancelRequested) {
+            cancelRequested = false;
+            algorithm.reset();
+            stats.reset();
+            data.resetHighlighting();
+            data.markedLow = -1;
+            data.markedHigh = -1;
+        }
+    }
+
+    void SortingWorker::beginRun() {
+        if (!algorithm.supportsStepping()) {
+            // Runs to completion in this slice; wake-ups left by commands already handled are stale
+            while (wake.try_acquire()) {
+            }
+            stats.isSorting = true;
+            advance(algorithm, data, stats, true);
+            return;
+        }
+
+        // What run() does before its loop: start over unless a paused run is picking up again
+        if (stats.currentStep == 0) {
+            algorithm.reset();
+            stats.reset();
+        }
+        stats.isSorting = true;
+        running = true;
+    }
+
+    bool SortingWorker::advanceRun(Scheduler::Clock::time_point& due) {
+        auto start = Scheduler::Clock::now();
+        auto slice = std::chrono::milliseconds(SLICE_MS);
+        if (raceClock) {
+            // Catch up with the virtual clock, then wait until it passes the cost spent so far
+            double target = raceClock->now();
+            double cost = costModel.getCost(stats);
+            while (cost <= target && stats.isSorting && !stats.sortingComplete && Scheduler::Clock::now() - start < slice) {
+                advance(algorithm, data, stats, false);
+                cost = costModel.getCost(stats);
+            }
+            if (stats.isSorting && !stats.sortingComplete) {
+                auto now = Scheduler::Clock::now();
+                due = cost <= target ? now : std::min(raceClock->getWallTime(cost), now + std::chrono::milliseconds(RACE_POLL_MS));
+                return true;
+            }
+        }
+        else {
+            // One step per delay, or as many as fit in a slice when there is no delay
+            int delay = stats.speedFactor;
+            do {
+                advance(algorithm, data, stats, false);
+            } while (delay <= 0 && stats.isSorting && !stats.sortingComplete && Scheduler::Clock::now() - start < slice);
+
+            if (stats.isSorting && !stats.sortingComplete) {
+                due = Scheduler::Clock::now() + std::chrono::milliseconds(std::max(delay, 0));
+                return true;
+            }
+        }
+
+        // What run() does after its loop
+        running = false;
+        data.resetHighlighting();
+        if (stats.isSorting) {
+            stats.sortingComplete = true;
+            stats.isSorting = false;
+        }
+        return false;
+    }
+
+    bool SortingWorker::advanceSteps() {
+        bool steppingMode = stats.steppingMode;
+        stats.steppingMode = true;
+
+        auto start = Scheduler::Clock::now();
+        while (pendingSteps > 0 && !stats.sortingComplete) {
+            stats.isSorting = true;
+            advance(algorithm, data, stats, false);
+            pendingSteps--;
+            if (Scheduler::Clock::now() - start >= std::chrono::milliseconds(SLICE_MS)) {
+                break;
+            }
+        }
+        if (stats.sortingComplete) {
+            pendingSteps = 0;
+        }
+
+        stats.isSorting = false;
+        stats.steppingMode = steppingMode;
+        return pendingSteps > 0;
+    }
+
+    void SortingWorker::pace() {
+        takeCommands();
+
+        auto start = std::chrono::steady_clock::now();
+        while (true) {
+            // Counted before isSorting is checked, so a stop either is seen here or wakes this thread
+            sleepers++;
+            if (!stats.isSorting || stats.speedFactor <= 0) {
+                sleepers--;
+                return;
+            }
+            bool woken = wake.try_acquire_until(start + std::chrono::milliseconds(stats.speedFactor));
+            sleepers--;
+            if (!woken) {
+                return;
+            }
+            // A new command, or a stop taken by another thread; a speed change restarts the wait from the same start
+            takeCommands();
+        }
+    }
+
+    void SortingWorker::takeCommands() {
+        if (taking.test_and_set(std::memory_order_acquire)) {
+            return;
+        }
+
+        Command command;
+        while (commands.pop(command)) {
+            taken++;
+            switch (command.type) {
+            case CommandType::Pause:
+                interrupt();
+                break;
+            case CommandType::Cancel:
+                cancelRequested = true;
+                interrupt();
+                break;
+            case CommandType::Quit:
+                quitRequested = true;
+                interrupt();
+                break;
+            case CommandType::SetSpeed:
+                stats.speedFactor = command.value;
+                break;
+            default:
+                // Start, resume and step are meant for an idle worker
+                break;
+            }
+        }
+
+        taking.clear(std::memory_order_release);
+    }
+
+    void SortingWorker::interrupt() {
+        stats.isSorting = false;
+
+        // Cut short the delays of the other threads of a parallel algorithm
+        int count = sleepers.load();
+        if (count > 0) {
+            wake.release(count);
+        }
+    }
+
+    void SortingWorker::publish() {
+        snapshots.publish(stats, algorithm.getPhaseName());
+    }
+
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include "Algorithm.h"
+#include "Scheduler.h"
+#include "SnapshotBuffer.h"
+#include "SpscQueue.h"
+#include "VirtualClock.h"
+#include <atomic>
+#include <cstdint>
+#include <semaphore>
+
+namespace Algorithms {
+
+    // Drives one algorithm on the shared Scheduler, controlled from the UI thread through a
+    // lock-free command queue. Steppable algorithms run a slice at a time, one step per delay or
+    // as many as fit in SLICE_MS at full speed, so the delay holds no thread. Algorithms without
+    // step() run to completion in one slice; their pacing takes commands and the delay is a wait
+    // that the next command cuts short. The UI thread may touch the data and stats only while the
+    // worker is idle: every command sent so far has been handled and nothing is left to run.
+    class SortingWorker : public Scheduler::Job {
+    public:
+        // The algorithm and the data may be of any one key type
+        template <typename Key, typename Compare>
+        SortingWorker(BasicAlgorithm<Key, Compare>& algorithm, Visualization::BasicVisualizationData<Key>& data, SortingStats& stats,
+            Visualization::SnapshotBuffer& snapshots)
+            : SortingWorker(algorithm, data, stats, snapshots, &advanceKeys<Key, Compare>) {}
+        // Stops any run and waits for its slice to return
+        ~SortingWorker() override;
+
+        SortingWorker(const SortingWorker&) = delete;
+        SortingWorker& operator=(const SortingWorker&) = delete;
+
+        // UI thread only; each returns false when the queue is full and the command was dropped.
+        // Start, resume and step are meant for an idle worker and are ignored during a run.
+        bool start();
+        bool pause();
+        bool resume();
+        bool step(int count);
+        // Stop, then reset the stats and the algorithm, keeping the array as it is
+        bool cancel();
+        bool setSpeed(int delayMs);
+        // Like start, but each step waits for the shared virtual clock to pass the cost spent so far
+        // instead of the delay. Resume keeps racing, start and cancel end it. Only sent while idle.
+        bool race(const VirtualClock& clock, const CostModel& costModel);
+
+        void setPriority(Scheduler::Priority priority) { scheduler.setPriority(*this, priority); }
+        Scheduler::Priority getPriority() const { return scheduler.getPriority(*this); }
+
+        bool isIdle() const { return completed.load(std::memory_order_acquire) == submitted; }
+
+        // Called through Algorithm::pace on the algorithm's threads: take new commands, then wait out the delay
+        void pace();
+
+    protected:
+        bool runSlice(Scheduler::Clock::time_point& due) override;
+
+    private:
+        // Calls run() of algorithm on data when toCompletion is set, step() otherwise
+        using Advance = void (*)(AlgorithmBase& algorithm, Visualization::VisualizationState& data, SortingStats& stats, bool toCompletion);
+
+        enum class CommandType : uint8_t { Start, Race, Pause, Resume, Step, Cancel, SetSpeed, Quit };
+
+        struct Command {
+            CommandType type = CommandType::Pause;
+            int value = 0;
+        };
+
+        // Longest a slice keeps stepping before it lets other instances have the thread
+        static constexpr int SLICE_MS = 2;
+        // Longest a racing algorithm waits before it looks at the virtual clock again, in case its rate changed
+        static constexpr int RACE_POLL_MS = 50;
+
+        AlgorithmBase& algorithm;
+        Visualization::VisualizationState& data;
+        SortingStats& stats;
+        Visualization::SnapshotBuffer& snapshots;
+        // Made by the constructor for the key type it was given, which both references still have
+        Advance advance;
+        Scheduler& scheduler;
+
+        Utils::SpscQueue<Command, 256> commands;
+        // Released once per command sent, and again for every thread sleeping in pace() when a run stops
+        std::counting_semaphore<> wake{ 0 };
+        std::atomic<int> sleepers{ 0 };
+        // Threads of a parallel algorithm all pace; one of them at a time takes the commands
+        std::atomic_flag taking = ATOMIC_FLAG_INIT;
+
+        // Commands sent (UI thread), taken from the queue, and handled as of the last time the worker went idle
+        unsigned long long submitted = 0;
+        unsigned long long taken = 0;
+        std::atomic<unsigned long long> completed{ 0 };
+
+        // State carried from one slice to the next; slices of one job never overlap
+        bool running = false;
+        int pendingSteps = 0;
+        // Set by race() while idle; a run paced by it ignores the delay
+        const VirtualClock* raceClock = nullptr;
+        CostModel costModel;
+
+        // Requests taken in the middle of a blocking run, acted on when it returns
+        bool cancelRequested = false;
+        bool quitRequested = false;
+
+        SortingWorker(AlgorithmBase& algorithm, Visualization::VisualizationState& data, SortingStats& stats,
+            Visualization::SnapshotBuffer& snapshots, Advance advance);
+
+        template <typename Key, typename Compare>
+        static void advanceKeys(AlgorithmBase& algorithm, Visualization::VisualizationState& data, SortingStats& stats, bool toCompletion) {
+            auto& keyAlgorithm = static_cast<BasicAlgorithm<Key, Compare>&>(algorithm);
+            auto& keyData = static_cast<Visualization::BasicVisualizationData<Key>&>(data);
+            if (toCompletion) {
+                keyAlgorithm.run(keyData, stats);
+            }
+            else {
+                keyAlgorithm.step(keyData, stats);
+            }
+        }
+
+        bool send(CommandType type, int value = 0);
+        void execute(const Command& command);
+        void beginRun();
+        // Each returns true while there is more to do in a later slice
+        bool advanceRun(Scheduler::Clock::time_point& due);
+        bool advanceSteps();
+        void takeCommands();
+        void interrupt();
+        void publish();
+    };
+
+}
@@ -0,0 +1,150 @@
+#include "SpillFile.h"
+#include <filesystem>
+#include <random>
+
+namespace Utils {
+
+    namespace {
+        // Names tried before giving up on finding an unused one
+        constexpr int MAX_NAME_ATTEMPTS = 16;
+    }
+
+    SpillFile::SpillFile() : scheduler(Algorithms::Scheduler::getDefault()) {}
+
+    SpillFile::~SpillFile() {
+        close();
+        scheduler.remove(*this);
+    }
+
+    bool SpillFile::createTemporary(std::string& error) {
+        std::error_code directoryError;
+        std::filesystem::path directory = std::filesystem::temp_directory_path(directoryError);
+        if (directoryError) {
+            error = "no temporary directory: " + directoryError.message();
+            return false;
+        }
+
+        std::random_device device;
+        for (int attempt = 0; attempt < MAX_NAME_ATTEMPTS; attempt++) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "avsort-%08x%08x.run", device(), device());
+            // "x" fails instead of truncating when the name is already taken
+            if (open((directory / name).string(), "w+bx", error)) {
+                temporary = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool SpillFile::create(const std::string& path, std::string& error) {
+        return open(path, "w+b", error);
+    }
+
+    bool SpillFile::open(const std::string& path, const char* mode, std::string& error) {
+        close();
+        file = std::fopen(path.c_str(), mode);
+        if (file == nullptr) {
+            error = "could not create '" + path + "'";
+            return false;
+        }
+        // Transfers are whole blocks, so the stdio buffer would only add a copy
+        std::setvbuf(file, nullptr, _IONBF, 0);
+        this->path = path;
+        temporary = false;
+        failed = false;
+        bytesRead = 0;
+        bytesWritten = 0;
+        return true;
+    }
+
+    bool SpillFile::close() {
+        if (file == nullptr) {
+            return !failed;
+        }
+        wait();
+        if (std::fclose(file) != 0) {
+            failed = true;
+        }
+        file = nullptr;
+        if (temporary) {
+            std::error_code removeError;
+            std::filesystem::remove(path, removeError);
+        }
+        return !failed;
+    }
+
+    void SpillFile::write(const void* buffer, size_t bytes) {
+        post(true, const_cast<void*>(buffer), bytes);
+    }
+
+    void SpillFile::read(void* buffer, size_t bytes) {
+        post(false, buffer, bytes);
+    }
+
+    void SpillFile::post(bool writing, void* buffer, size_t bytes) {
+        wait();
+        this->writing = writing;
+        this->buffer = buffer;
+        this->bytes = bytes;
+        moved = 0;
+        transfer.store(Transfer::Pending, std::memory_order_release);
+        scheduler.notify(*this);
+    }
+
+    size_t SpillFile::wait() {
+        if (transfer.load(std::memory_order_acquire) == Transfer::None) {
+            return 0;
+        }
+
+        Transfer expected = Transfer::Pending;
+        if (transfer.compare_exchange_strong(expected, Transfer::Running, std::memory_order_acq_rel)) {
+            perform();
+        }
+        else {
+            // A pool thread has it and signals once it is done
+            finished.acquire();
+        }
+        transfer.store(Transfer::None, std::memory_order_relaxed);
+
+        if (writing) {
+            bytesWritten += moved;
+            failed = failed || moved != bytes;
+        }
+        else {
+            bytesRead += moved;
+        }
+        return moved;
+    }
+
+    bool SpillFile::rewind() {
+        wait();
+        if (file == nullptr || std::fflush(file) != 0 || std::fseek(file, 0, SEEK_SET) != 0) {
+            failed = true;
+        }
+        return !failed;
+    }
+
+    bool SpillFile::runSlice(Algorithms::Scheduler::Clock::time_point&) {
+        // A late slice finds the transfer already done by wait(), or the next one posted since
+        Transfer expected = Transfer::Pending;
+        if (transfer.compare_exchange_strong(expected, Transfer::Running, std::memory_order_acq_rel)) {
+            perform();
+            finished.release();
+        }
+        return false;
+    }
+
+    void SpillFile::perform() {
+        if (writing) {
+            moved = std::fwrite(buffer, 1, bytes, file);
+        }
+        else {
+            moved = std::fread(buffer, 1, bytes, file);
+            if (moved < bytes && std::ferror(file)) {
+                failed = true;
+            }
+        }
+    }
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "Scheduler.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <semaphore>
+#include <string>
+
+namespace Utils {
+
+    // A file written front to back and then read back front to back, one block per transfer.
+    // A transfer runs on the shared scheduler while the caller fills or drains its other buffer;
+    // wait() does it on the calling thread instead when no pool thread has taken it yet, so a
+    // pool kept busy by the caller itself never leaves it waiting.
+    class SpillFile : public Algorithms::Scheduler::Job {
+    public:
+        SpillFile();
+        // Waits for the transfer in flight, closes the file and removes it if it is temporary
+        ~SpillFile() override;
+
+        SpillFile(const SpillFile&) = delete;
+        SpillFile& operator=(const SpillFile&) = delete;
+
+        // Creates an empty file with a unique name in the system's temporary directory
+        bool createTemporary(std::string& error);
+        // Creates path, replacing any file there; it is kept when closed
+        bool create(const std::string& path, std::string& error);
+        // Waits and closes the file; false when any transfer or the final flush failed
+        bool close();
+
+        // Starts appending bytes from buffer, after waiting for the previous transfer.
+        // The buffer must stay untouched until the next wait().
+        void write(const void* buffer, size_t bytes);
+        // Starts reading up to bytes into buffer from the current position
+        void read(void* buffer, size_t bytes);
+        // Waits for the transfer in flight, if any, and returns the bytes it moved
+        size_t wait();
+        // Waits, then moves back to the start to read what was written
+        bool rewind();
+
+        bool hasFailed() const { return failed; }
+        const std::string& getPath() const { return path; }
+        uint64_t getBytesRead() const { return bytesRead; }
+        uint64_t getBytesWritten() const { return bytesWritten; }
+
+    protected:
+        bool runSlice(Algorithms::Scheduler::Clock::time_point& due) override;
+
+    private:
+        enum class Transfer : int { None, Pending, Running };
+
+        Algorithms::Scheduler& scheduler;
+        std::FILE* file = nullptr;
+        std::string path;
+        bool temporary = false;
+        bool failed = false;
+
+        // Claimed by whichever of a pool thread and wait() moves it from Pending to Running first
+        std::atomic<Transfer> transfer{ Transfer::None };
+        std::binary_semaphore finished{ 0 };
+        // Set before the transfer is posted and read back after it is waited for
+        bool writing = false;
+        void* buffer = nullptr;
+        size_t bytes = 0;
+        size_t moved = 0;
+
+        uint64_t bytesRead = 0;
+        uint64_t bytesWritten = 0;
+
+        bool open(const std::string& path, const char* mode, std::string& error);
+        void post(bool writing, void* buffer, size_t bytes);
+        void perform();
+    };
+
+}
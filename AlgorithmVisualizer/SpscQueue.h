@@ -0,0 +1,44 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace Utils {
+
+    // Bounded lock-free queue between exactly one producer thread and one consumer thread.
+    // Each side advances only its own index and reads the other's, so neither ever waits.
+    template <typename T, size_t Capacity>
+    class SpscQueue {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        // Producer only; returns false when the queue is full
+        bool push(const T& item) {
+            size_t tail = writeIndex.load(std::memory_order_relaxed);
+            if (tail - readIndex.load(std::memory_order_acquire) == Capacity) {
+                return false;
+            }
+            items[tail & (Capacity - 1)] = item;
+            writeIndex.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only; returns false when the queue is empty
+        bool pop(T& item) {
+            size_t head = readIndex.load(std::memory_order_relaxed);
+            if (head == writeIndex.load(std::memory_order_acquire)) {
+                return false;
+            }
+            item = items[head & (Capacity - 1)];
+            readIndex.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        std::array<T, Capacity> items{};
+        // On separate cache lines so the two threads do not contend for one
+        alignas(64) std::atomic<size_t> writeIndex{ 0 };
+        alignas(64) std::atomic<size_t> readIndex{ 0 };
+    };
+
+}
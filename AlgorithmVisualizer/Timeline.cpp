@@ -0,0 +1,288 @@
+#include "Timeline.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace Algorithms {
+
+    using Event = OperationTrace::Event;
+    using EventType = OperationTrace::EventType;
+
+    Timeline::Timeline(size_t memoryBudget) : scheduler(Scheduler::getDefault()), memoryBudget(memoryBudget) {}
+
+    Timeline::~Timeline() {
+        waitForRecording();
+        scheduler.remove(*this);
+    }
+
+    void Timeline::startRecording(Algorithm& algorithm, const Visualization::VisualizationData& input) {
+        clear();
+        pendingAlgorithm = &algorithm;
+        pendingInput = input;
+        recording.store(Recording::Pending, std::memory_order_release);
+        scheduler.notify(*this);
+    }
+
+    bool Timeline::runSlice(Scheduler::Clock::time_point&) {
+        // A late slice finds the recording dropped by clear(), or the next one posted since
+        Recording expected = Recording::Pending;
+        if (recording.compare_exchange_strong(expected, Recording::Running, std::memory_order_acq_rel)) {
+            // Blocks this pool thread for the whole run, as a non-steppable algorithm's run does
+            record(*pendingAlgorithm, pendingInput);
+            pendingInput = Visualization::VisualizationData(0);
+            recording.store(Recording::Done, std::memory_order_release);
+            finished.release();
+        }
+        return false;
+    }
+
+    void Timeline::waitForRecording() {
+        Recording expected = Recording::Pending;
+        if (recording.compare_exchange_strong(expected, Recording::None, std::memory_order_acq_rel)) {
+            return;
+        }
+        if (expected != Recording::None) {
+            // Running or done: the slice signals once it has returned from record()
+            finished.acquire();
+            recording.store(Recording::None, std::memory_order_relaxed);
+        }
+    }
+
+    void Timeline::record(Algorithm& algorithm, const Visualization::VisualizationData& input) {
+        Visualization::VisualizationData scratch = input;
+        SortingStats stats;
+        stats.speedFactor = 0;
+        // The trace replaces the undo log; nothing else is kept per step
+        stats.recordHistory = false;
+        stats.trace = &trace;
+
+        trace.clear();
+        algorithm.reset();
+        if (algorithm.supportsStepping()) {
+            stats.isSorting = true;
+            while (stats.isSorting && !stats.sortingComplete) {
+                algorithm.step(scratch, stats);
+            }
+        }
+        else {
+            algorithm.run(scratch, stats);
+        }
+        algorithm.reset();
+        trace.finish(stats.comparisons, stats.swaps);
+
+        auto inputValues = input.getValues();
+        initial.assign(inputValues.begin(), inputValues.end());
+
+        view = input;
+        position = 0;
+        buildCheckpoints();
+        seek(0);
+        ready = true;
+    }
+
+    bool Timeline::isRecording() const {
+        Recording state = recording.load(std::memory_order_acquire);
+        return state == Recording::Pending || state == Recording::Running;
+    }
+
+    bool Timeline::isReady() const {
+        return !isRecording() && ready;
+    }
+
+    void Timeline::clear() {
+        waitForRecording();
+        initial.clear();
+        trace.clear();
+        checkpoints.clear();
+        position = 0;
+        playing = false;
+        pendingSteps = 0.0;
+        viewStats.reset();
+        ready = false;
+    }
+
+    void Timeline::play(bool playForward) {
+        forward = playForward;
+        playing = true;
+        pendingSteps = 0.0;
+    }
+
+    void Timeline::update(double seconds) {
+        if (!playing || !ready) {
+            return;
+        }
+
+        // Carry the fractional part over so slow rates still advance evenly
+        pendingSteps += seconds * playbackRate;
+        double whole = std::floor(pendingSteps);
+        pendingSteps -= whole;
+
+        size_t stepCount = getStepCount();
+        size_t distance = whole >= static_cast<double>(stepCount) ? stepCount : static_cast<size_t>(whole);
+        if (forward) {
+            size_t target = std::min(position + distance, stepCount);
+            seek(target);
+            playing = target < stepCount;
+        }
+        else {
+            size_t target = position > distance ? position - distance : 0;
+            seek(target);
+            playing = target > 0;
+        }
+    }
+
+    void Timeline::setMemoryBudget(size_t bytes) {
+        memoryBudget = bytes;
+        if (ready) {
+            // The view stays at the current position; only the index changes
+            buildCheckpoints();
+        }
+    }
+
+    size_t Timeline::getMemoryUsage() const {
+        size_t bytes = trace.getMemoryUsage();
+        for (const auto& checkpoint : checkpoints) {
+            bytes += checkpoint.capacity() * sizeof(int);
+        }
+        return bytes;
+    }
+
+    void Timeline::buildCheckpoints() {
+        checkpoints.clear();
+
+        // Spread as many checkpoints as the budget allows evenly over the run
+        size_t stepCount = trace.getStepCount();
+        size_t checkpointBytes = std::max<size_t>(initial.size() * sizeof(int), 1);
+        size_t maxCheckpoints = std::max<size_t>(memoryBudget / checkpointBytes, 1);
+        checkpointInterval = std::max<size_t>((stepCount + maxCheckpoints - 1) / maxCheckpoints, 1);
+
+        // One sequential pass over the trace, copying the array at every interval
+        std::vector<int> values = initial;
+        checkpoints.push_back(values);
+        OperationTrace::Reader reader(trace, 0);
+        Event event;
+        while (reader.next(event)) {
+            if (event.type == EventType::Step) {
+                size_t step = reader.getStep();
+                if (step > 0 && step % checkpointInterval == 0) {
+                    checkpoints.push_back(values);
+                }
+            }
+            else if (event.type == EventType::Swap) {
+                std::swap(values[event.first], values[event.second]);
+            }
+            else if (event.type == EventType::Write) {
+                values[event.first] = event.newValue;
+            }
+        }
+        if (stepCount > 0 && stepCount % checkpointInterval == 0) {
+            checkpoints.push_back(values);
+        }
+    }
+
+    void Timeline::applyForward(size_t from, size_t to) {
+        if (from >= to) {
+            return;
+        }
+
+        OperationTrace::Reader reader(trace, from);
+        Event event;
+        while (reader.next(event)) {
+            if (event.type == EventType::Step && reader.getStep() == to) {
+                break;
+            }
+            if (event.type == EventType::Swap) {
+                view.swap(event.first, event.second);
+            }
+            else if (event.type == EventType::Write) {
+                view.set(event.first, event.newValue);
+            }
+        }
+    }
+
+    void Timeline::applyBackward(size_t from, size_t to) {
+        if (to >= from) {
+            return;
+        }
+
+        // The trace only decodes forward; collect the steps and undo them in reverse
+        std::vector<Event> events;
+        OperationTrace::Reader reader(trace, to);
+        Event event;
+        while (reader.next(event)) {
+            if (event.type == EventType::Step && reader.getStep() == from) {
+                break;
+            }
+            if (event.type == EventType::Swap || event.type == EventType::Write) {
+                events.push_back(event);
+            }
+        }
+
+        for (auto it = events.rbegin(); it != events.rend(); ++it) {
+            if (it->type == EventType::Swap) {
+                view.swap(it->first, it->second);
+            }
+            else {
+                view.set(it->first, it->oldValue);
+            }
+        }
+    }
+
+    void Timeline::seek(size_t step) {
+        step = std::min(step, trace.getStepCount());
+        size_t checkpoint = std::min(step / checkpointInterval, checkpoints.size() - 1);
+        size_t checkpointStep = checkpoint * checkpointInterval;
+
+        if (step >= position && position >= checkpointStep) {
+            // Already between the nearest checkpoint and the target
+            applyForward(position, step);
+        }
+        else if (step < position && position - step <= step - checkpointStep) {
+            // Undoing back to the target is cheaper than replaying from the checkpoint
+            applyBackward(position, step);
+        }
+        else {
+            const auto& values = checkpoints[checkpoint];
+            std::copy(values.begin(), values.end(), view.getValues().begin());
+            view.markAllDirty();
+            applyForward(checkpointStep, step);
+        }
+
+        position = step;
+        updateView();
+    }
+
+    void Timeline::updateView() {
+        view.resetHighlighting();
+
+        // Highlight the elements touched by the step that led to this position
+        if (position > 0) {
+            OperationTrace::Reader reader(trace, position - 1);
+            Event event;
+            while (reader.next(event)) {
+                if (event.type == EventType::Step) {
+                    if (reader.getStep() == position) {
+                        break;
+                    }
+                }
+                else if (event.type == EventType::Compare) {
+                    view.setComparing(event.first);
+                    view.setComparing(event.second);
+                }
+                else if (event.type == EventType::Swap) {
+                    view.setSwapping(event.first);
+                    view.setSwapping(event.second);
+                }
+                else if (event.type == EventType::Write) {
+                    view.setSwapping(event.first);
+                }
+            }
+        }
+
+        trace.getRangeAt(position, view.markedLow, view.markedHigh);
+        trace.getCountersAt(position, viewStats.comparisons, viewStats.swaps);
+        viewStats.currentStep = static_cast<long long>(position);
+        viewStats.sortingComplete = trace.getStepCount() > 0 && position == trace.getStepCount();
+    }
+
+}
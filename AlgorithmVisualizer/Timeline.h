@@ -0,0 +1,103 @@
+#pragma once
+#include "Algorithm.h"
+#include "OperationTrace.h"
+#include "Scheduler.h"
+#include <atomic>
+#include <cstddef>
+#include <semaphore>
+#include <vector>
+
+namespace Algorithms {
+
+    // Recorded run of an algorithm that can be scrubbed to any step or played back.
+    // The algorithm runs once at full speed into a compact operation trace; the
+    // array is checkpointed every few steps and a seek restores the nearest
+    // checkpoint and decodes the trace forward from there. Background recordings run as a
+    // job on the shared scheduler.
+    class Timeline : public Scheduler::Job {
+    public:
+        Timeline(size_t memoryBudget = 64 * 1024 * 1024);
+        // Waits for a recording in progress
+        ~Timeline() override;
+
+        Timeline(const Timeline&) = delete;
+        Timeline& operator=(const Timeline&) = delete;
+
+        // Start recording the algorithm on a copy of the input in the background
+        void startRecording(Algorithm& algorithm, const Visualization::VisualizationData& input);
+
+        // Run the algorithm to completion on a copy of the input and trace every step
+        void record(Algorithm& algorithm, const Visualization::VisualizationData& input);
+
+        bool isRecording() const;
+        bool isReady() const;
+        void clear();
+
+        // Move the view to the state after the given number of steps
+        void seek(size_t step);
+
+        // Playback at a fixed number of steps per second, in either direction
+        void play(bool forward);
+        void pause() { playing = false; }
+        bool isPlaying() const { return playing; }
+        bool isPlayingForward() const { return forward; }
+        void setPlaybackRate(double stepsPerSecond) { playbackRate = stepsPerSecond; }
+        double getPlaybackRate() const { return playbackRate; }
+
+        // Advance playback by the time elapsed since the last frame
+        void update(double seconds);
+
+        size_t getPosition() const { return position; }
+        size_t getStepCount() const { return trace.getStepCount(); }
+        size_t getTraceSize() const { return trace.getByteSize(); }
+
+        // Memory budget for checkpoints; changing it rebuilds the checkpoint index
+        void setMemoryBudget(size_t bytes);
+        size_t getMemoryBudget() const { return memoryBudget; }
+        size_t getCheckpointInterval() const { return checkpointInterval; }
+        size_t getCheckpointCount() const { return checkpoints.size(); }
+        size_t getMemoryUsage() const;
+
+        const Visualization::VisualizationData& getView() const { return view; }
+        const SortingStats& getViewStats() const { return viewStats; }
+
+    protected:
+        bool runSlice(Scheduler::Clock::time_point& due) override;
+
+    private:
+        enum class Recording : int { None, Pending, Running, Done };
+
+        Scheduler& scheduler;
+        std::vector<int> initial;
+        OperationTrace trace;
+
+        std::vector<std::vector<int>> checkpoints;
+        size_t checkpointInterval = 1;
+        size_t memoryBudget;
+
+        size_t position = 0;
+        Visualization::VisualizationData view;
+        SortingStats viewStats;
+
+        bool playing = false;
+        bool forward = true;
+        double playbackRate = 10.0;
+        double pendingSteps = 0.0;
+
+        // Claimed by a pool thread moving it from Pending to Running, or dropped by clear() before that
+        std::atomic<Recording> recording{ Recording::None };
+        std::binary_semaphore finished{ 0 };
+        // Set before the recording is posted and read by the slice that records
+        Algorithm* pendingAlgorithm = nullptr;
+        Visualization::VisualizationData pendingInput{ 0 };
+        bool ready = false;
+
+        // Drops a recording no thread has started, or waits for the one running
+        void waitForRecording();
+        void buildCheckpoints();
+        void applyForward(size_t from, size_t to);
+        void applyBackward(size_t from, size_t to);
+        void updateView();
+    };
+
+}
@@ -0,0 +1,67 @@
+#include "VirtualClock.h"
+#include <algorithm>
+
+namespace Algorithms {
+
+    void VirtualClock::start(double unitsPerSecond) {
+        std::lock_guard<std::mutex> lock(mutex);
+        origin = 0.0;
+        anchor = Clock::now();
+        rate = std::max(unitsPerSecond, 1e-3);
+        paused = false;
+    }
+
+    void VirtualClock::pause() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!paused) {
+            auto wall = Clock::now();
+            origin = nowLocked(wall);
+            anchor = wall;
+            paused = true;
+        }
+    }
+
+    void VirtualClock::resume() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (paused) {
+            anchor = Clock::now();
+            paused = false;
+        }
+    }
+
+    void VirtualClock::setRate(double unitsPerSecond) {
+        // Re-anchor so the time reached so far is kept
+        std::lock_guard<std::mutex> lock(mutex);
+        auto wall = Clock::now();
+        origin = nowLocked(wall);
+        anchor = wall;
+        rate = std::max(unitsPerSecond, 1e-3);
+    }
+
+    double VirtualClock::now() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return nowLocked(Clock::now());
+    }
+
+    bool VirtualClock::isPaused() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return paused;
+    }
+
+    VirtualClock::Clock::time_point VirtualClock::getWallTime(double time) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        double seconds = (time - origin) / rate;
+        if (paused || seconds > 3600.0) {
+            return Clock::time_point::max();
+        }
+        return anchor + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::max(seconds, 0.0)));
+    }
+
+    double VirtualClock::nowLocked(Clock::time_point wall) const {
+        if (paused) {
+            return origin;
+        }
+        return origin + rate * std::chrono::duration<double>(wall - anchor).count();
+    }
+
+}
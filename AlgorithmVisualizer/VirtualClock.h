@@ -0,0 +1,49 @@
+#pragma once
+#include "SortingStats.h"
+#include <chrono>
+#include <mutex>
+
+namespace Algorithms {
+
+    // Price of each basic operation in virtual time units
+    struct CostModel {
+        double comparison = 1.0;
+        double swap = 2.0;   // Exchange of two elements
+        double write = 1.0;  // Single element stored, e.g. by a merge or a bucket pass
+
+        double getCost(const SortingStats& stats) const {
+            return comparison * stats.comparisons + swap * (stats.swaps - stats.writes) + write * stats.writes;
+        }
+    };
+
+    // Virtual time shared by every algorithm of a race. It runs at a set rate of units per
+    // wall-clock second, and each algorithm steps only while its cost is behind it, so algorithms
+    // that spend more operations fall behind on screen exactly as much as they cost more.
+    // The UI thread drives it; the algorithms' threads read it.
+    class VirtualClock {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // Restart from time 0
+        void start(double unitsPerSecond);
+        void pause();
+        void resume();
+        void setRate(double unitsPerSecond);
+
+        double now() const;
+        bool isPaused() const;
+        // When now() will reach time, or Clock::time_point::max() while paused or too far off to say
+        Clock::time_point getWallTime(double time) const;
+
+    private:
+        mutable std::mutex mutex;
+        // Virtual time at the anchor, and the wall-clock time it was taken
+        double origin = 0.0;
+        Clock::time_point anchor = Clock::now();
+        double rate = 1000.0;
+        bool paused = true;
+
+        double nowLocked(Clock::time_point wall) const;
+    };
+
+}
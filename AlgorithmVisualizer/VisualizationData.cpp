@@ -1,21 +1,132 @@
 #include "VisualizationData.h"
+#include <algorithm>
+#include <type_traits>
+#include <utility>
 
 namespace Visualization {
 
-    VisualizationData::VisualizationData(int size) {
-        resize(size);
+    void VisualizationState::resetHighlighting() {
+        for (int index : highlighted) {
+            flags[index] = 0;
+            markDirty(index);
+        }
+        highlighted.clear();
+    }
+
+    void VisualizationState::setGroup(int first, int last, uint8_t group) {
+        std::fill(groups.begin() + first, groups.begin() + last + 1, group);
+        markDirty(first, last);
+    }
+
+    void VisualizationState::clearGroups() {
+        std::fill(groups.begin(), groups.end(), 0);
+        markAllDirty();
+    }
+
+    void VisualizationState::markDirty(int first, int last) {
+        for (int block = first >> DIRTY_BLOCK_SHIFT; block <= last >> DIRTY_BLOCK_SHIFT; block++) {
+            markBlock(block);
+        }
     }
 
-    void VisualizationData::resetHighlighting() {
-        for (auto& element : array) {
-            element.isComparing = false;
-            element.isSwapping = false;
+    void VisualizationState::markAllDirty() {
+        size_t blockCount = (static_cast<size_t>(size()) + DIRTY_BLOCK_SIZE - 1) / DIRTY_BLOCK_SIZE;
+        if (dirtyBlocks.size() != blockCount) {
+            dirtyBlocks.assign(blockCount, 1);
+            return;
+        }
+        for (size_t block = 0; block < blockCount; block++) {
+            markBlock(static_cast<int>(block));
         }
     }
 
-    void VisualizationData::resize(int newSize) {
-        array.resize(newSize);
-        resetHighlighting();
+    void VisualizationState::resetState(size_t count) {
+        origin = ValueOrigin();
+        flags.assign(count, 0);
+        groups.assign(count, 0);
+        highlighted.clear();
+        markAllDirty();
+    }
+
+    void VisualizationState::copyState(const VisualizationState& source, int block) {
+        size_t first = static_cast<size_t>(block) << DIRTY_BLOCK_SHIFT;
+        size_t last = std::min(first + DIRTY_BLOCK_SIZE, flags.size());
+        std::copy(source.flags.begin() + first, source.flags.begin() + last, flags.begin() + first);
+        std::copy(source.groups.begin() + first, source.groups.begin() + last, groups.begin() + first);
+        markBlock(block);
+    }
+
+    template <typename Key>
+    BasicVisualizationData<Key>::BasicVisualizationData(int size) {
+        resize(size);
+    }
+
+    template <typename Key>
+    void BasicVisualizationData<Key>::setValues(std::vector<Key> newValues) {
+        sharedOwner.reset();
+        sharedValues = {};
+        values = std::move(newValues);
+        resetState(values.size());
+    }
+
+    template <typename Key>
+    void BasicVisualizationData<Key>::shareValues(std::shared_ptr<const void> owner, std::span<const Key> source) {
+        values.clear();
+        values.shrink_to_fit();
+        sharedOwner = std::move(owner);
+        sharedValues = source;
+        resetState(sharedValues.size());
+    }
+
+    template <typename Key>
+    void BasicVisualizationData<Key>::shareValues(std::shared_ptr<const std::vector<Key>> source) {
+        std::span<const Key> view(*source);
+        shareValues(std::move(source), view);
+    }
+
+    template <typename Key>
+    void BasicVisualizationData<Key>::copySharedValues() {
+        values.assign(sharedValues.begin(), sharedValues.end());
+        sharedOwner.reset();
+        sharedValues = {};
+    }
+
+    template <typename Key>
+    void BasicVisualizationData<Key>::resize(int newSize) {
+        detach();
+        values.resize(newSize);
+        resetState(newSize);
+    }
+
+    template <typename Key>
+    void BasicVisualizationData<Key>::copyBlock(const BasicVisualizationData& source, int block) {
+        detach();
+        std::span<const Key> sourceValues = source.getValues();
+        size_t first = static_cast<size_t>(block) << DIRTY_BLOCK_SHIFT;
+        size_t last = std::min(first + DIRTY_BLOCK_SIZE, values.size());
+        std::copy(sourceValues.begin() + first, sourceValues.begin() + last, values.begin() + first);
+        copyState(source, block);
+    }
+
+    template <typename Key>
+    void BasicVisualizationData<Key>::copyBlockTo(VisualizationData& target, int block) const {
+        if constexpr (std::is_same_v<Key, int>) {
+            target.copyBlock(*this, block);
+        }
+        else {
+            target.detach();
+            std::span<const Key> sourceValues = getValues();
+            size_t first = static_cast<size_t>(block) << DIRTY_BLOCK_SHIFT;
+            size_t last = std::min(first + DIRTY_BLOCK_SIZE, target.values.size());
+            for (size_t index = first; index < last; index++) {
+                target.values[index] = Utils::KeyTraits<Key>::toDisplay(sourceValues[index]);
+            }
+            target.copyState(*this, block);
+        }
     }
 
-}
\ No newline at end of file
+#define INSTANTIATE(Key) template class BasicVisualizationData<Key>;
+    FOR_EACH_KEY_TYPE(INSTANTIATE)
+#undef INSTANTIATE
+
+}
@@ -1,31 +1,173 @@
 #pragma once
+#include "Keys.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
 #include <vector>
 
 namespace Visualization {
 
-    struct ArrayElement {
-        int value;
-        bool isComparing = false;
-        bool isSwapping = false;
+    // Where the values came from, kept in exported datasets; distribution is -1 for values that were not generated
+    struct ValueOrigin {
+        uint64_t seed = 0;
+        int distribution = -1;
     };
 
-    class VisualizationData {
+    template <typename Key>
+    class BasicVisualizationData;
+
+    // The array of ints most windows sort, and the one every window draws
+    using VisualizationData = BasicVisualizationData<int>;
+
+    // Everything about the array but its values, the same for every key type, so the worker and the
+    // snapshot buffer can hold an array of any of them. Highlight flags live in a separate array, and
+    // the indices that were flagged are remembered so clearing them costs the number of highlighted
+    // bars, not n. Every change also marks its block of DIRTY_BLOCK_SIZE elements dirty so the
+    // renderer can refresh only the parts of the array that moved. The marks are atomic bytes, so
+    // worker threads can set them while the snapshot publisher takes them.
+    class VisualizationState {
     public:
-        VisualizationData(int size = 100);
+        static constexpr int DIRTY_BLOCK_SHIFT = 8;
+        static constexpr int DIRTY_BLOCK_SIZE = 1 << DIRTY_BLOCK_SHIFT;
+
+        virtual ~VisualizationState() = default;
+
+        void setComparing(int index) { setFlag(index, Comparing); }
+        void setSwapping(int index) { setFlag(index, Swapping); }
+        void clearHighlight(int index) {
+            flags[index] = 0;
+            markDirty(index);
+        }
 
-        std::vector<ArrayElement>& getArray() { return array; }
-        const std::vector<ArrayElement>& getArray() const { return array; }
+        bool isComparing(int index) const { return (flags[index] & Comparing) != 0; }
+        bool isSwapping(int index) const { return (flags[index] & Swapping) != 0; }
+
+        // Owner of a range, e.g. the worker thread sorting it; 0 means none
+        void setGroup(int first, int last, uint8_t group);
+        uint8_t getGroup(int index) const { return groups[index]; }
+        void clearGroups();
+
+        // Indices flagged since the last reset; may contain cleared or repeated entries
+        const std::vector<int>& getHighlighted() const { return highlighted; }
 
         void resetHighlighting();
 
-        int size() const { return array.size(); }
+        int size() const { return static_cast<int>(flags.size()); }
 
-        void resize(int newSize);
+        void markDirty(int index) { markBlock(index >> DIRTY_BLOCK_SHIFT); }
+        void markDirty(int first, int last);
+        void markAllDirty();
+
+        // Returns whether the block changed since it was last taken, and clears the mark.
+        // Only one consumer should take blocks: the renderer, or the snapshot buffer publishing this data.
+        int getBlockCount() const { return static_cast<int>(dirtyBlocks.size()); }
+        bool takeDirtyBlock(int block) const {
+            std::atomic_ref<uint8_t> mark(dirtyBlocks[block]);
+            return mark.load(std::memory_order_relaxed) != 0 && mark.exchange(0, std::memory_order_acquire) != 0;
+        }
+
+        // Copy the values of one block into target of the same size, as the heights the renderer draws,
+        // with their flags and groups, and mark it dirty there
+        virtual void copyBlockTo(VisualizationData& target, int block) const = 0;
+
+        // Range the algorithm is currently working on, -1 when none
+        int markedLow = -1;
+        int markedHigh = -1;
+
+        // Reset by setValues and shareValues; whoever generates or opens the values sets it after them
+        ValueOrigin origin;
 
         char buf[256]{};
         char buf1[256]{};
-        std::vector<ArrayElement> array;
+
+    protected:
+        enum Flag : uint8_t { Comparing = 1, Swapping = 2 };
+
+        std::vector<uint8_t> flags;
+        std::vector<uint8_t> groups;
+        std::vector<int> highlighted;
+        // Consumer bookkeeping, cleared by the renderer through a const view
+        mutable std::vector<uint8_t> dirtyBlocks;
+
+        // Unflagged, ungrouped and all dirty, for count new values
+        void resetState(size_t count);
+        // Copy the flags and groups of one block from state of the same size, and mark it dirty
+        void copyState(const VisualizationState& source, int block);
+
+        void markBlock(int block) {
+            std::atomic_ref<uint8_t>(dirtyBlocks[block]).store(1, std::memory_order_release);
+        }
+
+        void setFlag(int index, uint8_t flag) {
+            if (flags[index] == 0) {
+                highlighted.push_back(index);
+            }
+            flags[index] |= flag;
+            markDirty(index);
+        }
     };
 
-}
+    // Values are stored contiguously so the algorithms only touch the keys
+    template <typename Key>
+    class BasicVisualizationData : public VisualizationState {
+    public:
+        BasicVisualizationData(int size = 100);
+
+        // Writing through the mutable array bypasses dirty tracking; call markAllDirty() afterwards.
+        // Asking for it counts as a write and ends any sharing.
+        std::vector<Key>& getValues() {
+            detach();
+            return values;
+        }
+        std::span<const Key> getValues() const { return sharedOwner ? sharedValues : std::span<const Key>(values); }
+
+        // Replace the contents with new values of any length
+        void setValues(std::vector<Key> newValues);
+
+        // Show values owned elsewhere, e.g. one race input in every window or a memory-mapped dataset.
+        // owner keeps them alive; the first write copies them.
+        void shareValues(std::shared_ptr<const void> owner, std::span<const Key> source);
+        void shareValues(std::shared_ptr<const std::vector<Key>> source);
+        bool isShared() const { return sharedOwner != nullptr; }
+
+        void set(int index, const Key& value) {
+            detach();
+            values[index] = value;
+            markDirty(index);
+        }
+
+        void swap(int first, int second) {
+            detach();
+            std::swap(values[first], values[second]);
+            markDirty(first);
+            markDirty(second);
+        }
+
+        void resize(int newSize);
+
+        // Copy the values, flags and groups of one block from data of the same size, and mark it dirty
+        void copyBlock(const BasicVisualizationData& source, int block);
+
+        void copyBlockTo(VisualizationData& target, int block) const override;
+
+    private:
+        // Arrays of other keys project their values into the int array the renderer draws
+        template <typename>
+        friend class BasicVisualizationData;
 
+        std::vector<Key> values;
+        // Set while the values are shared; values is then empty
+        std::shared_ptr<const void> sharedOwner;
+        std::span<const Key> sharedValues;
+
+        void detach() {
+            if (sharedOwner) {
+                copySharedValues();
+            }
+        }
+        void copySharedValues();
+    };
+
+}